@@ -0,0 +1,175 @@
+/*
+ * FIRSTBatch.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include "FIRSTBatch.h"
+#include "FIRSTScheduler.h"
+
+/**
+ * Creates a batch.
+ * @param capacity the largest number of members
+ * @param scheduler the scheduler to run the kernel on, the default one if NULL
+ */
+FIRSTBatch::FIRSTBatch(uint16_t capacity, FIRSTScheduler *scheduler)
+	: m_scheduler(scheduler)
+	, m_capacity(capacity)
+	, m_size(0)
+	, m_activeCount(0)
+{
+	m_active = new uint8_t[capacity];
+	m_finished = new uint8_t[capacity];
+	memset(m_active, 0, capacity);
+	memset(m_finished, 0, capacity);
+
+	if (m_scheduler == NULL)
+		m_scheduler = FIRSTScheduler::GetInstance();
+	m_scheduler->RegisterBatch(this);
+}
+
+FIRSTBatch::~FIRSTBatch()
+{
+	delete[] m_active;
+	delete[] m_finished;
+}
+
+uint16_t FIRSTBatch::GetCapacity()
+{
+	return m_capacity;
+}
+
+/**
+ * Returns the number of members, the slots used are 0 to GetSize() - 1.
+ * @return the number of members
+ */
+uint16_t FIRSTBatch::GetSize()
+{
+	return m_size;
+}
+
+/**
+ * Returns the number of members running.
+ * @return the number of active slots
+ */
+uint16_t FIRSTBatch::GetActive()
+{
+	return m_activeCount;
+}
+
+/**
+ * Returns the scheduler running the kernel, whose clock the kernel should use.
+ * @return the scheduler
+ */
+FIRSTScheduler *FIRSTBatch::GetScheduler()
+{
+	return m_scheduler;
+}
+
+/**
+ * Runs the kernel over the slots, if any is active. Called by the {@link Scheduler}.
+ */
+void FIRSTBatch::Run()
+{
+	if (m_activeCount > 0)
+		Execute(m_active, m_size);
+}
+
+/**
+ * Called when a member starts, before its slot becomes active.
+ * @param slot the slot of the member
+ */
+void FIRSTBatch::Initialize(uint16_t)
+{
+}
+
+/**
+ * Called when a member ends, after its slot became inactive.
+ * @param slot the slot of the member
+ * @param interrupted whether it was interrupted or canceled rather than finished
+ */
+void FIRSTBatch::End(uint16_t, bool)
+{
+}
+
+/**
+ * Marks a slot as finished, to be called by the kernel. The member command ends on
+ * the next pass.
+ * @param slot the slot
+ */
+void FIRSTBatch::Finish(uint16_t slot)
+{
+	m_finished[slot] = 1;
+}
+
+int FIRSTBatch::Allocate()
+{
+	if (m_size >= m_capacity)
+		return -1;
+	return m_size++;
+}
+
+/**
+ * Creates a member of a batch, taking the next free slot.
+ * A batch that is full gives members with no slot, which finish right away.
+ * The member runs on the scheduler of the batch.
+ * @param batch the batch
+ */
+FIRSTBatchMember::FIRSTBatchMember(FIRSTBatch *batch)
+	: m_batch(batch)
+{
+	m_slot = batch->Allocate();
+	SetScheduler(batch->GetScheduler());
+	if (m_slot >= 0)
+		SetDoneFlag(&batch->m_finished[m_slot]);
+}
+
+/**
+ * Returns the slot of this member, to set up its state in the arrays of the batch.
+ * @return the slot, or -1 if the batch was full
+ */
+int FIRSTBatchMember::GetSlot()
+{
+	return m_slot;
+}
+
+void FIRSTBatchMember::Initialize()
+{
+	if (m_slot < 0)
+		return;
+
+	m_batch->m_finished[m_slot] = 0;
+	m_batch->Initialize(m_slot);
+	m_batch->m_active[m_slot] = 1;
+	m_batch->m_activeCount++;
+}
+
+void FIRSTBatchMember::Execute()
+{
+}
+
+bool FIRSTBatchMember::IsFinished()
+{
+	return m_slot < 0 || m_batch->m_finished[m_slot];
+}
+
+void FIRSTBatchMember::End()
+{
+	if (m_slot < 0)
+		return;
+
+	m_batch->m_active[m_slot] = 0;
+	m_batch->m_activeCount--;
+	m_batch->End(m_slot, false);
+}
+
+void FIRSTBatchMember::Interrupted()
+{
+	if (m_slot < 0)
+		return;
+
+	m_batch->m_active[m_slot] = 0;
+	m_batch->m_activeCount--;
+	m_batch->End(m_slot, true);
+}
@@ -0,0 +1,84 @@
+/*
+ * FIRSTBatch.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef FIRSTBATCH_H_
+#define FIRSTBATCH_H_
+
+#include <Arduino.h>
+
+#include "FIRSTCommand.h"
+
+class FIRSTScheduler;
+
+/**
+ * Runs many commands of the same kind with one call per pass.
+ *
+ * A derived class keeps the state of all its instances in arrays indexed by slot, one
+ * array per field (struct of arrays), and implements Execute() as a loop over all the
+ * slots. Such loops are tight on the AVR and get vectorized by the compiler elsewhere.
+ * The active array holds 1 for the running slots and 0 for the others, so that a kernel
+ * can mask with it instead of branching.
+ *
+ * Each instance is a {@link BatchMember} command, so it can still require subsystems,
+ * be started, canceled and interrupted like any other command. The member does no work
+ * of its own: once it is initialized the scheduler only checks whether its slot is
+ * finished, without calling or timing it (see {@link Command#SetDoneFlag()}), and calls
+ * the kernel once per pass after all the commands.
+ */
+class FIRSTBatch
+{
+	friend class FIRSTBatchMember;
+public:
+	FIRSTBatch(uint16_t capacity, FIRSTScheduler *scheduler = NULL);
+	virtual ~FIRSTBatch();
+
+	uint16_t GetCapacity();
+	uint16_t GetSize();
+	uint16_t GetActive();
+	FIRSTScheduler *GetScheduler();
+	void Run();
+
+protected:
+	virtual void Initialize(uint16_t slot);
+	virtual void Execute(const uint8_t *active, uint16_t count) = 0;
+	virtual void End(uint16_t slot, bool interrupted);
+	void Finish(uint16_t slot);
+
+private:
+	int Allocate();
+
+	FIRSTScheduler *m_scheduler;
+	uint8_t *m_active;
+	uint8_t *m_finished;
+	uint16_t m_capacity;
+	uint16_t m_size;
+	uint16_t m_activeCount;
+};
+
+/**
+ * One instance of a {@link Batch}.
+ */
+class FIRSTBatchMember : public FIRSTCommand
+{
+public:
+	FIRSTBatchMember(FIRSTBatch *batch);
+	int GetSlot();
+
+protected:
+	virtual void Initialize();
+	virtual void Execute();
+	virtual bool IsFinished();
+	virtual void End();
+	virtual void Interrupted();
+
+private:
+	FIRSTBatch *m_batch;
+	int m_slot;
+};
+
+
+#endif /* FIRSTBATCH_H_ */
@@ -0,0 +1,183 @@
+/*
+ * FIRSTBus.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include "FIRSTBus.h"
+#include "FIRSTScheduler.h"
+
+FIRSTBusTransaction::FIRSTBusTransaction()
+	: m_address(0)
+	, m_tx(NULL)
+	, m_txLength(0)
+	, m_rx(NULL)
+	, m_rxLength(0)
+	, m_status(kIdle)
+	, m_started(0)
+	, m_clock(NULL)
+{
+}
+
+/**
+ * Sets up the transaction. Must not be called while the transaction is pending.
+ * @param address the address of the device
+ * @param tx the data to write, it is not copied
+ * @param txLength the number of bytes to write
+ * @param rx where to put the data read
+ * @param rxLength the number of bytes to read
+ */
+void FIRSTBusTransaction::Set(uint8_t address, const uint8_t *tx, uint8_t txLength, uint8_t *rx, uint8_t rxLength)
+{
+	m_address = address;
+	m_tx = tx;
+	m_txLength = txLength;
+	m_rx = rx;
+	m_rxLength = rxLength;
+	m_status = kIdle;
+}
+
+/**
+ * Creates a loopback driver.
+ * @param latency how long every transfer takes (in microseconds, on the clock of the
+ * scheduler of the bus)
+ */
+FIRSTLoopbackBusDriver::FIRSTLoopbackBusDriver(unsigned long latency)
+	: m_latency(latency)
+{
+}
+
+void FIRSTLoopbackBusDriver::SetLatency(unsigned long latency)
+{
+	m_latency = latency;
+}
+
+bool FIRSTLoopbackBusDriver::Begin(FIRSTBusTransaction *)
+{
+	return true;
+}
+
+void FIRSTLoopbackBusDriver::Poll(FIRSTBusTransaction *transaction)
+{
+	if (transaction->m_clock->Micros() - transaction->m_started < m_latency)
+		return;
+
+	transaction->m_status = Respond(transaction) ?
+			FIRSTBusTransaction::kDone : FIRSTBusTransaction::kFailed;
+}
+
+/**
+ * Fills in the data read by a transaction when it ends.
+ * @param transaction the transaction
+ * @return whether the transfer succeeded
+ */
+bool FIRSTLoopbackBusDriver::Respond(FIRSTBusTransaction *transaction)
+{
+	for (uint8_t i = 0; i < transaction->m_rxLength; i++)
+		transaction->m_rx[i] = transaction->m_txLength == 0 ? 0 : transaction->m_tx[i % transaction->m_txLength];
+	return true;
+}
+
+/**
+ * Creates a bus.
+ * @param name the name of the subsystem
+ * @param driver the driver doing the transfers
+ * @param scheduler the scheduler to register with, the default one if NULL
+ */
+FIRSTBus::FIRSTBus(const char *name, FIRSTBusDriver *driver, FIRSTScheduler *scheduler)
+	: FIRSTSubsystem(name, scheduler)
+	, m_driver(driver)
+	, m_head(0)
+	, m_tail(0)
+	, m_completed(0)
+	, m_failed(0)
+{
+}
+
+FIRSTBus::~FIRSTBus()
+{
+}
+
+/**
+ * Queues a transaction. The transfer starts right away if the bus is idle.
+ * @param transaction the transaction
+ * @return false if the transaction is already pending or the queue is full
+ */
+bool FIRSTBus::Submit(FIRSTBusTransaction *transaction)
+{
+	if (transaction->IsPending())
+		return false;
+
+	uint8_t next = (m_head + 1) % kQueueSize;
+	if (next == m_tail)
+		return false;
+
+	transaction->m_status = FIRSTBusTransaction::kQueued;
+	m_queue[m_head] = transaction;
+	m_head = next;
+	Service();
+	return true;
+}
+
+/**
+ * Retires the finished transfer and starts the next one.
+ * The bus does this at the start and at the end of every pass, it may also be called
+ * in between, from loop() for example, to keep the bus busier.
+ */
+void FIRSTBus::Service()
+{
+	while (m_tail != m_head)
+	{
+		FIRSTBusTransaction *transaction = m_queue[m_tail];
+
+		if (transaction->m_status == FIRSTBusTransaction::kQueued)
+		{
+			transaction->m_status = FIRSTBusTransaction::kActive;
+			transaction->m_clock = GetScheduler();
+			transaction->m_started = transaction->m_clock->Micros();
+			if (!m_driver->Begin(transaction))
+				transaction->m_status = FIRSTBusTransaction::kFailed;
+		}
+
+		if (transaction->m_status == FIRSTBusTransaction::kActive)
+			m_driver->Poll(transaction);
+		if (transaction->m_status == FIRSTBusTransaction::kActive)
+			return;
+
+		if (transaction->m_status == FIRSTBusTransaction::kDone)
+			m_completed++;
+		else
+			m_failed++;
+		m_tail = (m_tail + 1) % kQueueSize;
+	}
+}
+
+/**
+ * Returns the number of transactions waiting, the active one included.
+ * @return the number of transactions in the queue
+ */
+int FIRSTBus::GetQueued()
+{
+	return (m_head - m_tail + kQueueSize) % kQueueSize;
+}
+
+unsigned long FIRSTBus::GetCompleted()
+{
+	return m_completed;
+}
+
+unsigned long FIRSTBus::GetFailed()
+{
+	return m_failed;
+}
+
+void FIRSTBus::Periodic()
+{
+	Service();
+}
+
+void FIRSTBus::Flush()
+{
+	Service();
+}
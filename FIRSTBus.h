@@ -0,0 +1,116 @@
+/*
+ * FIRSTBus.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef FIRSTBUS_H_
+#define FIRSTBUS_H_
+
+#include <Arduino.h>
+
+#include "FIRSTSubsystem.h"
+
+/**
+ * One transfer on a bus: write txLength bytes to the device, then read rxLength bytes.
+ * Transactions are owned by whoever submits them, usually a command, and must stay
+ * alive until they are done.
+ */
+class FIRSTBusTransaction
+{
+public:
+	enum {
+		kIdle,
+		kQueued,
+		kActive,
+		kDone,
+		kFailed
+	};
+
+	FIRSTBusTransaction();
+	void Set(uint8_t address, const uint8_t *tx, uint8_t txLength, uint8_t *rx, uint8_t rxLength);
+	bool IsPending() { return m_status == kQueued || m_status == kActive; };
+	bool IsDone() { return m_status == kDone; };
+	bool IsFailed() { return m_status == kFailed; };
+
+	uint8_t m_address;
+	const uint8_t *m_tx;
+	uint8_t m_txLength;
+	uint8_t *m_rx;
+	uint8_t m_rxLength;
+	volatile uint8_t m_status;
+	unsigned long m_started;
+	FIRSTScheduler *m_clock;
+};
+
+/**
+ * Does the actual transfers for a {@link Bus}, one at a time.
+ * Begin() starts a transfer, returning false if it could not. The driver reports the end
+ * of the transfer by setting the status of the transaction to kDone or kFailed, either
+ * from its interrupt handler or, for a polled driver, from Poll().
+ */
+class FIRSTBusDriver
+{
+public:
+	virtual ~FIRSTBusDriver() {}
+	virtual bool Begin(FIRSTBusTransaction *transaction) = 0;
+	virtual void Poll(FIRSTBusTransaction *) {}
+};
+
+/**
+ * A stand-in driver for testing off the hardware. Every transfer takes a fixed time,
+ * and the data read back is the data written, repeated.
+ * Override Respond() to simulate an actual device.
+ */
+class FIRSTLoopbackBusDriver : public FIRSTBusDriver
+{
+public:
+	FIRSTLoopbackBusDriver(unsigned long latency);
+	virtual bool Begin(FIRSTBusTransaction *transaction);
+	virtual void Poll(FIRSTBusTransaction *transaction);
+	void SetLatency(unsigned long latency);
+
+protected:
+	virtual bool Respond(FIRSTBusTransaction *transaction);
+
+private:
+	unsigned long m_latency;
+};
+
+/**
+ * Queue of bus transactions so that commands never wait on the bus.
+ *
+ * A command submits a transaction and checks on the next passes whether it is done.
+ * The transfers go on in the background, back to back, between and during the passes.
+ * Nothing needs to require the bus, it is registered as a subsystem only to be polled
+ * at the start and the end of every pass.
+ */
+class FIRSTBus : public FIRSTSubsystem
+{
+public:
+	static const int kQueueSize = 8;
+
+	FIRSTBus(const char *name, FIRSTBusDriver *driver, FIRSTScheduler *scheduler = NULL);
+	virtual ~FIRSTBus();
+
+	bool Submit(FIRSTBusTransaction *transaction);
+	void Service();
+	int GetQueued();
+	unsigned long GetCompleted();
+	unsigned long GetFailed();
+
+	virtual void Periodic();
+	virtual void Flush();
+
+private:
+	FIRSTBusDriver *m_driver;
+	FIRSTBusTransaction *m_queue[kQueueSize];
+	volatile uint8_t m_head;
+	volatile uint8_t m_tail;
+	unsigned long m_completed;
+	unsigned long m_failed;
+};
+
+
+#endif /* FIRSTBUS_H_ */
@@ -0,0 +1,236 @@
+/*
+ * FIRSTChannel.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef FIRSTCHANNEL_H_
+#define FIRSTCHANNEL_H_
+
+#include <Arduino.h>
+
+// Keeps the compiler (and on multi-core hosts the CPU) from moving memory accesses across it
+#if defined(__AVR__)
+#define FIRST_CHANNEL_BARRIER() __asm__ __volatile__("" ::: "memory")
+#else
+#define FIRST_CHANNEL_BARRIER() __sync_synchronize()
+#endif
+
+/**
+ * Latest value mailbox, for passing the newest reading of something from one writer to
+ * any number of readers: an interrupt handler to a command, a subsystem to commands of
+ * a scheduler running at another rate...
+ *
+ * It is a sequence lock: the writer makes the sequence odd, copies the value in and makes
+ * the sequence even again; a reader copies the value out and keeps it only if the
+ * sequence was even and did not change meanwhile. Neither side ever waits on the other
+ * or disables interrupts. A reader interrupted by the writer retries a few times, and
+ * gives up if the writer keeps interrupting it, or if the reader is an interrupt handler
+ * that interrupted the writer.
+ *
+ * Every publication counts, so a reader that remembers the last count it saw knows how
+ * many values it missed.
+ */
+template<typename T> class FIRSTMailbox
+{
+public:
+	static const uint8_t kRetries = 4;
+
+	FIRSTMailbox() : m_sequence(0), m_published(false) {};
+
+	/**
+	 * Publishes a value. There must be only one writer.
+	 * @param value the value
+	 */
+	void Publish(const T &value) {
+		m_sequence = m_sequence + 1;
+		FIRST_CHANNEL_BARRIER();
+		*(T *)&m_value = value;
+		FIRST_CHANNEL_BARRIER();
+		m_sequence = m_sequence + 1;
+		m_published = true;
+	};
+
+	/**
+	 * Reads the latest value.
+	 * @param value where to copy the value to
+	 * @param count where to put the number of publications up to this value (or NULL)
+	 * @return false if nothing was published yet or no consistent copy could be made,
+	 * value is then undefined
+	 */
+	bool Read(T *value, uint16_t *count = NULL) {
+		for (uint8_t i = 0; i < kRetries; i++) {
+			if (!m_published)
+				return false;
+			uint16_t before = Sequence();
+			if (before & 1)
+				continue;
+			FIRST_CHANNEL_BARRIER();
+			*value = *(const T *)&m_value;
+			FIRST_CHANNEL_BARRIER();
+			if (Sequence() == before) {
+				if (count != NULL)
+					*count = before >> 1;
+				return true;
+			}
+		}
+		return false;
+	};
+
+	/**
+	 * Reads the latest value if it is newer than the last one read.
+	 * @param value where to copy the value to
+	 * @param last the number of publications seen so far, updated
+	 * @return the number of publications since the last read: 0 when there is nothing
+	 * new (or no consistent copy), more than 1 when values were missed
+	 */
+	uint16_t Poll(T *value, uint16_t *last) {
+		if ((uint16_t)(Sequence() >> 1) == *last)
+			return 0;
+		uint16_t count;
+		if (!Read(value, &count))
+			return 0;
+		// The counts are 15 bits, so is the gap
+		uint16_t updates = (count - *last) & 0x7FFF;
+		*last = count;
+		return updates;
+	};
+
+	/**
+	 * Returns the number of publications so far (it wraps at 32768).
+	 * @return the number of publications
+	 */
+	uint16_t GetCount() {
+		return Sequence() >> 1;
+	};
+
+private:
+	// 16 bits are read one byte at a time on the AVR, so read until two reads agree
+	uint16_t Sequence() {
+		uint16_t sequence = m_sequence;
+		for (uint16_t again = m_sequence; again != sequence; again = m_sequence)
+			sequence = again;
+		return sequence;
+	};
+
+	volatile uint16_t m_sequence;
+	volatile bool m_published;
+	volatile T m_value;
+};
+
+/**
+ * Fixed capacity ring from one producer to one consumer, for passing every value in
+ * order: samples from an interrupt handler, events, messages...
+ *
+ * The producer only writes the head and the consumer only the tail, both single bytes,
+ * so neither side needs a lock or to disable interrupts. A full ring refuses new values
+ * and counts them as dropped. Every value is stamped with its sequence number, so the
+ * consumer sees the gaps the dropped values left.
+ *
+ * Values are copied in by Push() and out by Pop(); to avoid the copies, the producer can
+ * fill the slot returned by Claim() and Commit() it, and the consumer can use the slot
+ * returned by Front() and Release() it.
+ * @param T the type of the values
+ * @param N the capacity, a power of 2 up to 128
+ */
+template<typename T, uint8_t N> class FIRSTRing
+{
+	static_assert(N > 0 && N <= 128 && (N & (N - 1)) == 0, "The capacity must be a power of 2 up to 128");
+public:
+	FIRSTRing() : m_head(0), m_tail(0), m_sequence(0), m_dropped(0) {};
+
+	/**
+	 * Returns the free slot at the head, or NULL (counted as dropped) if the ring is full.
+	 * @return the slot to fill before calling Commit()
+	 */
+	T *Claim() {
+		if ((uint8_t)(m_head - m_tail) >= N) {
+			m_sequence++;
+			m_dropped++;
+			return NULL;
+		}
+		return &m_slots[m_head & (N - 1)].value;
+	};
+
+	/**
+	 * Hands the slot returned by Claim() to the consumer.
+	 */
+	void Commit() {
+		m_slots[m_head & (N - 1)].sequence = m_sequence++;
+		FIRST_CHANNEL_BARRIER();
+		m_head = m_head + 1;
+	};
+
+	/**
+	 * Adds a value, unless the ring is full.
+	 * @param value the value
+	 * @return whether the value was added
+	 */
+	bool Push(const T &value) {
+		T *slot = Claim();
+		if (slot == NULL)
+			return false;
+		*slot = value;
+		Commit();
+		return true;
+	};
+
+	/**
+	 * Returns the oldest value without removing it.
+	 * @param sequence where to put the sequence number of the value (or NULL)
+	 * @return the oldest value, or NULL if the ring is empty
+	 */
+	T *Front(uint16_t *sequence = NULL) {
+		if (m_head == m_tail)
+			return NULL;
+		FIRST_CHANNEL_BARRIER();
+		Slot *slot = &m_slots[m_tail & (N - 1)];
+		if (sequence != NULL)
+			*sequence = slot->sequence;
+		return &slot->value;
+	};
+
+	/**
+	 * Removes the value returned by Front(), giving its slot back to the producer.
+	 */
+	void Release() {
+		FIRST_CHANNEL_BARRIER();
+		m_tail = m_tail + 1;
+	};
+
+	/**
+	 * Removes the oldest value.
+	 * @param value where to copy the value to
+	 * @param sequence where to put the sequence number of the value (or NULL)
+	 * @return false if the ring is empty
+	 */
+	bool Pop(T *value, uint16_t *sequence = NULL) {
+		T *slot = Front(sequence);
+		if (slot == NULL)
+			return false;
+		*value = *slot;
+		Release();
+		return true;
+	};
+
+	uint8_t GetCount() { return m_head - m_tail; };
+	bool IsEmpty() { return m_head == m_tail; };
+	uint16_t GetDropped() { return m_dropped; };
+
+private:
+	typedef struct sSlot {
+		T value;
+		uint16_t sequence;
+	} Slot;
+
+	// Free running, so head - tail is the count even when they wrap
+	volatile uint8_t m_head;
+	volatile uint8_t m_tail;
+	uint16_t m_sequence;
+	uint16_t m_dropped;
+	Slot m_slots[N];
+};
+
+
+#endif /* FIRSTCHANNEL_H_ */
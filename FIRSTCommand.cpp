@@ -16,20 +16,33 @@
 
 #include "FIRSTCommand.h"
 #include "FIRSTScheduler.h"
-
-int FIRSTCommand::m_commandCounter = 0;
+#include "FIRSTSubsystem.h"
+#include "FIRSTEventLog.h"
 
 void FIRSTCommand::InitCommand(const char *name, double timeout)
 {
-	m_commandID = m_commandCounter++;
-	m_timeout = timeout;
+	m_commandID = -1;
+	SetTimeout(timeout);
 	m_locked = false;
-	m_startTime = -1;
+	m_startTime = 0;
+	m_timing = false;
 	m_initialized = false;
 	m_running = false;
 	m_interruptible = true;
 	m_canceled = false;
+	m_runWhenDisabled = false;
 	m_parent = NULL;
+	m_scheduler = NULL;
+	m_causeTime = 0;
+	m_hasCause = false;
+	m_budget = 0;
+	m_maxExecutionTime = 0;
+	m_budgetViolations = 0;
+	m_budgetPolicy = kBudgetLog;
+	m_demoted = false;
+	m_deferred = false;
+	m_doneFlag = NULL;
+	m_completionCount = 0;
 	m_name = name == NULL? String() : name;
 }
 
@@ -78,21 +91,39 @@ FIRSTCommand::~FIRSTCommand()
 
 /**
  * Get the ID (sequence number) for this command
- * The ID is a unique sequence number that is incremented for each command.
+ * The ID is a sequence number unique among the commands of its {@link Scheduler}, given
+ * the first time it is asked for.
  * @return the ID of this command
  */
 int FIRSTCommand::GetID() {
+	if (m_commandID < 0)
+		m_commandID = GetScheduler()->m_commandCounter++;
 	return m_commandID;
 }
 
 /**
  * Sets the timeout of this command.
- * @param timeout the timeout (in seconds)
+ * The timeout is kept in whole milliseconds so that checking it needs no floating point math.
+ * @param timeout the timeout (in seconds), negative for no timeout
  * @see Command#isTimedOut() isTimedOut()
  */
 void FIRSTCommand::SetTimeout(double timeout)
 {
-	m_timeout = timeout;
+	if (timeout < 0.0)
+		m_timeout = kNoTimeout;
+	else
+		m_timeout = (unsigned long)(timeout * 1000.0 + 0.5);
+}
+
+/**
+ * Marks this command as doing no work of its own in Execute(), finishing once the given
+ * flag is set, as the members of a {@link Batch} do. Once the command is initialized the
+ * scheduler only reads the flag on each pass: it neither calls nor times the command.
+ * @param flag the flag, non zero when the command is finished, or NULL to run it as usual
+ */
+void FIRSTCommand::SetDoneFlag(const uint8_t *flag)
+{
+	m_doneFlag = flag;
 }
 
 /**
@@ -102,10 +133,10 @@ void FIRSTCommand::SetTimeout(double timeout)
  */
 double FIRSTCommand::TimeSinceInitialized()
 {
-	if (m_startTime < 0.0)
+	if (!m_timing)
 		return 0.0;
 	else
-		return 0.001 * millis() - m_startTime;
+		return 0.001 * (GetScheduler()->Millis() - m_startTime);
 }
 
 /**
@@ -114,16 +145,67 @@ double FIRSTCommand::TimeSinceInitialized()
  *
  * <p>Note that the recommended way to call this method is in the constructor.</p>
  *
+ * <p>All the subsystems required must belong to the scheduler of the command; one of
+ * another scheduler is logged and not required.</p>
+ *
  * @param subsystem the {@link Subsystem} required
  * @see Subsystem
  */
 void FIRSTCommand::Requires(FIRSTSubsystem *subsystem)
 {
-	if (!AssertUnlocked("Can not add new requirement to command"))
+	if (!AssertUnlocked(FIRSTEventLog::kRequirementAfterLock))
 		return;
 
 	if (subsystem != NULL)
+	{
+		// One scheduler can not lock a subsystem of another one
+		if (m_scheduler != NULL && subsystem->GetScheduler() != m_scheduler)
+		{
+			FIRSTEventLog::Log(FIRSTEventLog::kCrossScheduler, GetID());
+			return;
+		}
 		m_requirements.insert(subsystem);
+		if (m_scheduler == NULL)
+			m_scheduler = subsystem->GetScheduler();
+	}
+}
+
+/**
+ * Binds this command to the given {@link Scheduler}.
+ * A command is otherwise bound to the scheduler of the first subsystem it requires,
+ * or to the default scheduler if it requires none. A command can not be moved away from
+ * the scheduler of the subsystems it requires.
+ * @param scheduler the scheduler to run this command on
+ */
+void FIRSTCommand::SetScheduler(FIRSTScheduler *scheduler)
+{
+	if (!AssertUnlocked(FIRSTEventLog::kSchedulerAfterLock))
+		return;
+
+	FIRSTScheduler *bound = scheduler == NULL ? FIRSTScheduler::GetInstance() : scheduler;
+	SubsystemSet::iterator iter = m_requirements.begin();
+	for (; iter != m_requirements.end(); iter++)
+	{
+		if ((*iter)->GetScheduler() != bound)
+		{
+			FIRSTEventLog::Log(FIRSTEventLog::kCrossScheduler, GetID());
+			return;
+		}
+	}
+
+	// The ID comes from the scheduler
+	if (scheduler != m_scheduler)
+		m_commandID = -1;
+	m_scheduler = scheduler;
+}
+
+/**
+ * Returns the {@link Scheduler} this command runs on.
+ * @return the scheduler of this command
+ */
+FIRSTScheduler *FIRSTCommand::GetScheduler()
+{
+	return m_scheduler == NULL ? FIRSTScheduler::GetInstance() : m_scheduler;
 }
 
 /**
@@ -159,10 +241,12 @@ void FIRSTCommand::Start()
 {
 	LockChanges();
 	if (m_parent != NULL)
+	{
+		FIRSTEventLog::Log(FIRSTEventLog::kStartInGroup, GetID());
 		return;
-		//wpi_setWPIErrorWithContext(CommandIllegalUse, "Can not start a command that is part of a command group");
+	}
 
-	FIRSTScheduler::GetInstance()->AddCommand(this);
+	GetScheduler()->AddCommand(this);
 }
 
 /**
@@ -209,7 +293,8 @@ void FIRSTCommand::_End()
  */
 void FIRSTCommand::StartTiming()
 {
-	m_startTime = 0.001 * millis();
+	m_startTime = GetScheduler()->Millis();
+	m_timing = true;
 }
 
 /**
@@ -220,14 +305,16 @@ void FIRSTCommand::StartTiming()
  */
 bool FIRSTCommand::IsTimedOut()
 {
-	return m_timeout != -1 && TimeSinceInitialized() >= m_timeout;
+	return m_timeout != kNoTimeout && m_timing
+			&& GetScheduler()->Millis() - m_startTime >= m_timeout;
 }
 
 /**
- * Returns the requirements (as an std::set of {@link Subsystem Subsystems} pointers) of this command
- * @return the requirements (as an std::set of {@link Subsystem Subsystems} pointers) of this command
+ * Returns the requirements (as a list of {@link Subsystem Subsystems} pointers) of this command.
+ * The list is not copied, and it can not change once the command has been started.
+ * @return the requirements (as a list of {@link Subsystem Subsystems} pointers) of this command
  */
-FIRSTCommand::SubsystemSet FIRSTCommand::GetRequirements()
+const FIRSTCommand::SubsystemSet &FIRSTCommand::GetRequirements()
 {
 	return m_requirements;
 }
@@ -241,17 +328,15 @@ void FIRSTCommand::LockChanges()
 }
 
 /**
- * If changes are locked, then this will generate a CommandIllegalUse error.
- * @param message the message to report on error (it is appended by a default message)
+ * If changes are locked, then this will log the given event.
+ * @param event the {@link EventLog} event to log on error
  * @return true if assert passed, false if assert failed
  */
-bool FIRSTCommand::AssertUnlocked(const char *message)
+bool FIRSTCommand::AssertUnlocked(uint8_t event)
 {
 	if (m_locked)
 	{
-//		char buf[128];
-//		snprintf(buf, 128, "%s after being started or being added to a command group", message);
-//		wpi_setWPIErrorWithContext(CommandIllegalUse, buf);
+		FIRSTEventLog::Log(event, GetID());
 		return false;
 	}
 	return true;
@@ -265,12 +350,12 @@ void FIRSTCommand::SetParent(CommandGroup *parent)
 {
 	if (parent == NULL)
 	{
-		//wpi_setWPIErrorWithContext(NullParameter, "parent");
+		FIRSTEventLog::Log(FIRSTEventLog::kNullParent, GetID());
 		return;
 	}
 	else if (m_parent != NULL)
 	{
-		//wpi_setWPIErrorWithContext(CommandIllegalUse, "Can not give command to a command group after already being put in a command group");
+		FIRSTEventLog::Log(FIRSTEventLog::kParentAlreadySet, GetID());
 		return;
 	}
 	else
@@ -294,7 +379,8 @@ void FIRSTCommand::SetParent(CommandGroup *parent)
 void FIRSTCommand::StartRunning()
 {
 	m_running = true;
-	m_startTime = -1;
+	m_timing = false;
+	m_hasCause = false;
 }
 
 /**
@@ -319,8 +405,10 @@ bool FIRSTCommand::IsRunning()
 void FIRSTCommand::Cancel()
 {
 	if (m_parent != NULL)
+	{
+		FIRSTEventLog::Log(FIRSTEventLog::kCancelInGroup, GetID());
 		return;
-		//wpi_setWPIErrorWithContext(CommandIllegalUse, "Can not cancel a command that is part of a command group");
+	}
 
 	_Cancel();
 }
@@ -362,6 +450,30 @@ void FIRSTCommand::SetInterruptible(bool interruptible)
 	m_interruptible = interruptible;
 }
 
+/**
+ * Sets whether or not this {@link Command} should run when the scheduler is disabled.
+ * By default a command does not run when disabled, and will be canceled by the
+ * {@link Scheduler} as soon as it gets disabled. It can be changed while the command runs.
+ * @param run whether or not this command should run when disabled
+ */
+void FIRSTCommand::SetRunWhenDisabled(bool run)
+{
+	if (run == m_runWhenDisabled)
+		return;
+	m_runWhenDisabled = run;
+	if (IsRunning())
+		GetScheduler()->UpdateRunWhenDisabled(this);
+}
+
+/**
+ * Returns whether or not this {@link Command} will run when the scheduler is disabled.
+ * @return whether or not this command will run when disabled
+ */
+bool FIRSTCommand::WillRunWhenDisabled()
+{
+	return m_runWhenDisabled;
+}
+
 /**
  * Checks if the command requires the given {@link Subsystem}.
  * @param system the system
@@ -369,7 +481,7 @@ void FIRSTCommand::SetInterruptible(bool interruptible)
  */
 bool FIRSTCommand::DoesRequire(FIRSTSubsystem *system)
 {
-	return m_requirements.count(system) > 0;
+	return m_requirements.find(system) != m_requirements.end();
 }
 
 /**
@@ -382,6 +494,187 @@ CommandGroup *FIRSTCommand::GetGroup()
 	return m_parent;
 }
 
+/**
+ * Tags this command with the time of the input it is acting on, for measuring the
+ * latency from the input to the output (see {@link Latency}). When tagged more than
+ * once during a pass, the earliest input counts.
+ * @param time the time of the input (in microseconds, see {@link Scheduler#Micros()})
+ */
+void FIRSTCommand::SetCauseTime(unsigned long time)
+{
+	if (!m_hasCause || (long)(time - m_causeTime) < 0)
+		m_causeTime = time;
+	m_hasCause = true;
+}
+
+/**
+ * Tags this command with the time the given subsystem was sampled, when acting on
+ * a reading of the subsystem.
+ * @param input the subsystem the reading comes from
+ * @see Subsystem#Periodic()
+ */
+void FIRSTCommand::Consume(FIRSTSubsystem *input)
+{
+	SetCauseTime(input->GetSampleTime());
+}
+
+/**
+ * Returns whether this command acted on an input whose output was not committed yet.
+ * @return whether the command is tagged with an input time
+ */
+bool FIRSTCommand::HasCause()
+{
+	return m_hasCause;
+}
+
+unsigned long FIRSTCommand::GetCauseTime()
+{
+	return m_causeTime;
+}
+
+/**
+ * Sets how long one run of this command may take, measured by the {@link Scheduler}
+ * around every call to Run(), and what happens when it takes longer:
+ * <ul>
+ * <li> kBudgetLog: the violation is counted and logged (see {@link EventLog}) </li>
+ * <li> kBudgetDemote: as well, the command is demoted: it then runs after all the other
+ * commands, and only if the pass of the scheduler has time left (see
+ * {@link Scheduler#SetPassBudget()}) </li>
+ * <li> kBudgetCancel: as well, the command is canceled </li>
+ * </ul>
+ * A command that hangs for good never returns to be measured, only the watchdog of the
+ * scheduler can catch that.
+ * @param budget the execution budget (in microseconds), 0 for none
+ * @param policy what to do when the budget is exceeded
+ */
+void FIRSTCommand::SetExecutionBudget(unsigned long budget, uint8_t policy)
+{
+	m_budget = budget;
+	m_budgetPolicy = policy;
+}
+
+unsigned long FIRSTCommand::GetExecutionBudget()
+{
+	return m_budget;
+}
+
+/**
+ * Returns how many runs of this command exceeded its execution budget.
+ * @return the number of budget violations
+ */
+unsigned int FIRSTCommand::GetBudgetViolations()
+{
+	return m_budgetViolations;
+}
+
+/**
+ * Returns the longest run of this command. Only the commands with a budget are timed,
+ * unless the scheduler times them all (see {@link Scheduler#SetCommandTiming()}).
+ * @return the longest execution time (in microseconds)
+ */
+unsigned long FIRSTCommand::GetMaxExecutionTime()
+{
+	return m_maxExecutionTime;
+}
+
+/**
+ * Returns whether this command was demoted for exceeding its execution budget.
+ * @return whether the command is demoted
+ */
+bool FIRSTCommand::IsDemoted()
+{
+	return m_demoted;
+}
+
+/**
+ * Clears the budget violations and the longest execution time, and promotes the
+ * command back if it was demoted.
+ */
+void FIRSTCommand::ResetBudgetViolations()
+{
+	m_budgetViolations = 0;
+	m_maxExecutionTime = 0;
+	m_demoted = false;
+}
+
+bool FIRSTCommand::AddCompletion(uint8_t reasons, FIRSTCompletion callback, FIRSTCommand *next)
+{
+	if (m_completionCount >= kMaxCompletions)
+		return false;
+	Completion *completion = &m_completions[m_completionCount++];
+	completion->reasons = reasons;
+	completion->callback = callback;
+	completion->next = next;
+	return true;
+}
+
+/**
+ * Calls the given function whenever this command ends in one of the given ways, right
+ * after its End() or Interrupted(). Only a command that was initialized ends; one
+ * canceled before it ever ran does not. The completions are fired by the
+ * {@link Scheduler} as it removes the command, so those of a command run by a
+ * {@link CommandGroup}, which the group runs itself, would never fire.
+ * @param callback the function, given the command and the way it ended
+ * @param reasons kEndFinished, kEndInterrupted and/or kEndTimedOut
+ * @return false if the callback is NULL or the kMaxCompletions slots are taken
+ */
+bool FIRSTCommand::OnCompletion(FIRSTCompletion callback, uint8_t reasons)
+{
+	return callback != NULL && AddCompletion(reasons, callback, NULL);
+}
+
+/**
+ * Starts another command whenever this command ends in one of the given ways. The
+ * command is started by the {@link Scheduler} as it removes this one, so it is added in
+ * the same pass, rather than on the next one by a command polling IsRunning().
+ * By default the command follows when this one ends by itself, whether it finished or
+ * timed out, and not when it is interrupted; see OnCompletion() for commands in groups.
+ * @param next the command to start
+ * @param reasons kEndFinished, kEndInterrupted and/or kEndTimedOut
+ * @return false if the command is NULL or the kMaxCompletions slots are taken
+ */
+bool FIRSTCommand::Then(FIRSTCommand *next, uint8_t reasons)
+{
+	return next != NULL && AddCompletion(reasons, NULL, next);
+}
+
+/**
+ * Starts another command whenever this command is interrupted or canceled.
+ * @param next the command to start
+ * @return false if the command is NULL or the kMaxCompletions slots are taken
+ */
+bool FIRSTCommand::OnInterrupt(FIRSTCommand *next)
+{
+	return Then(next, kEndInterrupted);
+}
+
+/**
+ * Removes the callbacks and the chained commands, freeing the slots.
+ */
+void FIRSTCommand::ClearCompletions()
+{
+	m_completionCount = 0;
+}
+
+/**
+ * Tells the callbacks and starts the chained commands that wait for the given ending.
+ * Called by the {@link Scheduler} once the command is removed.
+ * @param reason how the command ended
+ */
+void FIRSTCommand::Complete(uint8_t reason)
+{
+	for (uint8_t i = 0; i < m_completionCount; i++)
+	{
+		Completion *completion = &m_completions[i];
+		if ((completion->reasons & reason) == 0)
+			continue;
+		if (completion->callback != NULL)
+			completion->callback(this, reason);
+		if (completion->next != NULL)
+			completion->next->Start();
+	}
+}
+
 String FIRSTCommand::GetName()
 {
 	if (m_name.length() == 0)
@@ -391,3 +684,16 @@ String FIRSTCommand::GetName()
 	return m_name;
 }
 
+/**
+ * Returns the name without the copy GetName() makes, which allocates on the AVR: the
+ * name given to the constructor, or the one GetName() made up. It is resolved by
+ * {@link Scheduler#Freeze()}, and stays valid as long as the command.
+ * @return the name
+ */
+const char *FIRSTCommand::GetCName()
+{
+	if (m_name.length() == 0)
+		GetName();
+	return m_name.c_str();
+}
+
@@ -15,8 +15,20 @@
 #endif
 
 class CommandGroup;
+class FIRSTCommand;
 class FIRSTSubsystem;
+class FIRSTScheduler;
 
+// What routines and state machines wait on and act with
+typedef bool (*FIRSTCondition)();
+typedef void (*FIRSTAction)();
+// What is told a command ended, and how (see FIRSTCommand::OnCompletion())
+typedef void (*FIRSTCompletion)(FIRSTCommand *command, uint8_t reason);
+
+/**
+ * Singly linked list. Removed nodes are kept on a spare list and reused, so once the list
+ * has been as long as it gets, or was given the room with reserve(), it stops allocating.
+ */
 template<typename T> class AVector {
 private:
 	typedef struct sItem {
@@ -25,6 +37,22 @@ private:
 	} Item;
 	Item *root;
 	Item *last;
+	int length;
+	Item *spare;
+	int spares;
+
+	Item *alloc() {
+		if(spare==NULL) return new Item;
+		Item *p = spare;
+		spare = p->next;
+		spares--;
+		return p;
+	};
+	void release(Item *p) {
+		p->next = spare;
+		spare = p;
+		spares++;
+	};
 public:
 	class iterator {
 		Item *m_item;
@@ -40,41 +68,71 @@ public:
 		bool operator==(const iterator& other){return this->m_item == other.m_item;}
 		bool operator!=(const iterator& other){return !(*this == other);}
 	};
-	AVector() { root=NULL; last=NULL; };
-	~AVector() { clear(); };
-	AVector& operator= (const AVector& x) {
+	AVector() { root=NULL; last=NULL; length=0; spare=NULL; spares=0; };
+	AVector(const AVector& x) {
+		root = NULL;
+		last = NULL;
+		length = 0;
+		spare = NULL;
+		spares = 0;
+		for(Item *p = x.root; p; p = p->next)
+			push_back(p->payload);
+	};
+	~AVector() {
 		clear();
-		for( iterator iter = x.begin(); iter != x.end(); iter++)
-			push_back(*iter);
+		while(spare) {
+			Item *t = spare;
+			spare = spare->next;
+			delete t;
+		}
+	};
+	AVector& operator= (const AVector& x) {
+		if(this != &x) {
+			clear();
+			for(Item *p = x.root; p; p = p->next)
+				push_back(p->payload);
+		}
+		return *this;
 	};
 	void clear() {
 		Item *p = root;
 		while(p) {
 			Item *t = p;
 			p = p->next;
-			delete t;
+			release(t);
 		}
+		root = NULL;
+		last = NULL;
+		length = 0;
 	};
-	iterator begin() { return iterator(root); };
-	iterator end() { return iterator(NULL); };
-	int size() const {int size=0; for(Item *p = root; p; p = p->next) size++; return size; };
+	iterator begin() const { return iterator(root); };
+	iterator end() const { return iterator(NULL); };
+	int size() const { return length; };
+	int capacity() const { return length + spares; };
+	void reserve(int n) {
+		while(length + spares < n)
+			release(new Item);
+	};
+	bool empty() const { return root == NULL; };
 	void insert(const T val) {
-		Item *newItem = new Item;
+		Item *newItem = alloc();
 		newItem->payload = val;
 		newItem->next = root;
 		root = newItem;
 		if(last==NULL) last = newItem;
+		length++;
 	};
 	void push_back (const T val) {
 		if(last==NULL) {
 			insert(val);
 		}
 		else {
-			Item *newItem = new Item;
+			Item *newItem = alloc();
 			newItem->payload = val;
 			newItem->next = NULL;
 			last->next = newItem;
 			last = newItem;
+			length++;
 		}
 	};
 	int count(const T val) {
@@ -92,15 +150,19 @@ public:
 	};
 	int erase (const T val) {
 		int total = 0;
-		Item *p = root;
-		while(p) {
-			Item *t = p;
-			Item **s = &p;
-			p = p->next;
+		Item **s = &root;
+		last = NULL;
+		while(*s) {
+			Item *t = *s;
 			if(t->payload == val) {
 				*s = t->next;
-				delete t;
+				release(t);
 				total++;
+				length--;
+			}
+			else {
+				last = t;
+				s = &t->next;
 			}
 		}
 		return total;
@@ -113,6 +175,19 @@ class FIRSTCommand
         friend class CommandGroup;
         friend class FIRSTScheduler;
 public:
+        enum {
+                kBudgetLog,
+                kBudgetDemote,
+                kBudgetCancel
+        };
+        enum {
+                kEndFinished = 0x01,
+                kEndInterrupted = 0x02,
+                kEndTimedOut = 0x04,
+                kEndAny = 0x07
+        };
+        static const uint8_t kMaxCompletions = 2;
+
         FIRSTCommand();
         FIRSTCommand(const char *name);
         FIRSTCommand(double timeout);
@@ -127,16 +202,35 @@ public:
         bool IsRunning();
         bool IsInterruptible();
         void SetInterruptible(bool interruptible);
+        void SetRunWhenDisabled(bool run);
+        bool WillRunWhenDisabled();
         bool DoesRequire(FIRSTSubsystem *subsystem);
         typedef AVector<FIRSTSubsystem *> SubsystemSet;
-        SubsystemSet GetRequirements();
+        const SubsystemSet &GetRequirements();
         CommandGroup *GetGroup();
         int GetID();
+        void SetScheduler(FIRSTScheduler *scheduler);
+        FIRSTScheduler *GetScheduler();
+        void SetCauseTime(unsigned long time);
+        void Consume(FIRSTSubsystem *input);
+        bool HasCause();
+        unsigned long GetCauseTime();
+        void SetExecutionBudget(unsigned long budget, uint8_t policy = kBudgetLog);
+        unsigned long GetExecutionBudget();
+        unsigned int GetBudgetViolations();
+        unsigned long GetMaxExecutionTime();
+        bool IsDemoted();
+        void ResetBudgetViolations();
+        bool OnCompletion(FIRSTCompletion callback, uint8_t reasons = kEndAny);
+        bool Then(FIRSTCommand *next, uint8_t reasons = kEndFinished | kEndTimedOut);
+        bool OnInterrupt(FIRSTCommand *next);
+        void ClearCompletions();
 
 protected:
         void SetTimeout(double timeout);
+        void SetDoneFlag(const uint8_t *flag);
         bool IsTimedOut();
-        bool AssertUnlocked(const char *message);
+        bool AssertUnlocked(uint8_t event);
         void SetParent(CommandGroup *parent);
         virtual void Initialize() = 0;
         virtual void Execute() = 0;
@@ -155,10 +249,13 @@ private:
          /*synchronized*/ void Removed();
          void StartRunning();
          void StartTiming();
+         bool AddCompletion(uint8_t reasons, FIRSTCompletion callback, FIRSTCommand *next);
+         void Complete(uint8_t reason);
 
          String m_name;
-         double m_startTime;
-         double m_timeout;
+         unsigned long m_startTime;
+         unsigned long m_timeout;
+         bool m_timing;
          bool m_initialized;
          SubsystemSet m_requirements;
          bool m_running;
@@ -167,11 +264,29 @@ private:
          bool m_locked;
          bool m_runWhenDisabled;
          CommandGroup *m_parent;
+         FIRSTScheduler *m_scheduler;
+         unsigned long m_causeTime;
+         bool m_hasCause;
+         unsigned long m_budget;
+         unsigned long m_maxExecutionTime;
+         unsigned int m_budgetViolations;
+         uint8_t m_budgetPolicy;
+         bool m_demoted;
+         bool m_deferred;
+         const uint8_t *m_doneFlag;
          int m_commandID;
-         static int m_commandCounter;
+         typedef struct sCompletion {
+                 uint8_t reasons;
+                 FIRSTCompletion callback;
+                 FIRSTCommand *next;
+         } Completion;
+         Completion m_completions[kMaxCompletions];
+         uint8_t m_completionCount;
+         static const unsigned long kNoTimeout = (unsigned long)(-1);
 
 public:
          virtual String GetName();
+         const char *GetCName();
 };
 
 
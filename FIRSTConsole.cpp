@@ -0,0 +1,416 @@
+/*
+ * FIRSTConsole.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include "FIRSTConsole.h"
+#include "FIRSTCommand.h"
+#include "FIRSTSubsystem.h"
+#include "FIRSTScheduler.h"
+#include "FIRSTParameters.h"
+#include "FIRSTEventLog.h"
+
+#include <errno.h>
+
+static const uint8_t kEmpty = 0xFF;
+
+/**
+ * Creates a console.
+ * @param stream the port to read the lines from and to answer to, usually &Serial
+ */
+FIRSTConsole::FIRSTConsole(Stream *stream)
+	: m_stream(stream)
+	, m_parameters(NULL)
+	, m_length(0)
+	, m_overflow(false)
+	, m_built(false)
+	, m_pending(0)
+	, m_written(0)
+	, m_owned(NULL)
+	, m_value(0)
+	, m_maxRoom(0)
+	, m_commandCount(0)
+	, m_nameCount(0)
+	, m_seed(0)
+{
+	memset(m_slots, kEmpty, sizeof(m_slots));
+}
+
+FIRSTConsole::~FIRSTConsole()
+{
+}
+
+/**
+ * Makes a command known to the console by its name. The default commands of the
+ * subsystems are known without being added.
+ * @param command the command
+ * @return false if the console has no room left
+ */
+bool FIRSTConsole::Add(FIRSTCommand *command)
+{
+	if (command == NULL || m_commandCount >= kMaxNames)
+		return false;
+	m_commands[m_commandCount++] = command;
+	m_built = false;
+	return true;
+}
+
+/**
+ * Sets the parameters the console reads and changes (see {@link Parameters}).
+ * @param parameters the parameters (or NULL if there are none)
+ */
+void FIRSTConsole::SetParameters(FIRSTParameters *parameters)
+{
+	m_parameters = parameters;
+}
+
+/**
+ * The 32 bit FNV-1a hash of a name.
+ * @param name the name
+ * @return the hash
+ */
+uint32_t FIRSTConsole::Hash(const char *name)
+{
+	uint32_t hash = 2166136261UL;
+	while (*name != 0)
+	{
+		hash ^= (uint8_t)*name++;
+		hash *= 16777619UL;
+	}
+	return hash;
+}
+
+uint8_t FIRSTConsole::Slot(uint32_t hash)
+{
+	uint32_t mixed = (hash ^ (m_seed * 0x9E3779B9UL)) * 0x85EBCA6BUL;
+	return mixed >> (32 - kSlotBits);
+}
+
+bool FIRSTConsole::AddName(const char *text, FIRSTCommand *command, FIRSTSubsystem *subsystem)
+{
+	// A line is split at the spaces, such a name could never be looked up
+	if (strchr(text, ' ') != NULL)
+		return false;
+
+	// The same command twice is fine, another one with its name or its hash is left out
+	uint32_t hash = Hash(text);
+	for (uint8_t i = 0; i < m_nameCount; i++)
+	{
+		if (m_names[i].hash != hash)
+			continue;
+		if (strcmp(m_names[i].name, text) == 0 && m_names[i].command == command && m_names[i].subsystem == subsystem)
+			return true;
+		FIRSTEventLog::Log(FIRSTEventLog::kConsoleNameClash, hash);
+		return false;
+	}
+	if (m_nameCount >= kMaxNames)
+		return false;
+	Name *name = &m_names[m_nameCount++];
+	name->hash = hash;
+	name->name = text;
+	name->command = command;
+	name->subsystem = subsystem;
+	return true;
+}
+
+/**
+ * Builds the perfect hash of the names of the added commands, of the default commands
+ * and of the subsystems of the scheduler. Called by {@link Scheduler#Freeze()}, or on
+ * the first line if the scheduler is never frozen.
+ * @param scheduler the scheduler the commands and subsystems are on
+ * @return false if some names did not fit, had a space, clashed, or no seed was found;
+ * the names that fit are then looked up one by one
+ */
+bool FIRSTConsole::Build(FIRSTScheduler *scheduler)
+{
+	bool fits = true;
+	m_nameCount = 0;
+	for (uint8_t i = 0; i < m_commandCount; i++)
+		fits &= AddName(m_commands[i]->GetCName(), m_commands[i], NULL);
+
+	FIRSTCommand::SubsystemSet::iterator iter = scheduler->m_subsystems.begin();
+	for (; iter != scheduler->m_subsystems.end(); iter++)
+	{
+		FIRSTSubsystem *subsystem = *iter;
+		FIRSTCommand *command = subsystem->GetDefaultCommand();
+		if (command != NULL)
+			fits &= AddName(command->GetCName(), command, NULL);
+		fits &= AddName(subsystem->GetCName(), NULL, subsystem);
+	}
+	m_built = true;
+
+	for (m_seed = 0; m_seed < kMaxSeeds; m_seed++)
+	{
+		memset(m_slots, kEmpty, sizeof(m_slots));
+		uint8_t i;
+		for (i = 0; i < m_nameCount; i++)
+		{
+			uint8_t slot = Slot(m_names[i].hash);
+			if (m_slots[slot] != kEmpty)
+				break;
+			m_slots[slot] = i;
+		}
+		if (i == m_nameCount)
+			return fits;
+	}
+	return false;
+}
+
+FIRSTConsole::Name *FIRSTConsole::Find(const char *name)
+{
+	uint32_t hash = Hash(name);
+	if (m_seed < kMaxSeeds)
+	{
+		uint8_t index = m_slots[Slot(hash)];
+		if (index != kEmpty && m_names[index].hash == hash && strcmp(m_names[index].name, name) == 0)
+			return &m_names[index];
+		return NULL;
+	}
+
+	for (uint8_t i = 0; i < m_nameCount; i++)
+	{
+		if (m_names[i].hash == hash && strcmp(m_names[i].name, name) == 0)
+			return &m_names[i];
+	}
+	return NULL;
+}
+
+/**
+ * Reads the bytes that arrived and executes the complete lines. Never waits for bytes.
+ * Called by the {@link Scheduler} at the start of every pass.
+ * @param scheduler the scheduler the console is on
+ */
+void FIRSTConsole::Poll(FIRSTScheduler *scheduler)
+{
+	// The answer under way comes first, the next lines wait in the port
+	if (m_pending != 0)
+	{
+		Continue(scheduler);
+		if (m_pending != 0)
+			return;
+	}
+
+	// At most a line worth of bytes per pass, so a flood can not stretch the pass
+	for (int count = 0; count < kLineSize && m_stream->available() > 0; count++)
+	{
+		char c = m_stream->read();
+		if (c == '\r' || c == '\n')
+		{
+			if (m_overflow)
+			{
+				strcpy(m_line, "too long");
+				Answer('?', scheduler);
+			}
+			else if (m_length > 0)
+			{
+				m_line[m_length] = 0;
+				Execute(scheduler);
+			}
+			m_length = 0;
+			m_overflow = false;
+			if (m_pending != 0)
+				return;
+		}
+		else if (m_length < kLineSize)
+			m_line[m_length++] = c;
+		else
+			m_overflow = true;
+	}
+}
+
+void FIRSTConsole::Reply(const char *message)
+{
+	m_stream->println(message);
+}
+
+/**
+ * Returns how many bytes the port takes without blocking. A port that never tells
+ * (availableForWrite() always 0) is taken to have room for everything.
+ */
+int FIRSTConsole::GetRoom()
+{
+	int room = m_stream->availableForWrite();
+	if (room > m_maxRoom)
+		m_maxRoom = room;
+	if (m_maxRoom == 0)
+		return 0x7FFF;
+	return room;
+}
+
+/**
+ * Takes the room for a line, if there is. A line longer than the port ever had room
+ * for is let through, it would never fit otherwise.
+ */
+bool FIRSTConsole::Fits(int length, int *room)
+{
+	if (length > *room && length <= m_maxRoom)
+		return false;
+	*room -= length;
+	return true;
+}
+
+// The number of characters of a number, its sign included
+static int Digits(long value)
+{
+	int length = value < 0 ? 2 : 1;
+	for (; value >= 10 || value <= -10; value /= 10)
+		length++;
+	return length;
+}
+
+/**
+ * Starts an answer and writes as much of it as the port has room for.
+ * @param pending what the answer is: 'l' list, 'o' owner, 'p' a parameter value, '?' the
+ * line not understood, 'k' a plain ok
+ * @param scheduler the scheduler the console is on
+ */
+void FIRSTConsole::Answer(char pending, FIRSTScheduler *scheduler)
+{
+	m_pending = pending;
+	m_written = 0;
+	Continue(scheduler);
+}
+
+/**
+ * Writes as much of the answer under way as the port has room for: the next lines and
+ * the final ok. m_written counts the lines already written.
+ */
+void FIRSTConsole::Continue(FIRSTScheduler *scheduler)
+{
+	int room = GetRoom();
+	if (m_pending == 'l')
+	{
+		// The commands may have changed since the last pass, the count goes on
+		uint8_t index = 0;
+		FIRSTScheduler::CommandVector::iterator iter = scheduler->m_commands.begin();
+		for (; iter != scheduler->m_commands.end(); iter++)
+		{
+			if (index++ < m_written)
+				continue;
+			int id = (*iter)->GetID();
+			const char *name = (*iter)->GetCName();
+			if (!Fits(Digits(id) + strlen(name) + 3, &room))
+				return;
+			m_stream->print(id);
+			m_stream->print(' ');
+			m_stream->println(name);
+			m_written++;
+		}
+	}
+	else if (m_pending == 'o' && m_written == 0)
+	{
+		FIRSTCommand *command = m_owned->GetCurrentCommand();
+		const char *name = command == NULL ? "-" : command->GetCName();
+		if (!Fits(strlen(name) + 2, &room))
+			return;
+		m_stream->println(name);
+		m_written++;
+	}
+	else if (m_pending == 'p' && m_written == 0)
+	{
+		if (!Fits(Digits(m_value) + 2, &room))
+			return;
+		m_stream->println(m_value);
+		m_written++;
+	}
+	else if (m_pending == '?')
+	{
+		// Not understood, there is no ok
+		if (!Fits(strlen(m_line) + 4, &room))
+			return;
+		m_stream->print("? ");
+		m_stream->println(m_line);
+		m_pending = 0;
+		return;
+	}
+
+	if (!Fits(4, &room))
+		return;
+	Reply("ok");
+	m_pending = 0;
+}
+
+void FIRSTConsole::Execute(FIRSTScheduler *scheduler)
+{
+	if (!m_built)
+		Build(scheduler);
+
+	// The operation is the first letter of the first word, the name is the second word,
+	// the value the third
+	char *p = m_line;
+	while (*p == ' ')
+		p++;
+	char operation = *p;
+	while (*p != 0 && *p != ' ')
+		p++;
+	while (*p == ' ')
+		p++;
+	char *name = p;
+	while (*p != 0 && *p != ' ')
+		p++;
+	char *value = p;
+	if (*p != 0)
+	{
+		*p = 0;
+		value++;
+		while (*value == ' ')
+			value++;
+	}
+
+	Name *found = *name == 0 ? NULL : Find(name);
+	switch (operation)
+	{
+	case 's':
+		if (found == NULL || found->command == NULL)
+			break;
+		found->command->Start();
+		Answer('k', scheduler);
+		return;
+
+	case 'c':
+		if (found == NULL || found->command == NULL)
+			break;
+		found->command->Cancel();
+		Answer('k', scheduler);
+		return;
+
+	case 'l':
+		Answer('l', scheduler);
+		return;
+
+	case 'p':
+	{
+		if (m_parameters == NULL)
+			break;
+		const long *parameter = m_parameters->Get(name);
+		if (parameter == NULL)
+			break;
+		if (*value != 0)
+		{
+			// The whole value has to be a number of 32 bits, not only its start
+			char *end;
+			errno = 0;
+			long number = strtol(value, &end, 10);
+			if (end == value || *end != 0 || errno == ERANGE
+					|| number < INT32_MIN || number > INT32_MAX)
+				break;
+			m_parameters->Set(parameter, number);
+		}
+		m_value = *parameter;
+		Answer('p', scheduler);
+		return;
+	}
+
+	case 'o':
+		if (found == NULL || found->subsystem == NULL)
+			break;
+		m_owned = found->subsystem;
+		Answer('o', scheduler);
+		return;
+	}
+
+	// What is left of the line is the operation and the name
+	Answer('?', scheduler);
+}
@@ -0,0 +1,106 @@
+/*
+ * FIRSTConsole.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef FIRSTCONSOLE_H_
+#define FIRSTCONSOLE_H_
+
+#include <Arduino.h>
+
+class FIRSTCommand;
+class FIRSTSubsystem;
+class FIRSTScheduler;
+class FIRSTParameters;
+
+/**
+ * Line console for starting and canceling commands by name over a serial port, for
+ * bring-up. A line is an operation, only its first letter counts, and a name:
+ * <pre>
+ *   start NAME    starts the command          -> ok
+ *   cancel NAME   cancels the command         -> ok
+ *   list          the running commands        -> ID NAME, one per line, then ok
+ *   owner NAME    the command the subsystem runs -> NAME or -, then ok
+ *   param NAME [VALUE]  sets the parameter if given a value -> VALUE, then ok
+ * </pre>
+ * Unknown names and operations are answered with "? " and the line, and so is a parameter
+ * value that is not a whole decimal number of 32 bits. A name is a single
+ * word: Build() leaves out the names with a space, which could not be typed, and the
+ * second of two things with the same name or the same hash, which it logs (see
+ * {@link EventLog}).
+ *
+ * The {@link Scheduler} polls the console at the start of every pass. The bytes that
+ * arrived are read into a fixed line buffer, without waiting for more. Every answer is
+ * written a line at a time while the port has room for it, and goes on over the next
+ * passes; the lines that follow wait until it is done.
+ *
+ * Names are looked up through a perfect hash, built once by Build() (called by
+ * {@link Scheduler#Freeze()}) from the commands added to the console, the default
+ * commands and the subsystems of the scheduler. A name is known by its 32 bit FNV-1a
+ * hash, whose bits pick its slot once mixed with a seed searched for so that no two
+ * names share one. A lookup hashes the line, checks a single slot and compares the name
+ * found there with the line.
+ */
+class FIRSTConsole
+{
+public:
+	static const int kLineSize = 32;
+	static const int kMaxNames = 16;
+	static const int kSlotBits = 5;
+	static const int kSlots = 1 << kSlotBits;
+	static const uint16_t kMaxSeeds = 1024;
+
+	FIRSTConsole(Stream *stream);
+	virtual ~FIRSTConsole();
+
+	bool Add(FIRSTCommand *command);
+	void SetParameters(FIRSTParameters *parameters);
+	bool Build(FIRSTScheduler *scheduler);
+	void Poll(FIRSTScheduler *scheduler);
+
+	static uint32_t Hash(const char *name);
+
+private:
+	typedef struct sName {
+		uint32_t hash;
+		const char *name;
+		FIRSTCommand *command;
+		FIRSTSubsystem *subsystem;
+	} Name;
+
+	bool AddName(const char *text, FIRSTCommand *command, FIRSTSubsystem *subsystem);
+	uint8_t Slot(uint32_t hash);
+	Name *Find(const char *name);
+	void Execute(FIRSTScheduler *scheduler);
+	void Continue(FIRSTScheduler *scheduler);
+	int GetRoom();
+	bool Fits(int length, int *room);
+	void Answer(char pending, FIRSTScheduler *scheduler);
+	void Reply(const char *message);
+
+	Stream *m_stream;
+	FIRSTParameters *m_parameters;
+	char m_line[kLineSize + 1];
+	uint8_t m_length;
+	bool m_overflow;
+	bool m_built;
+
+	char m_pending;
+	uint8_t m_written;
+	FIRSTSubsystem *m_owned;
+	long m_value;
+	int m_maxRoom;
+
+	FIRSTCommand *m_commands[kMaxNames];
+	uint8_t m_commandCount;
+
+	Name m_names[kMaxNames];
+	uint8_t m_nameCount;
+	uint8_t m_slots[kSlots];
+	uint16_t m_seed;
+};
+
+
+#endif /* FIRSTCONSOLE_H_ */
@@ -0,0 +1,349 @@
+/*
+ * FIRSTControl.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include "FIRSTControl.h"
+#include "FIRSTScheduler.h"
+
+/**
+ * Creates a rate limiter.
+ * @param rate the largest change allowed per second
+ */
+FIRSTRateLimiter::FIRSTRateLimiter(int32_t rate)
+	: m_rate(rate)
+	, m_value(0)
+{
+}
+
+/**
+ * Moves the value toward the input, as far as the rate allows.
+ * @param input the value wanted
+ * @param dt the time step (in seconds)
+ * @return the limited value
+ */
+int32_t FIRSTRateLimiter::Calculate(int32_t input, int32_t dt)
+{
+	int32_t step = FIRSTFixed::Mul(m_rate, dt);
+	int32_t change = FIRSTFixed::Saturate((int64_t)input - m_value);
+	m_value += FIRSTFixed::Clamp(change, -step, step);
+	return m_value;
+}
+
+void FIRSTRateLimiter::Reset(int32_t value)
+{
+	m_value = value;
+}
+
+int32_t FIRSTRateLimiter::Get()
+{
+	return m_value;
+}
+
+/**
+ * Creates a motion profile. The limits are taken as positive, 0 being no limit.
+ * @param maxVelocity the cruise velocity (in units per second)
+ * @param maxAcceleration the largest acceleration (in units per second squared), or 0 to
+ * change the velocity at once
+ * @param maxJerk the largest jerk, or 0 for a trapezoidal profile
+ */
+FIRSTMotionProfile::FIRSTMotionProfile(int32_t maxVelocity, int32_t maxAcceleration, int32_t maxJerk)
+	: m_maxVelocity(maxVelocity == 0 ? FIRSTFixed::kMax : FIRSTFixed::Abs(maxVelocity))
+	, m_maxAcceleration(maxAcceleration == 0 ? FIRSTFixed::kMax : FIRSTFixed::Abs(maxAcceleration))
+	, m_maxJerk(FIRSTFixed::Abs(maxJerk))
+	, m_rampTime(0)
+	, m_start(0)
+	, m_distance(0)
+	, m_traveled(0)
+	, m_velocity(0)
+	, m_acceleration(0)
+	, m_reverse(false)
+	, m_done(true)
+{
+	m_halfInverseAcceleration = FIRSTFixed::Invert(FIRSTFixed::Saturate(2 * (int64_t)m_maxAcceleration));
+	m_inverseJerk = FIRSTFixed::Invert(m_maxJerk > 0 ? m_maxJerk : 1);
+	if (m_maxJerk > 0)
+		m_rampTime = FIRSTFixed::Div(m_maxAcceleration, FIRSTFixed::Saturate(2 * (int64_t)m_maxJerk));
+}
+
+/**
+ * Starts a new profile, at rest.
+ * @param position where the motion starts
+ * @param goal where it ends
+ */
+void FIRSTMotionProfile::Start(int32_t position, int32_t goal)
+{
+	m_start = position;
+	m_reverse = goal < position;
+	m_distance = FIRSTFixed::Abs(goal - position);
+	m_traveled = 0;
+	m_velocity = 0;
+	m_acceleration = 0;
+	m_done = m_distance == 0;
+}
+
+/**
+ * Advances the profile by a time step.
+ * The profile is computed as a forward motion and mirrored for a backward one.
+ * @param dt the time step (in seconds)
+ * @return whether the goal is reached
+ */
+bool FIRSTMotionProfile::Step(int32_t dt)
+{
+	if (m_done || dt <= 0)
+		return m_done;
+
+	int32_t remaining = m_distance - m_traveled;
+
+	// Distance needed to stop from the current velocity: v^2 / 2a, and with a jerk limit
+	// v a / 2j to ramp the deceleration up, v a' / j to ramp the acceleration down first
+	int64_t time = FIRSTFixed::DivBy(m_velocity, m_halfInverseAcceleration);
+	if (m_maxJerk > 0)
+	{
+		time += m_rampTime;
+		if (m_acceleration > 0)
+			time += FIRSTFixed::DivBy(m_acceleration, m_inverseJerk);
+	}
+	int64_t stopping = (m_velocity * time) >> 16;
+
+	int32_t target;
+	if (remaining <= stopping)
+		target = -m_maxAcceleration;
+	else if (m_velocity < m_maxVelocity)
+		target = m_maxAcceleration;
+	else
+		target = 0;
+
+	if (m_maxJerk > 0)
+	{
+		int32_t step = FIRSTFixed::Mul(m_maxJerk, dt);
+		m_acceleration += FIRSTFixed::Clamp(FIRSTFixed::Saturate((int64_t)target - m_acceleration), -step, step);
+	}
+	else
+		m_acceleration = target;
+
+	int32_t previous = m_velocity;
+	// Without limits the velocity goes up to kMax, the sums have to saturate
+	m_velocity = FIRSTFixed::Clamp(FIRSTFixed::Saturate((int64_t)m_velocity + FIRSTFixed::Mul(m_acceleration, dt)),
+			0, m_maxVelocity);
+	// Trapezoidal integration of the velocity
+	m_traveled = FIRSTFixed::Saturate((int64_t)m_traveled + FIRSTFixed::Mul(previous / 2 + m_velocity / 2, dt));
+
+	if (m_traveled >= m_distance || (m_velocity == 0 && m_acceleration < 0))
+	{
+		// Whatever is left is within one step of rounding
+		m_traveled = m_distance;
+		m_velocity = 0;
+		m_acceleration = 0;
+		m_done = true;
+	}
+	return m_done;
+}
+
+int32_t FIRSTMotionProfile::GetPosition()
+{
+	return m_reverse ? m_start - m_traveled : m_start + m_traveled;
+}
+
+int32_t FIRSTMotionProfile::GetVelocity()
+{
+	return m_reverse ? -m_velocity : m_velocity;
+}
+
+int32_t FIRSTMotionProfile::GetAcceleration()
+{
+	return m_reverse ? -m_acceleration : m_acceleration;
+}
+
+bool FIRSTMotionProfile::IsDone()
+{
+	return m_done;
+}
+
+/**
+ * Creates a PID command.
+ * @param subsystem the subsystem to drive, it is required
+ * @param p the proportional gain
+ * @param i the integral gain
+ * @param d the derivative gain
+ * @param timeout the time (in seconds) before the command "times out", or negative for never
+ */
+FIRSTPIDCommand::FIRSTPIDCommand(FIRSTSetpointSubsystem *subsystem, int32_t p, int32_t i, int32_t d, double timeout)
+	: FIRSTCommand(timeout)
+	, m_subsystem(subsystem)
+	, m_p(p)
+	, m_i(i)
+	, m_d(d)
+	, m_setpoint(0)
+	, m_minimum(-FIRSTFixed::kOne)
+	, m_maximum(FIRSTFixed::kOne)
+	, m_tolerance(0)
+	, m_integral(0)
+	, m_error(0)
+	, m_lastMeasurement(0)
+	, m_first(true)
+{
+	Requires(subsystem);
+}
+
+void FIRSTPIDCommand::SetGains(int32_t p, int32_t i, int32_t d)
+{
+	m_p = p;
+	m_i = i;
+	m_d = d;
+}
+
+void FIRSTPIDCommand::SetSetpoint(int32_t setpoint)
+{
+	m_setpoint = setpoint;
+}
+
+int32_t FIRSTPIDCommand::GetSetpoint()
+{
+	return m_setpoint;
+}
+
+/**
+ * Sets the range the output is clamped to, -1 to 1 by default.
+ * @param minimum the lowest output
+ * @param maximum the highest output
+ */
+void FIRSTPIDCommand::SetOutputRange(int32_t minimum, int32_t maximum)
+{
+	m_minimum = minimum;
+	m_maximum = maximum;
+}
+
+/**
+ * Sets how close to the setpoint is on target. With a tolerance the command finishes
+ * once on target, with none (0, the default) it keeps running.
+ * @param tolerance the largest error that is on target
+ */
+void FIRSTPIDCommand::SetTolerance(int32_t tolerance)
+{
+	m_tolerance = tolerance;
+}
+
+int32_t FIRSTPIDCommand::GetTolerance()
+{
+	return m_tolerance;
+}
+
+/**
+ * Returns the error as of the last execution.
+ * @return the setpoint minus the measurement
+ */
+int32_t FIRSTPIDCommand::GetError()
+{
+	return m_error;
+}
+
+bool FIRSTPIDCommand::OnTarget()
+{
+	return !m_first && FIRSTFixed::Abs(m_error) <= m_tolerance;
+}
+
+/**
+ * Returns the time step of the current pass.
+ * @return the time since the previous pass (in seconds)
+ */
+int32_t FIRSTPIDCommand::GetTimeStep()
+{
+	return FIRSTFixed::FromMicros(GetScheduler()->GetPassDelta());
+}
+
+void FIRSTPIDCommand::Initialize()
+{
+	m_integral = 0;
+	m_first = true;
+}
+
+void FIRSTPIDCommand::Execute()
+{
+	int32_t dt = GetTimeStep();
+	int32_t measurement = m_subsystem->GetMeasurement();
+	m_error = FIRSTFixed::Saturate((int64_t)m_setpoint - measurement);
+
+	int64_t output = FIRSTFixed::Mul(m_p, m_error);
+	if (!m_first && dt > 0)
+	{
+		int32_t change = FIRSTFixed::Saturate((int64_t)measurement - m_lastMeasurement);
+		int32_t rate = FIRSTFixed::DivStep(change, dt);
+		output -= FIRSTFixed::Mul(m_d, rate);
+	}
+
+	int32_t integral = FIRSTFixed::Saturate(m_integral + (int64_t)FIRSTFixed::Mul(m_error, dt));
+	int32_t unclamped = FIRSTFixed::Saturate(output + FIRSTFixed::Mul(m_i, integral));
+	// Anti-windup: only integrate when that does not push further into saturation
+	if (!((unclamped > m_maximum && m_error > 0) || (unclamped < m_minimum && m_error < 0)))
+		m_integral = integral;
+	output += FIRSTFixed::Mul(m_i, m_integral);
+
+	m_lastMeasurement = measurement;
+	m_first = false;
+	m_subsystem->SetOutput(FIRSTFixed::Clamp(FIRSTFixed::Saturate(output), m_minimum, m_maximum));
+}
+
+bool FIRSTPIDCommand::IsFinished()
+{
+	return IsTimedOut() || (m_tolerance > 0 && OnTarget());
+}
+
+void FIRSTPIDCommand::End()
+{
+	m_subsystem->SetOutput(0);
+}
+
+void FIRSTPIDCommand::Interrupted()
+{
+	End();
+}
+
+/**
+ * Creates a profiled PID command.
+ * @param subsystem the subsystem to drive, it is required
+ * @param p the proportional gain
+ * @param i the integral gain
+ * @param d the derivative gain
+ * @param profile the profile generator, it may be shared by commands that do not run
+ * at the same time
+ * @param goal the position to go to
+ * @param timeout the time (in seconds) before the command "times out", or negative for never
+ */
+FIRSTProfileCommand::FIRSTProfileCommand(FIRSTSetpointSubsystem *subsystem, int32_t p, int32_t i, int32_t d,
+		FIRSTMotionProfile *profile, int32_t goal, double timeout)
+	: FIRSTPIDCommand(subsystem, p, i, d, timeout)
+	, m_profile(profile)
+	, m_goal(goal)
+{
+}
+
+/**
+ * Sets the goal for the next time the command starts.
+ * @param goal the position to go to
+ */
+void FIRSTProfileCommand::SetGoal(int32_t goal)
+{
+	m_goal = goal;
+}
+
+void FIRSTProfileCommand::Initialize()
+{
+	FIRSTPIDCommand::Initialize();
+	m_profile->Start(m_subsystem->GetMeasurement(), m_goal);
+	SetSetpoint(m_profile->GetPosition());
+}
+
+void FIRSTProfileCommand::Execute()
+{
+	m_profile->Step(GetTimeStep());
+	SetSetpoint(m_profile->GetPosition());
+	FIRSTPIDCommand::Execute();
+}
+
+bool FIRSTProfileCommand::IsFinished()
+{
+	return IsTimedOut() || (m_profile->IsDone() && (GetTolerance() == 0 || OnTarget()));
+}
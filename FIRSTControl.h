@@ -0,0 +1,155 @@
+/*
+ * FIRSTControl.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef FIRSTCONTROL_H_
+#define FIRSTCONTROL_H_
+
+#include <Arduino.h>
+
+#include "FIRSTCommand.h"
+#include "FIRSTSubsystem.h"
+#include "FIRSTFixed.h"
+
+/**
+ * A subsystem that closed loop commands can drive: it has one measurement and takes
+ * one output, both Q16.16 fixed point (see {@link Fixed}) in units of its choosing.
+ */
+class FIRSTSetpointSubsystem : public FIRSTSubsystem
+{
+public:
+	FIRSTSetpointSubsystem(const char *name, FIRSTScheduler *scheduler = NULL)
+		: FIRSTSubsystem(name, scheduler) {};
+	virtual int32_t GetMeasurement() = 0;
+	virtual void SetOutput(int32_t output) = 0;
+};
+
+/**
+ * Limits how fast a value may change.
+ */
+class FIRSTRateLimiter
+{
+public:
+	FIRSTRateLimiter(int32_t rate);
+	int32_t Calculate(int32_t input, int32_t dt);
+	void Reset(int32_t value);
+	int32_t Get();
+
+private:
+	int32_t m_rate;
+	int32_t m_value;
+};
+
+/**
+ * Generates a motion profile from one position to another, one time step at a time.
+ * Without a jerk limit the profile is trapezoidal: accelerate, cruise, decelerate.
+ * With one the acceleration ramps up and down too, giving an S-curve.
+ *
+ * The stopping distance is kept in 64 bits, so velocities may use the whole Q16.16
+ * range. The limits are inverted once, so a step takes no division.
+ */
+class FIRSTMotionProfile
+{
+public:
+	FIRSTMotionProfile(int32_t maxVelocity, int32_t maxAcceleration, int32_t maxJerk = 0);
+	void Start(int32_t position, int32_t goal);
+	bool Step(int32_t dt);
+	int32_t GetPosition();
+	int32_t GetVelocity();
+	int32_t GetAcceleration();
+	bool IsDone();
+
+private:
+	int32_t m_maxVelocity;
+	int32_t m_maxAcceleration;
+	int32_t m_maxJerk;
+	FIRSTFixed::Reciprocal m_halfInverseAcceleration;
+	FIRSTFixed::Reciprocal m_inverseJerk;
+	int32_t m_rampTime;
+	int32_t m_start;
+	int32_t m_distance;
+	int32_t m_traveled;
+	int32_t m_velocity;
+	int32_t m_acceleration;
+	bool m_reverse;
+	bool m_done;
+};
+
+/**
+ * Drives a {@link SetpointSubsystem} to a setpoint with a PID controller.
+ *
+ * All the math is Q16.16 fixed point, and the time step is the time between two scheduler
+ * passes. The derivative acts on the measurement, so setpoint changes do not kick the
+ * output. The integral stops growing while the output is saturated in the direction of
+ * the error (anti-windup).
+ *
+ * Without a tolerance (and a timeout) the command never finishes, it is meant to be
+ * the default command of the subsystem or to be interrupted.
+ */
+class FIRSTPIDCommand : public FIRSTCommand
+{
+public:
+	FIRSTPIDCommand(FIRSTSetpointSubsystem *subsystem, int32_t p, int32_t i, int32_t d, double timeout = -1.0);
+
+	void SetGains(int32_t p, int32_t i, int32_t d);
+	void SetSetpoint(int32_t setpoint);
+	int32_t GetSetpoint();
+	void SetOutputRange(int32_t minimum, int32_t maximum);
+	void SetTolerance(int32_t tolerance);
+	int32_t GetTolerance();
+	int32_t GetError();
+	bool OnTarget();
+
+protected:
+	virtual void Initialize();
+	virtual void Execute();
+	virtual bool IsFinished();
+	virtual void End();
+	virtual void Interrupted();
+
+	int32_t GetTimeStep();
+
+	FIRSTSetpointSubsystem *m_subsystem;
+
+private:
+	int32_t m_p;
+	int32_t m_i;
+	int32_t m_d;
+	int32_t m_setpoint;
+	int32_t m_minimum;
+	int32_t m_maximum;
+	int32_t m_tolerance;
+	int32_t m_integral;
+	int32_t m_error;
+	int32_t m_lastMeasurement;
+	bool m_first;
+};
+
+/**
+ * Follows a {@link MotionProfile} to a goal, the PID controller tracking the profiled
+ * position. Finishes when the profile is done and, if it has a tolerance, the error is
+ * within it.
+ */
+class FIRSTProfileCommand : public FIRSTPIDCommand
+{
+public:
+	FIRSTProfileCommand(FIRSTSetpointSubsystem *subsystem, int32_t p, int32_t i, int32_t d,
+			FIRSTMotionProfile *profile, int32_t goal, double timeout = -1.0);
+
+	void SetGoal(int32_t goal);
+
+protected:
+	virtual void Initialize();
+	virtual void Execute();
+	virtual bool IsFinished();
+
+private:
+	FIRSTMotionProfile *m_profile;
+	int32_t m_goal;
+};
+
+
+#endif /* FIRSTCONTROL_H_ */
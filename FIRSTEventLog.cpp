@@ -0,0 +1,253 @@
+/*
+ * FIRSTEventLog.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include "FIRSTEventLog.h"
+#include "FIRSTTelemetry.h"
+#include "FIRSTScheduler.h"
+
+#if defined(__AVR__)
+#include <avr/eeprom.h>
+#endif
+
+FIRST_THREAD_LOCAL FIRSTEventLog::Event FIRSTEventLog::m_ring[kRingSize];
+FIRST_THREAD_LOCAL uint8_t FIRSTEventLog::m_head = 0;
+FIRST_THREAD_LOCAL uint8_t FIRSTEventLog::m_count = 0;
+FIRST_THREAD_LOCAL unsigned long FIRSTEventLog::m_lost = 0;
+FIRST_THREAD_LOCAL bool FIRSTEventLog::m_roomKnown = false;
+FIRST_THREAD_LOCAL FIRSTScheduler *FIRSTEventLog::m_clock = NULL;
+
+#if defined(FIRST_EVENTLOG_TEXT)
+static const char kUnknown[] PROGMEM = "Unknown event";
+static const char kStartInGroup[] PROGMEM = "Can not start a command that is part of a command group";
+static const char kCancelInGroup[] PROGMEM = "Can not cancel a command that is part of a command group";
+static const char kRequirementAfterLock[] PROGMEM = "Can not add new requirement to command after being started or being added to a command group";
+static const char kSchedulerAfterLock[] PROGMEM = "Can not change the scheduler of command after being started or being added to a command group";
+static const char kNullParent[] PROGMEM = "Parent command group is NULL";
+static const char kParentAlreadySet[] PROGMEM = "Can not give command to a command group after already being put in a command group";
+static const char kAddDuringAdd[] PROGMEM = "Can not start command from cancel method";
+static const char kNullSubsystem[] PROGMEM = "Subsystem is NULL";
+static const char kNullCommand[] PROGMEM = "Command is NULL";
+static const char kDefaultNotRequiring[] PROGMEM = "A default command must require the subsystem";
+static const char kRoutineFault[] PROGMEM = "Invalid routine instruction or operand at program counter";
+
+static const char kBudgetExceeded[] PROGMEM = "Command exceeded its execution budget";
+static const char kPassOverrun[] PROGMEM = "Scheduler pass overran its budget (microseconds)";
+static const char kRegisterAfterFreeze[] PROGMEM = "Can not register with a scheduler after it was frozen";
+static const char kTelemetryTruncated[] PROGMEM = "Telemetry reports the owners of the first 16 subsystems only";
+static const char kCrossScheduler[] PROGMEM = "A command can not require subsystems of another scheduler";
+static const char kSegmentOverlap[] PROGMEM = "LED segment overlaps another one, left empty (start)";
+static const char kConsoleNameClash[] PROGMEM = "Console name taken by another command or subsystem, or with the same hash, left out (hash)";
+static const char kParameterNameClash[] PROGMEM = "Parameter name has the same hash as another one, not declared (hash)";
+
+static const char * const kMessages[FIRSTEventLog::kEventCount] PROGMEM = {
+	kUnknown,
+	kStartInGroup,
+	kCancelInGroup,
+	kRequirementAfterLock,
+	kSchedulerAfterLock,
+	kNullParent,
+	kParentAlreadySet,
+	kAddDuringAdd,
+	kNullSubsystem,
+	kNullCommand,
+	kDefaultNotRequiring,
+	kRoutineFault,
+	kBudgetExceeded,
+	kPassOverrun,
+	kRegisterAfterFreeze,
+	kTelemetryTruncated,
+	kCrossScheduler,
+	kSegmentOverlap,
+	kConsoleNameClash,
+	kParameterNameClash,
+};
+#endif
+
+/**
+ * Logs an event.
+ * @param event the event ID
+ * @param argument whatever helps to find what happened, usually the ID of the command
+ */
+void FIRSTEventLog::Log(uint8_t event, uint16_t argument)
+{
+	uint16_t time = m_clock == NULL ? millis() : m_clock->Millis();
+#if defined(__AVR__)
+	uint8_t oldSREG = SREG;
+	cli();
+#endif
+	Event *slot = &m_ring[m_head];
+	slot->event = event;
+	slot->argument = argument;
+	slot->time = time;
+	m_head = (m_head + 1) % kRingSize;
+	if (m_count < kRingSize)
+		m_count++;
+	else
+		m_lost++;
+#if defined(__AVR__)
+	SREG = oldSREG;
+#endif
+}
+
+/**
+ * Sets the scheduler whose clock stamps the events. Every {@link Scheduler} sets itself
+ * at the start of its passes.
+ * @param scheduler the scheduler, NULL for millis()
+ */
+void FIRSTEventLog::SetClock(FIRSTScheduler *scheduler)
+{
+#if defined(__AVR__)
+	// A pointer takes two writes, an interrupt handler logging in between would follow half
+	uint8_t oldSREG = SREG;
+	cli();
+#endif
+	m_clock = scheduler;
+#if defined(__AVR__)
+	SREG = oldSREG;
+#endif
+}
+
+FIRSTScheduler *FIRSTEventLog::GetClock()
+{
+	return m_clock;
+}
+
+/**
+ * Returns the number of events waiting to be drained.
+ * @return the number of events in the ring
+ */
+int FIRSTEventLog::GetCount()
+{
+	return m_count;
+}
+
+/**
+ * Returns the number of events overwritten before they were drained.
+ * @return the number of lost events
+ */
+unsigned long FIRSTEventLog::GetLost()
+{
+	return m_lost;
+}
+
+/**
+ * Sends the oldest events as COBS framed binary records, as many as the port takes
+ * without blocking. Call it from loop() or whenever there is time. A Print that never
+ * tells its room (availableForWrite() always 0) is given all the events at once.
+ * @param out where to send the records to, usually &Serial
+ * @return the number of events sent
+ */
+int FIRSTEventLog::Drain(Print *out)
+{
+	int sent = 0;
+	uint8_t record[kRecordSize];
+	uint8_t frame[kRecordSize + 2];
+
+	int room = out->availableForWrite();
+	if (room > 0)
+		m_roomKnown = true;
+	else if (!m_roomKnown)
+		room = kRingSize * (int)sizeof(frame);
+	for (; m_count > 0 && room >= (int)sizeof(frame); room -= sizeof(frame))
+	{
+#if defined(__AVR__)
+		uint8_t oldSREG = SREG;
+		cli();
+#endif
+		Event *event = &m_ring[(m_head + kRingSize - m_count) % kRingSize];
+		record[0] = event->event;
+		record[1] = event->argument;
+		record[2] = event->argument >> 8;
+		record[3] = event->time;
+		record[4] = event->time >> 8;
+		m_count--;
+#if defined(__AVR__)
+		SREG = oldSREG;
+#endif
+		int length = FIRSTTelemetry::EncodeCOBS(record, kRecordSize, frame);
+		out->write(frame, length + 1);
+		sent++;
+	}
+	return sent;
+}
+
+/**
+ * Prints the events waiting as text, one per line, and empties the ring: with their
+ * messages if FIRST_EVENTLOG_TEXT is defined, by ID otherwise.
+ * Unlike Drain() this blocks until everything is printed, it is meant for bring-up.
+ * @param out where to print to
+ */
+void FIRSTEventLog::Dump(Print *out)
+{
+	while (m_count > 0)
+	{
+		Event event = m_ring[(m_head + kRingSize - m_count) % kRingSize];
+		m_count--;
+		out->print((unsigned int)event.time);
+		out->print(": ");
+#if defined(FIRST_EVENTLOG_TEXT)
+		PrintMessage(out, event.event);
+#else
+		out->print("event ");
+		out->print((unsigned int)event.event);
+#endif
+		out->print(" (");
+		out->print((unsigned int)event.argument);
+		out->println(")");
+	}
+}
+
+/**
+ * Saves the events waiting to the EEPROM, without removing them from the ring: first
+ * their number, then the binary records. Only the bytes that differ are written.
+ * Writing the EEPROM takes milliseconds per byte, so this is meant for the shutdown or
+ * for after a fault. Off the AVR this does nothing.
+ * @param address where to save to in the EEPROM
+ * @return the number of bytes saved
+ */
+int FIRSTEventLog::Save(int address)
+{
+#if defined(__AVR__)
+	uint8_t *p = (uint8_t *)address;
+	eeprom_update_byte(p++, m_count);
+	for (uint8_t i = m_count; i > 0; i--)
+	{
+		Event *event = &m_ring[(m_head + kRingSize - i) % kRingSize];
+		eeprom_update_byte(p++, event->event);
+		eeprom_update_word((uint16_t *)p, event->argument);
+		p += 2;
+		eeprom_update_word((uint16_t *)p, event->time);
+		p += 2;
+	}
+	return 1 + m_count * kRecordSize;
+#else
+	(void)address;
+	return 0;
+#endif
+}
+
+void FIRSTEventLog::Clear()
+{
+	m_count = 0;
+	m_lost = 0;
+}
+
+#if defined(FIRST_EVENTLOG_TEXT)
+/**
+ * Prints the message of an event from flash.
+ * @param out where to print to
+ * @param event the event ID
+ */
+void FIRSTEventLog::PrintMessage(Print *out, uint8_t event)
+{
+	if (event >= kEventCount)
+		event = 0;
+	const char *message = (const char *)pgm_read_ptr(&kMessages[event]);
+	for (char c = pgm_read_byte(message); c != 0; c = pgm_read_byte(++message))
+		out->print(c);
+}
+#endif
@@ -0,0 +1,97 @@
+/*
+ * FIRSTEventLog.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef FIRSTEVENTLOG_H_
+#define FIRSTEVENTLOG_H_
+
+#include <Arduino.h>
+
+class FIRSTScheduler;
+
+// Off the AVR every thread has a log of its own, for schedulers simulated side by side
+#if defined(__AVR__)
+#define FIRST_THREAD_LOCAL
+#else
+#define FIRST_THREAD_LOCAL thread_local
+#endif
+
+/**
+ * Binary log of errors and events, replacing the WPILib error reporting.
+ *
+ * A site logs an event ID and one raw argument, usually the ID of the command involved.
+ * That is five bytes put in a ring buffer, with no formatting; when the ring is full the
+ * oldest events are overwritten and counted as lost. The events are drained later, either
+ * as COBS framed binary records over a serial port, as text, or saved to EEPROM.
+ *
+ * A binary record is: event ID (1 byte), argument (2 bytes, little endian), time
+ * (2 bytes, the low 16 bits of millis(), little endian). The time is that of the
+ * {@link Scheduler} that ran last (see {@link Scheduler#Millis()}), which may be virtual. The records are turned into
+ * text on the host by extras/tools/EventLogDecoder. The messages for the event IDs only
+ * take flash on the board when FIRST_EVENTLOG_TEXT is defined, for PrintMessage() and
+ * Dump(); without it Dump() prints the IDs.
+ *
+ * Logging is safe from interrupt handlers. On the host the log is kept per thread, so
+ * that threads each running their own schedulers do not mix their events.
+ */
+class FIRSTEventLog
+{
+public:
+	enum {
+		kStartInGroup = 1,
+		kCancelInGroup,
+		kRequirementAfterLock,
+		kSchedulerAfterLock,
+		kNullParent,
+		kParentAlreadySet,
+		kAddDuringAdd,
+		kNullSubsystem,
+		kNullCommand,
+		kDefaultNotRequiring,
+		kRoutineFault,
+		kBudgetExceeded,
+		kPassOverrun,
+		kRegisterAfterFreeze,
+		kTelemetryTruncated,
+		kCrossScheduler,
+		kSegmentOverlap,
+		kConsoleNameClash,
+		kParameterNameClash,
+		kEventCount
+	};
+	static const int kRingSize = 16;
+	static const int kRecordSize = 5;
+
+	static void Log(uint8_t event, uint16_t argument);
+	static int GetCount();
+	static unsigned long GetLost();
+	static int Drain(Print *out);
+	static void Dump(Print *out);
+	static int Save(int address);
+	static void Clear();
+	static void SetClock(FIRSTScheduler *scheduler);
+	static FIRSTScheduler *GetClock();
+#if defined(FIRST_EVENTLOG_TEXT)
+	static void PrintMessage(Print *out, uint8_t event);
+#endif
+
+private:
+	typedef struct sEvent {
+		uint8_t event;
+		uint16_t argument;
+		uint16_t time;
+	} Event;
+
+	static FIRST_THREAD_LOCAL Event m_ring[kRingSize];
+	static FIRST_THREAD_LOCAL uint8_t m_head;
+	static FIRST_THREAD_LOCAL uint8_t m_count;
+	static FIRST_THREAD_LOCAL unsigned long m_lost;
+	static FIRST_THREAD_LOCAL bool m_roomKnown;
+	static FIRST_THREAD_LOCAL FIRSTScheduler *m_clock;
+};
+
+
+#endif /* FIRSTEVENTLOG_H_ */
@@ -0,0 +1,164 @@
+/*
+ * FIRSTExecutive.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include "FIRSTExecutive.h"
+#include "FIRSTScheduler.h"
+
+/**
+ * Creates an executive.
+ * @param clock the scheduler whose clock times the groups, the default one if NULL
+ */
+FIRSTExecutive::FIRSTExecutive(FIRSTScheduler *clock)
+	: m_clock(clock == NULL ? FIRSTScheduler::GetInstance() : clock)
+	, m_groupCount(0)
+	, m_started(false)
+	, m_windowStart(0)
+{
+}
+
+FIRSTExecutive::~FIRSTExecutive()
+{
+}
+
+/**
+ * Adds a rate group.
+ * Groups should all be added before the first call to Run().
+ * @param scheduler the scheduler of the group
+ * @param period how often to run the scheduler (in microseconds)
+ * @param phase delay of the first pass (in microseconds), used to keep groups with
+ * harmonic periods from becoming due at the same time
+ * @return false if there is no room for another group
+ */
+bool FIRSTExecutive::AddGroup(FIRSTScheduler *scheduler, unsigned long period, unsigned long phase)
+{
+	if (scheduler == NULL || period == 0 || m_groupCount >= kMaxGroups)
+		return false;
+
+	// Keep the groups sorted by period, the shortest (the highest priority) first
+	int i = m_groupCount++;
+	for (; i > 0 && m_groups[i - 1].period > period; i--)
+		m_groups[i] = m_groups[i - 1];
+
+	m_groups[i].scheduler = scheduler;
+	m_groups[i].period = period;
+	m_groups[i].phase = phase;
+	m_groups[i].next = 0;
+	m_groups[i].busy = 0;
+	m_groups[i].overruns = 0;
+	m_groups[i].utilization = 0;
+	return true;
+}
+
+/**
+ * Runs every group that is due, the highest priority first.
+ */
+void FIRSTExecutive::Run()
+{
+	unsigned long now = m_clock->Micros();
+	if (!m_started)
+	{
+		m_started = true;
+		m_windowStart = micros();
+		for (int i = 0; i < m_groupCount; i++)
+			m_groups[i].next = now + m_groups[i].phase;
+	}
+
+	for (int i = 0; i < m_groupCount;)
+	{
+		Group *group = &m_groups[i];
+		if ((long)(now - group->next) >= 0)
+		{
+			RunGroup(group);
+			now = m_clock->Micros();
+			// Something of a higher priority may have become due in the meantime
+			i = 0;
+		}
+		else
+			i++;
+	}
+
+	UpdateUtilization();
+}
+
+void FIRSTExecutive::RunGroup(Group *group)
+{
+	group->scheduler->Run();
+	group->busy += group->scheduler->GetLastRunTime();
+
+	unsigned long now = m_clock->Micros();
+	group->next += group->period;
+	if ((long)(now - group->next) >= 0)
+	{
+		// A whole period was missed, skip it instead of trying to catch up
+		group->overruns++;
+		group->next = now + group->period;
+	}
+}
+
+// The passes are timed in real time whatever the clock of the groups, so is the window
+void FIRSTExecutive::UpdateUtilization()
+{
+	unsigned long now = micros();
+	unsigned long elapsed = now - m_windowStart;
+	if (elapsed < kUtilizationWindow)
+		return;
+
+	for (int i = 0; i < m_groupCount; i++)
+	{
+		m_groups[i].utilization = m_groups[i].busy / (elapsed / 100);
+		m_groups[i].busy = 0;
+	}
+	m_windowStart = now;
+}
+
+FIRSTExecutive::Group *FIRSTExecutive::FindGroup(FIRSTScheduler *scheduler)
+{
+	for (int i = 0; i < m_groupCount; i++)
+	{
+		if (m_groups[i].scheduler == scheduler)
+			return &m_groups[i];
+	}
+	return NULL;
+}
+
+/**
+ * Returns the share of the time a group spent in its scheduler over the last window.
+ * Both are real time, even when the groups run on a virtual clock.
+ * @param scheduler the scheduler of the group
+ * @return the utilization of the group (in percent)
+ */
+unsigned int FIRSTExecutive::GetUtilization(FIRSTScheduler *scheduler)
+{
+	Group *group = FindGroup(scheduler);
+	return group == NULL ? 0 : group->utilization;
+}
+
+/**
+ * Returns how many times a group missed a whole period, either because a pass took
+ * longer than the period or because other groups kept it waiting.
+ * @param scheduler the scheduler of the group
+ * @return the number of overruns of the group
+ */
+unsigned int FIRSTExecutive::GetOverruns(FIRSTScheduler *scheduler)
+{
+	Group *group = FindGroup(scheduler);
+	return group == NULL ? 0 : group->overruns;
+}
+
+/**
+ * Returns the utilization of all the groups together.
+ * Above 100 percent (or the rate monotonic bound for the number of groups) some
+ * group is going to overrun.
+ * @return the total utilization (in percent)
+ */
+unsigned int FIRSTExecutive::GetTotalUtilization()
+{
+	unsigned int total = 0;
+	for (int i = 0; i < m_groupCount; i++)
+		total += m_groups[i].utilization;
+	return total;
+}
@@ -0,0 +1,68 @@
+/*
+ * FIRSTExecutive.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef FIRSTEXECUTIVE_H_
+#define FIRSTEXECUTIVE_H_
+
+#include <Arduino.h>
+
+class FIRSTScheduler;
+
+/**
+ * Runs several {@link Scheduler Schedulers}, each at its own rate.
+ *
+ * Every scheduler is a rate group: its subsystems are created with it and its commands
+ * are bound to it. The groups are kept in rate monotonic order, the shortest period
+ * first. Every time a group pass finishes the executive looks for due groups from the
+ * top again, so a high rate group waits at most for one pass of a slower group.
+ *
+ * Run() never blocks, call it from loop() as often as possible. The groups are timed with
+ * the clock of one scheduler (see {@link Scheduler#Micros()}), the default one unless
+ * given another. Utilization is measured in real time, as the passes are (see
+ * {@link Scheduler#GetLastRunTime()}).
+ */
+class FIRSTExecutive
+{
+public:
+	static const int kMaxGroups = 4;
+	// Utilization is averaged over windows of this length (in real microseconds)
+	static const unsigned long kUtilizationWindow = 1000000UL;
+
+	FIRSTExecutive(FIRSTScheduler *clock = NULL);
+	virtual ~FIRSTExecutive();
+
+	bool AddGroup(FIRSTScheduler *scheduler, unsigned long period, unsigned long phase = 0);
+	void Run();
+
+	unsigned int GetUtilization(FIRSTScheduler *scheduler);
+	unsigned int GetOverruns(FIRSTScheduler *scheduler);
+	unsigned int GetTotalUtilization();
+
+private:
+	typedef struct sGroup {
+		FIRSTScheduler *scheduler;
+		unsigned long period;
+		unsigned long phase;
+		unsigned long next;
+		unsigned long busy;
+		unsigned int overruns;
+		unsigned int utilization;
+	} Group;
+
+	Group *FindGroup(FIRSTScheduler *scheduler);
+	void RunGroup(Group *group);
+	void UpdateUtilization();
+
+	FIRSTScheduler *m_clock;
+	Group m_groups[kMaxGroups];
+	int m_groupCount;
+	bool m_started;
+	unsigned long m_windowStart;
+};
+
+
+#endif /* FIRSTEXECUTIVE_H_ */
@@ -0,0 +1,168 @@
+/*
+ * FIRSTFilter.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include "FIRSTFilter.h"
+#include "FIRSTSubsystem.h"
+
+/**
+ * Creates an exponential filter.
+ * @param alpha the fraction of the difference a sample moves the value by, Q16.16
+ * between 0 (never moves) and FIRSTFixed::kOne (no smoothing)
+ */
+FIRSTExponentialFilter::FIRSTExponentialFilter(int32_t alpha)
+	: m_alpha(FIRSTFixed::Clamp(alpha, 0, FIRSTFixed::kOne))
+	, m_value(0)
+{
+}
+
+int32_t FIRSTExponentialFilter::Filter(int32_t sample, int32_t)
+{
+	int32_t difference = FIRSTFixed::Saturate((int64_t)sample - m_value);
+	m_value += FIRSTFixed::Mul(difference, m_alpha);
+	return m_value;
+}
+
+void FIRSTExponentialFilter::Reset(int32_t value)
+{
+	m_value = value;
+}
+
+/**
+ * Creates a debounce filter.
+ * @param samples how many samples in a row a new value must last to be let through
+ */
+FIRSTDebounceFilter::FIRSTDebounceFilter(uint8_t samples)
+	: m_samples(samples == 0 ? 1 : samples)
+	, m_stable(0)
+	, m_candidate(0)
+	, m_value(0)
+{
+}
+
+int32_t FIRSTDebounceFilter::Filter(int32_t sample, int32_t)
+{
+	if (sample == m_value)
+	{
+		m_stable = 0;
+		return m_value;
+	}
+	if (sample != m_candidate || m_stable == 0)
+	{
+		m_candidate = sample;
+		m_stable = 0;
+	}
+	if (++m_stable >= m_samples)
+	{
+		m_value = sample;
+		m_stable = 0;
+	}
+	return m_value;
+}
+
+void FIRSTDebounceFilter::Reset(int32_t value)
+{
+	m_value = value;
+	m_candidate = value;
+	m_stable = 0;
+}
+
+FIRSTDerivativeFilter::FIRSTDerivativeFilter()
+	: m_previous(0)
+	, m_rate(0)
+{
+}
+
+int32_t FIRSTDerivativeFilter::Filter(int32_t sample, int32_t dt)
+{
+	// Two samples at the same time tell nothing new about the rate
+	if (dt > 0)
+		m_rate = FIRSTFixed::Div(FIRSTFixed::Saturate((int64_t)sample - m_previous), dt);
+	m_previous = sample;
+	return m_rate;
+}
+
+void FIRSTDerivativeFilter::Reset(int32_t value)
+{
+	m_previous = value;
+	m_rate = 0;
+}
+
+/**
+ * Creates a channel.
+ * @param subsystem the subsystem to update the channel with, or NULL to call Update()
+ * by hand
+ */
+FIRSTFilterChannel::FIRSTFilterChannel(FIRSTSubsystem *subsystem)
+	: m_stageCount(0)
+	, m_hasSample(false)
+	, m_sample(0)
+	, m_value(0)
+	, m_elapsed(0)
+{
+	if (subsystem != NULL)
+		subsystem->AddFilter(this);
+}
+
+/**
+ * Appends a filter to the chain. A filter must be in one channel only.
+ * @param filter the filter
+ * @return false if the filter is NULL or the chain is full
+ */
+bool FIRSTFilterChannel::Add(FIRSTFilter *filter)
+{
+	if (filter == NULL || m_stageCount >= kMaxStages)
+		return false;
+	m_stages[m_stageCount++] = filter;
+	return true;
+}
+
+/**
+ * Puts in the sample of this pass, filtered once the Periodic() of the subsystem returns.
+ * @param sample the sample
+ */
+void FIRSTFilterChannel::Put(int32_t sample)
+{
+	m_sample = sample;
+	m_hasSample = true;
+}
+
+/**
+ * Returns the filtered value.
+ * @return the output of the last filter of the chain
+ */
+int32_t FIRSTFilterChannel::Get()
+{
+	return m_value;
+}
+
+/**
+ * Resets every filter of the chain to the given value.
+ * @param value the value
+ */
+void FIRSTFilterChannel::Reset(int32_t value)
+{
+	for (uint8_t i = 0; i < m_stageCount; i++)
+		m_stages[i]->Reset(value);
+	m_value = value;
+	m_hasSample = false;
+	m_elapsed = 0;
+}
+
+void FIRSTFilterChannel::Update(int32_t dt)
+{
+	// The passes without a sample add up to the time between two samples
+	m_elapsed = FIRSTFixed::Saturate((int64_t)m_elapsed + dt);
+	if (!m_hasSample)
+		return;
+	m_hasSample = false;
+
+	int32_t value = m_sample;
+	for (uint8_t i = 0; i < m_stageCount; i++)
+		value = m_stages[i]->Filter(value, m_elapsed);
+	m_value = value;
+	m_elapsed = 0;
+}
@@ -0,0 +1,307 @@
+/*
+ * FIRSTFilter.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef FIRSTFILTER_H_
+#define FIRSTFILTER_H_
+
+#include <Arduino.h>
+
+#include "FIRSTFixed.h"
+
+class FIRSTSubsystem;
+
+/**
+ * A filter of a stream of integer samples: raw readings, or Q16.16 fixed point (see
+ * {@link Fixed}) values. Filters keep their history in members sized at compile time
+ * and never allocate. They are chained in a {@link FilterChannel}.
+ */
+class FIRSTFilter
+{
+public:
+	virtual ~FIRSTFilter() {}
+
+	/**
+	 * Takes the next sample.
+	 * @param sample the sample
+	 * @param dt the time since the previous sample (in seconds, Q16.16)
+	 * @return the filtered value
+	 */
+	virtual int32_t Filter(int32_t sample, int32_t dt) = 0;
+
+	/**
+	 * Forgets the history, as if every sample so far had been the given value.
+	 * @param value the value
+	 */
+	virtual void Reset(int32_t value) = 0;
+};
+
+/**
+ * The average of the last N samples. The sum of N samples must fit in 32 bits.
+ */
+template<uint8_t N> class FIRSTMovingAverage : public FIRSTFilter
+{
+	static_assert(N > 0, "The window can not be empty");
+public:
+	FIRSTMovingAverage() { Reset(0); };
+
+	virtual int32_t Filter(int32_t sample, int32_t) {
+		m_sum += sample - m_samples[m_index];
+		m_samples[m_index] = sample;
+		if (++m_index >= N)
+			m_index = 0;
+		return m_sum / N;
+	};
+
+	virtual void Reset(int32_t value) {
+		for (uint8_t i = 0; i < N; i++)
+			m_samples[i] = value;
+		m_sum = value * N;
+		m_index = 0;
+	};
+
+private:
+	int32_t m_samples[N];
+	int32_t m_sum;
+	uint8_t m_index;
+};
+
+/**
+ * The median of the last N samples, which unlike an average ignores a few wild readings
+ * altogether. Every sample sorts a copy of the window, so N should stay small.
+ */
+template<uint8_t N> class FIRSTMedianFilter : public FIRSTFilter
+{
+	static_assert(N > 0 && N <= 15, "The window must hold 1 to 15 samples");
+public:
+	FIRSTMedianFilter() { Reset(0); };
+
+	virtual int32_t Filter(int32_t sample, int32_t) {
+		m_samples[m_index] = sample;
+		if (++m_index >= N)
+			m_index = 0;
+
+		int32_t sorted[N];
+		for (uint8_t i = 0; i < N; i++) {
+			int32_t value = m_samples[i];
+			uint8_t j = i;
+			for (; j > 0 && sorted[j - 1] > value; j--)
+				sorted[j] = sorted[j - 1];
+			sorted[j] = value;
+		}
+		return sorted[N / 2];
+	};
+
+	virtual void Reset(int32_t value) {
+		for (uint8_t i = 0; i < N; i++)
+			m_samples[i] = value;
+		m_index = 0;
+	};
+
+private:
+	int32_t m_samples[N];
+	uint8_t m_index;
+};
+
+/**
+ * Exponential smoothing, a first order low-pass: every sample moves the value by a
+ * fraction of the difference.
+ */
+class FIRSTExponentialFilter : public FIRSTFilter
+{
+public:
+	FIRSTExponentialFilter(int32_t alpha);
+	virtual int32_t Filter(int32_t sample, int32_t dt);
+	virtual void Reset(int32_t value);
+
+private:
+	int32_t m_alpha;
+	int32_t m_value;
+};
+
+/**
+ * Lets a change through only once it has lasted for a number of samples, for switches
+ * and other readings that bounce.
+ */
+class FIRSTDebounceFilter : public FIRSTFilter
+{
+public:
+	FIRSTDebounceFilter(uint8_t samples);
+	virtual int32_t Filter(int32_t sample, int32_t dt);
+	virtual void Reset(int32_t value);
+
+private:
+	uint8_t m_samples;
+	uint8_t m_stable;
+	int32_t m_candidate;
+	int32_t m_value;
+};
+
+/**
+ * The rate of change of the samples, in their units per second.
+ */
+class FIRSTDerivativeFilter : public FIRSTFilter
+{
+public:
+	FIRSTDerivativeFilter();
+	virtual int32_t Filter(int32_t sample, int32_t dt);
+	virtual void Reset(int32_t value);
+
+private:
+	int32_t m_previous;
+	int32_t m_rate;
+};
+
+/**
+ * Values filtered once per pass of the {@link Scheduler}, right after the Periodic() of
+ * the subsystem they were added to (see {@link Subsystem#AddFilter()}).
+ */
+class FIRSTFilterInput
+{
+	friend class FIRSTSubsystem;
+public:
+	FIRSTFilterInput() : m_nextInput(NULL) {};
+	virtual ~FIRSTFilterInput() {}
+
+	/**
+	 * Filters the samples put in during the pass.
+	 * @param dt the time since the previous pass (in seconds, Q16.16)
+	 */
+	virtual void Update(int32_t dt) = 0;
+
+private:
+	FIRSTFilterInput *m_nextInput;
+};
+
+/**
+ * One reading going through a chain of filters:
+ *
+ *   FIRSTMedianFilter<5> median;
+ *   FIRSTMovingAverage<8> average;
+ *   FIRSTFilterChannel range(this);     // in the constructor of the subsystem
+ *   range.Add(&median);
+ *   range.Add(&average);
+ *   ...
+ *   range.Put(analogRead(A0));          // in its Periodic()
+ *
+ * Commands then read range.Get(). A pass without a new sample leaves the value as it is,
+ * and the filters are given the time since the last sample, not since the last pass.
+ */
+class FIRSTFilterChannel : public FIRSTFilterInput
+{
+public:
+	static const uint8_t kMaxStages = 4;
+
+	FIRSTFilterChannel(FIRSTSubsystem *subsystem = NULL);
+
+	bool Add(FIRSTFilter *filter);
+	void Put(int32_t sample);
+	int32_t Get();
+	void Reset(int32_t value);
+
+	virtual void Update(int32_t dt);
+
+private:
+	FIRSTFilter *m_stages[kMaxStages];
+	uint8_t m_stageCount;
+	bool m_hasSample;
+	int32_t m_sample;
+	int32_t m_value;
+	int32_t m_elapsed;
+};
+
+/**
+ * The moving average of the last N samples of C channels at once, for arrays of sensors
+ * sampled together. The channels are laid out side by side, so the kernel is one loop
+ * over the channels that the host compiler vectorizes. N must be a power of two, the
+ * average being a shift, and the sum of N samples must fit in 32 bits: this is meant for
+ * raw readings.
+ */
+template<uint8_t C, uint8_t N> class FIRSTAverageBank : public FIRSTFilterInput
+{
+	static_assert(C > 0, "The bank needs a channel");
+	static_assert(N > 0 && (N & (N - 1)) == 0, "The window must be a power of 2");
+public:
+	FIRSTAverageBank() : m_index(0) {
+		for (m_shift = 0; (1 << m_shift) < N; m_shift++)
+			;
+		Reset(0);
+	};
+
+	void Put(uint8_t channel, int32_t sample) { m_input[channel] = sample; };
+	int32_t Get(uint8_t channel) { return m_output[channel]; };
+	int32_t *GetInputs() { return m_input; };
+	const int32_t *GetOutputs() { return m_output; };
+
+	void Reset(int32_t value) {
+		for (uint8_t c = 0; c < C; c++) {
+			for (uint8_t i = 0; i < N; i++)
+				m_samples[i][c] = value;
+			m_input[c] = value;
+			m_sum[c] = value * N;
+			m_output[c] = value;
+		}
+	};
+
+	virtual void Update(int32_t) {
+		for (uint8_t c = 0; c < C; c++) {
+			m_sum[c] += m_input[c] - m_samples[m_index][c];
+			m_samples[m_index][c] = m_input[c];
+			m_output[c] = m_sum[c] >> m_shift;
+		}
+		if (++m_index >= N)
+			m_index = 0;
+	};
+
+private:
+	int32_t m_samples[N][C];
+	int32_t m_sum[C];
+	int32_t m_input[C];
+	int32_t m_output[C];
+	uint8_t m_index;
+	uint8_t m_shift;
+};
+
+/**
+ * Exponential smoothing of C channels at once, each sample moving the value by
+ * 1 / 2^shift of the difference. The channels are kept scaled up by 2^shift, so the value
+ * settles on the input exactly, and the input scaled up must fit in 32 bits.
+ */
+template<uint8_t C> class FIRSTSmoothingBank : public FIRSTFilterInput
+{
+	static_assert(C > 0, "The bank needs a channel");
+public:
+	FIRSTSmoothingBank(uint8_t shift) : m_shift(shift) { Reset(0); };
+
+	void Put(uint8_t channel, int32_t sample) { m_input[channel] = sample; };
+	int32_t Get(uint8_t channel) { return m_output[channel]; };
+	int32_t *GetInputs() { return m_input; };
+	const int32_t *GetOutputs() { return m_output; };
+
+	void Reset(int32_t value) {
+		for (uint8_t c = 0; c < C; c++) {
+			m_input[c] = value;
+			m_state[c] = value * ((int32_t)1 << m_shift);
+			m_output[c] = value;
+		}
+	};
+
+	virtual void Update(int32_t) {
+		for (uint8_t c = 0; c < C; c++) {
+			m_state[c] += m_input[c] - (m_state[c] >> m_shift);
+			m_output[c] = m_state[c] >> m_shift;
+		}
+	};
+
+private:
+	int32_t m_state[C];
+	int32_t m_input[C];
+	int32_t m_output[C];
+	uint8_t m_shift;
+};
+
+
+#endif /* FIRSTFILTER_H_ */
@@ -0,0 +1,100 @@
+/*
+ * FIRSTFixed.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef FIRSTFIXED_H_
+#define FIRSTFIXED_H_
+
+#include <Arduino.h>
+
+/**
+ * Q16.16 fixed point numbers: 16 bits of integer part and 16 bits of fraction in an
+ * int32_t, covering +/-32767 with a resolution of 1/65536.
+ * Additions and subtractions are plain integer ones; use Mul() and Div() for the rest.
+ *
+ * Div() takes a 64 bit division, a slow library call on the AVR. Code that divides on
+ * every pass divides by a time step with DivStep(), or by a constant through its
+ * Reciprocal, computed once.
+ */
+class FIRSTFixed
+{
+public:
+	typedef struct sReciprocal {
+		int32_t multiplier;
+		uint8_t shift;
+	} Reciprocal;
+
+	static const int32_t kOne = 65536L;
+	static const int32_t kMax = 0x7FFFFFFFL;
+	static const int32_t kMin = -0x7FFFFFFFL - 1;
+
+	static int32_t FromInt(int value) { return (int32_t)value << 16; };
+	// Meant for constants, it is as slow as any floating point math at run time
+	static int32_t FromDouble(double value) { return (int32_t)(value * kOne + (value < 0 ? -0.5 : 0.5)); };
+	static int ToInt(int32_t value) { return (value + (kOne >> 1)) >> 16; };
+	static double ToDouble(int32_t value) { return (double)value / kOne; };
+
+	static int32_t Mul(int32_t a, int32_t b) { return Saturate(((int64_t)a * b) >> 16); };
+	static int32_t Div(int32_t a, int32_t b) {
+		if (b == 0)
+			return a < 0 ? kMin : kMax;
+		// Multiplied, shifting a negative value to the left is undefined
+		return Saturate((int64_t)a * kOne / b);
+	};
+
+	/**
+	 * Divides by a time step as given by FromMicros(), or by anything up to 0.5, with
+	 * 32 bit divisions only: the integer part of the quotient, then the fraction.
+	 */
+	static int32_t DivStep(int32_t a, int32_t step) {
+		if (step <= 0 || step > kOne / 2)
+			return Div(a, step);
+		int32_t quotient = a / step;
+		if (quotient >= 32768L || quotient <= -32768L)
+			return a < 0 ? kMin : kMax;
+		return quotient * kOne + (a % step) * kOne / step;
+	};
+
+	/**
+	 * Prepares the division by a constant, to be done with DivBy(): 2^n / divisor with
+	 * n picked to keep 30 bits of the inverse.
+	 * @param divisor the divisor, above 0
+	 */
+	static Reciprocal Invert(int32_t divisor) {
+		Reciprocal reciprocal;
+		uint8_t bits = 0;
+		for (uint32_t d = divisor; d != 0; d >>= 1)
+			bits++;
+		reciprocal.multiplier = divisor <= 0 ? kMax : (int32_t)(((uint64_t)1 << (29 + bits)) / divisor);
+		reciprocal.shift = 29 + bits - 16;
+		return reciprocal;
+	};
+	static int32_t DivBy(int32_t a, const Reciprocal &reciprocal) {
+		return Saturate(((int64_t)a * reciprocal.multiplier) >> reciprocal.shift);
+	};
+	static int32_t Abs(int32_t value) { return value < 0 ? -value : value; };
+	static int32_t Clamp(int32_t value, int32_t low, int32_t high) {
+		return value < low ? low : (value > high ? high : value);
+	};
+
+	/**
+	 * Converts a time step from microseconds, as given by the scheduler, to seconds.
+	 * Steps are cut to half a second, which also keeps the math in 32 bits.
+	 */
+	static int32_t FromMicros(unsigned long micros) {
+		if (micros > 500000UL)
+			micros = 500000UL;
+		// 65536 / 1000000 is 4295 / 65536 within 0.001 percent
+		return (int32_t)((micros * 4295UL) >> 16);
+	};
+
+	static int32_t Saturate(int64_t value) {
+		return value > kMax ? kMax : (value < kMin ? kMin : (int32_t)value);
+	};
+};
+
+
+#endif /* FIRSTFIXED_H_ */
@@ -0,0 +1,189 @@
+/*
+ * FIRSTLEDAnimations.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include "FIRSTLEDAnimations.h"
+#include "FIRSTScheduler.h"
+
+// A quarter of a sine wave, 127 * sin(PI/2 * i/64)
+static const uint8_t kQuarterSine[65] PROGMEM = {
+	0, 3, 6, 9, 12, 16, 19, 22, 25, 28, 31, 34, 37,
+	40, 43, 46, 49, 51, 54, 57, 60, 63, 65, 68, 71, 73,
+	76, 78, 81, 83, 85, 88, 90, 92, 94, 96, 98, 100, 102,
+	104, 106, 107, 109, 111, 112, 113, 115, 116, 117, 118, 120, 121,
+	122, 122, 123, 124, 125, 125, 126, 126, 126, 127, 127, 127, 127,
+};
+
+/**
+ * Creates an animation.
+ * @param strip the strip (or segment) to animate
+ * @param timeout the time (in seconds) before the animation ends, or negative for never
+ */
+FIRSTLEDAnimation::FIRSTLEDAnimation(FIRSTLEDStrip *strip, double timeout)
+	: FIRSTCommand(timeout)
+	, m_strip(strip)
+	, m_start(0)
+{
+	strip->AddRequirementsTo(this);
+}
+
+/**
+ * A sine wave from the table in flash.
+ * @param phase the phase, 256 being a full turn
+ * @return 128 + 127 * sin(2 * PI * phase / 256)
+ */
+uint8_t FIRSTLEDAnimation::Wave(uint8_t phase)
+{
+	uint8_t index = phase & 0x3F;
+	uint8_t value;
+	switch (phase >> 6)
+	{
+	case 0: value = pgm_read_byte(&kQuarterSine[index]); return 128 + value;
+	case 1: value = pgm_read_byte(&kQuarterSine[64 - index]); return 128 + value;
+	case 2: value = pgm_read_byte(&kQuarterSine[index]); return 128 - value;
+	default: value = pgm_read_byte(&kQuarterSine[64 - index]); return 128 - value;
+	}
+}
+
+/**
+ * Blends two colors.
+ * @param from the first color
+ * @param to the second color
+ * @param amount how much of the second color, from 0 to 256
+ * @return the blended color
+ */
+uint32_t FIRSTLEDAnimation::Blend(uint32_t from, uint32_t to, uint16_t amount)
+{
+	uint32_t result = 0;
+	for (uint8_t shift = 0; shift < 24; shift += 8)
+	{
+		int16_t a = (from >> shift) & 0xFF;
+		int16_t b = (to >> shift) & 0xFF;
+		uint8_t c = a + (((int32_t)(b - a) * amount) >> 8);
+		result |= (uint32_t)c << shift;
+	}
+	return result;
+}
+
+void FIRSTLEDAnimation::Initialize()
+{
+	m_start = GetScheduler()->Millis();
+}
+
+void FIRSTLEDAnimation::Execute()
+{
+	Render(GetScheduler()->Millis() - m_start);
+}
+
+bool FIRSTLEDAnimation::IsFinished()
+{
+	return IsTimedOut();
+}
+
+void FIRSTLEDAnimation::End()
+{
+}
+
+void FIRSTLEDAnimation::Interrupted()
+{
+	End();
+}
+
+/**
+ * Creates a fade.
+ * @param strip the strip (or segment) to fade
+ * @param from the starting color
+ * @param to the final color
+ * @param duration how long the fade lasts (in milliseconds)
+ */
+FIRSTLEDFade::FIRSTLEDFade(FIRSTLEDStrip *strip, uint32_t from, uint32_t to, unsigned long duration)
+	: FIRSTLEDAnimation(strip)
+	, m_from(from)
+	, m_to(to)
+	, m_duration(duration)
+	, m_done(false)
+{
+}
+
+void FIRSTLEDFade::Render(unsigned long elapsed)
+{
+	uint16_t amount = 256;
+	if (elapsed < m_duration)
+		amount = (elapsed << 8) / m_duration;
+	m_done = amount == 256;
+	m_strip->Fill(Blend(m_from, m_to, amount));
+}
+
+bool FIRSTLEDFade::IsFinished()
+{
+	return m_done;
+}
+
+/**
+ * Creates a chase.
+ * @param strip the strip (or segment) to run the dot along
+ * @param color the color of the dot
+ * @param step how long the dot stays on a pixel (in milliseconds)
+ * @param tail the number of pixels behind the dot, each half as bright as the one before
+ * @param timeout the time (in seconds) before the animation ends, or negative for never
+ */
+FIRSTLEDChase::FIRSTLEDChase(FIRSTLEDStrip *strip, uint32_t color, unsigned long step, uint8_t tail, double timeout)
+	: FIRSTLEDAnimation(strip, timeout)
+	, m_color(color)
+	, m_step(step == 0 ? 1 : step)
+	, m_tail(tail)
+	, m_lastStep(0)
+{
+}
+
+void FIRSTLEDChase::Initialize()
+{
+	FIRSTLEDAnimation::Initialize();
+	m_lastStep = (unsigned long)(-1);
+}
+
+void FIRSTLEDChase::Render(unsigned long elapsed)
+{
+	uint16_t length = m_strip->GetLength();
+	unsigned long step = elapsed / m_step;
+	if (length == 0 || step == m_lastStep)
+		return;
+	m_lastStep = step;
+
+	// Only the pixels that really change get marked dirty
+	uint16_t head = step % length;
+	for (uint16_t i = 0; i < length; i++)
+	{
+		uint16_t behind = (head + length - i) % length;
+		if (behind == 0)
+			m_strip->SetPixel(i, m_color);
+		else if (behind <= m_tail && behind < 8)
+			m_strip->SetPixel(i, FIRSTLEDStrip::Scale(m_color, 0xFF >> behind));
+		else
+			m_strip->SetPixel(i, 0);
+	}
+}
+
+/**
+ * Creates a pulse.
+ * @param strip the strip (or segment) to pulse
+ * @param color the color at the full brightness
+ * @param period the time between two peaks (in milliseconds)
+ * @param timeout the time (in seconds) before the animation ends, or negative for never
+ */
+FIRSTLEDPulse::FIRSTLEDPulse(FIRSTLEDStrip *strip, uint32_t color, unsigned long period, double timeout)
+	: FIRSTLEDAnimation(strip, timeout)
+	, m_color(color)
+	, m_period(period == 0 ? 1 : period)
+{
+}
+
+void FIRSTLEDPulse::Render(unsigned long elapsed)
+{
+	uint8_t phase = ((elapsed % m_period) << 8) / m_period;
+	// Shifted by a quarter turn to start at the bottom of the wave
+	m_strip->Fill(FIRSTLEDStrip::Scale(m_color, Wave(phase - 64)));
+}
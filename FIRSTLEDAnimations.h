@@ -0,0 +1,100 @@
+/*
+ * FIRSTLEDAnimations.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef FIRSTLEDANIMATIONS_H_
+#define FIRSTLEDANIMATIONS_H_
+
+#include <Arduino.h>
+
+#include "FIRSTCommand.h"
+#include "FIRSTLEDStrip.h"
+
+/**
+ * Base of the LED animations. Each animation requires a strip (or a segment) with its
+ * segments, and renders a frame on every pass from the milliseconds elapsed since it was
+ * initialized, on the clock of its scheduler.
+ * All the math is done in integers, the waveforms come from a table in flash.
+ */
+class FIRSTLEDAnimation : public FIRSTCommand
+{
+public:
+	FIRSTLEDAnimation(FIRSTLEDStrip *strip, double timeout = -1.0);
+
+	static uint8_t Wave(uint8_t phase);
+	static uint32_t Blend(uint32_t from, uint32_t to, uint16_t amount);
+
+protected:
+	virtual void Render(unsigned long elapsed) = 0;
+
+	virtual void Initialize();
+	virtual void Execute();
+	virtual bool IsFinished();
+	virtual void End();
+	virtual void Interrupted();
+
+	FIRSTLEDStrip *m_strip;
+
+private:
+	unsigned long m_start;
+};
+
+/**
+ * Fades the whole segment from one color to another.
+ */
+class FIRSTLEDFade : public FIRSTLEDAnimation
+{
+public:
+	FIRSTLEDFade(FIRSTLEDStrip *strip, uint32_t from, uint32_t to, unsigned long duration);
+
+protected:
+	virtual void Render(unsigned long elapsed);
+	virtual bool IsFinished();
+
+private:
+	uint32_t m_from;
+	uint32_t m_to;
+	unsigned long m_duration;
+	bool m_done;
+};
+
+/**
+ * Runs a dot with a fading tail along the segment, wrapping around at the end.
+ */
+class FIRSTLEDChase : public FIRSTLEDAnimation
+{
+public:
+	FIRSTLEDChase(FIRSTLEDStrip *strip, uint32_t color, unsigned long step, uint8_t tail = 3, double timeout = -1.0);
+
+protected:
+	virtual void Initialize();
+	virtual void Render(unsigned long elapsed);
+
+private:
+	uint32_t m_color;
+	unsigned long m_step;
+	uint8_t m_tail;
+	unsigned long m_lastStep;
+};
+
+/**
+ * Pulses the brightness of the whole segment along a sine wave, starting dark.
+ */
+class FIRSTLEDPulse : public FIRSTLEDAnimation
+{
+public:
+	FIRSTLEDPulse(FIRSTLEDStrip *strip, uint32_t color, unsigned long period, double timeout = -1.0);
+
+protected:
+	virtual void Render(unsigned long elapsed);
+
+private:
+	uint32_t m_color;
+	unsigned long m_period;
+};
+
+
+#endif /* FIRSTLEDANIMATIONS_H_ */
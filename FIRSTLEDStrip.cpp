@@ -0,0 +1,202 @@
+/*
+ * FIRSTLEDStrip.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include "FIRSTLEDStrip.h"
+#include "FIRSTCommand.h"
+#include "FIRSTEventLog.h"
+
+/**
+ * Creates a strip.
+ * @param name the name of the subsystem
+ * @param length the number of pixels
+ * @param scheduler the scheduler to register with, the default one if NULL
+ */
+FIRSTLEDStrip::FIRSTLEDStrip(const char *name, uint16_t length, FIRSTScheduler *scheduler)
+	: FIRSTSubsystem(name, scheduler)
+	, m_root(this)
+	, m_firstSegment(NULL)
+	, m_nextSegment(NULL)
+	, m_start(0)
+	, m_length(length)
+	, m_dirtyFirst(1)
+	, m_dirtyLast(0)
+{
+	m_front = new uint8_t[3 * length];
+	m_back = new uint8_t[3 * length];
+	memset(m_front, 0, 3 * length);
+	memset(m_back, 0, 3 * length);
+}
+
+/**
+ * Creates a segment of a strip.
+ * @param name the name of the subsystem
+ * @param parent the strip (or segment) this is a segment of
+ * @param start the first pixel of the segment in the parent
+ * @param length the number of pixels, cut to fit in the parent, or 0 if the segment would
+ * overlap another segment of the parent
+ */
+FIRSTLEDStrip::FIRSTLEDStrip(const char *name, FIRSTLEDStrip *parent, uint16_t start, uint16_t length)
+	: FIRSTSubsystem(name, parent->GetScheduler())
+	, m_root(parent->m_root)
+	, m_firstSegment(NULL)
+	, m_nextSegment(parent->m_firstSegment)
+	, m_start(parent->m_start + start)
+	, m_length(length)
+	, m_front(NULL)
+	, m_back(NULL)
+	, m_dirtyFirst(1)
+	, m_dirtyLast(0)
+{
+	if (start >= parent->m_length)
+		m_length = 0;
+	else if (length > parent->m_length - start)
+		m_length = parent->m_length - start;
+
+	// Two segments drawing the same pixels would be two owners of them
+	for (FIRSTLEDStrip *segment = m_nextSegment; segment != NULL; segment = segment->m_nextSegment)
+	{
+		if (m_length != 0 && segment->m_length != 0
+				&& m_start < segment->m_start + segment->m_length
+				&& segment->m_start < m_start + m_length)
+		{
+			FIRSTEventLog::Log(FIRSTEventLog::kSegmentOverlap, start);
+			m_length = 0;
+		}
+	}
+	parent->m_firstSegment = this;
+}
+
+FIRSTLEDStrip::~FIRSTLEDStrip()
+{
+	delete[] m_front;
+	delete[] m_back;
+}
+
+/**
+ * Scales the brightness of a color.
+ * @param color the color
+ * @param brightness the brightness, 255 leaves the color as it is
+ * @return the scaled color
+ */
+uint32_t FIRSTLEDStrip::Scale(uint32_t color, uint8_t brightness)
+{
+	uint16_t scale = brightness + 1;
+	uint8_t red = ((color >> 16) & 0xFF) * scale >> 8;
+	uint8_t green = ((color >> 8) & 0xFF) * scale >> 8;
+	uint8_t blue = (color & 0xFF) * scale >> 8;
+	return Color(red, green, blue);
+}
+
+uint16_t FIRSTLEDStrip::GetLength()
+{
+	return m_length;
+}
+
+/**
+ * Makes a command require this strip and all of its segments, so that it can draw on the
+ * whole of it. Call it instead of Requires(), in the constructor of the command.
+ * @param command the command drawing on the strip
+ */
+void FIRSTLEDStrip::AddRequirementsTo(FIRSTCommand *command)
+{
+	command->Requires(this);
+	for (FIRSTLEDStrip *segment = m_firstSegment; segment != NULL; segment = segment->m_nextSegment)
+		segment->AddRequirementsTo(command);
+}
+
+/**
+ * Sets the color of a pixel in the back buffer.
+ * @param index the pixel, relative to the start of the segment
+ * @param color the color, as returned by Color()
+ */
+void FIRSTLEDStrip::SetPixel(uint16_t index, uint32_t color)
+{
+	if (index >= m_length)
+		return;
+
+	index += m_start;
+	uint8_t *pixel = m_root->m_back + 3 * index;
+	uint8_t red = color >> 16;
+	uint8_t green = color >> 8;
+	uint8_t blue = color;
+	if (pixel[0] == red && pixel[1] == green && pixel[2] == blue)
+		return;
+
+	pixel[0] = red;
+	pixel[1] = green;
+	pixel[2] = blue;
+
+	if (m_root->m_dirtyFirst > m_root->m_dirtyLast)
+	{
+		m_root->m_dirtyFirst = index;
+		m_root->m_dirtyLast = index;
+	}
+	else if (index < m_root->m_dirtyFirst)
+		m_root->m_dirtyFirst = index;
+	else if (index > m_root->m_dirtyLast)
+		m_root->m_dirtyLast = index;
+}
+
+/**
+ * Returns the color of a pixel in the back buffer.
+ * @param index the pixel, relative to the start of the segment
+ * @return the color of the pixel
+ */
+uint32_t FIRSTLEDStrip::GetPixel(uint16_t index)
+{
+	if (index >= m_length)
+		return 0;
+
+	uint8_t *pixel = m_root->m_back + 3 * (m_start + index);
+	return Color(pixel[0], pixel[1], pixel[2]);
+}
+
+/**
+ * Sets all the pixels of the segment to the same color.
+ * @param color the color, as returned by Color()
+ */
+void FIRSTLEDStrip::Fill(uint32_t color)
+{
+	for (uint16_t i = 0; i < m_length; i++)
+		SetPixel(i, color);
+}
+
+/**
+ * Shows the pixels that changed during the pass. Segments leave that to the strip.
+ */
+void FIRSTLEDStrip::Flush()
+{
+	if (m_root != this || m_dirtyFirst > m_dirtyLast || IsBusy())
+		return;
+
+	uint16_t count = m_dirtyLast - m_dirtyFirst + 1;
+	memcpy(m_front + 3 * m_dirtyFirst, m_back + 3 * m_dirtyFirst, 3 * count);
+	Show(m_front, m_dirtyFirst, count);
+	m_dirtyFirst = 1;
+	m_dirtyLast = 0;
+}
+
+/**
+ * Returns whether the driver is still sending the front buffer.
+ * While busy the front buffer is left alone and the changes pile up in the back buffer.
+ * @return whether the driver is busy
+ */
+bool FIRSTLEDStrip::IsBusy()
+{
+	return false;
+}
+
+/**
+ * Sends pixels to the LEDs. Drivers that can only send the whole strip, like the
+ * WS2812 ones, send from the start of the buffer up to first + count.
+ * @param pixels the front buffer, 3 bytes (red, green, blue) per pixel
+ * @param first the first pixel that changed
+ * @param count how many pixels starting with the first may have changed
+ */
+void FIRSTLEDStrip::Show(const uint8_t *, uint16_t, uint16_t)
+{
+}
@@ -0,0 +1,66 @@
+/*
+ * FIRSTLEDStrip.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef FIRSTLEDSTRIP_H_
+#define FIRSTLEDSTRIP_H_
+
+#include <Arduino.h>
+
+#include "FIRSTSubsystem.h"
+
+/**
+ * A strip of addressable RGB LEDs, or a segment of one.
+ *
+ * Commands draw into a back buffer, 3 bytes per pixel. Only the pixels that actually
+ * change are marked dirty, and at the end of the pass the dirty range is copied to the
+ * front buffer and handed to Show(). The front buffer only changes between two calls to
+ * Show(), and not while IsBusy(), so a driver can keep sending it in the background.
+ *
+ * A segment is a separate subsystem drawing into a range of its parent strip, so that
+ * several effects can run on one strip at the same time, each requiring its own segment.
+ * The segments of a strip can not overlap. A command drawing on a strip requires its
+ * segments too (see AddRequirementsTo()), so it interrupts the effects running on them
+ * and the other way around; the segments must then be created before the command.
+ *
+ * Derive from this class to drive actual LEDs, overriding Show() and maybe IsBusy().
+ */
+class FIRSTLEDStrip : public FIRSTSubsystem
+{
+public:
+	FIRSTLEDStrip(const char *name, uint16_t length, FIRSTScheduler *scheduler = NULL);
+	FIRSTLEDStrip(const char *name, FIRSTLEDStrip *parent, uint16_t start, uint16_t length);
+	virtual ~FIRSTLEDStrip();
+
+	static uint32_t Color(uint8_t red, uint8_t green, uint8_t blue)
+		{ return ((uint32_t)red << 16) | ((uint32_t)green << 8) | blue; };
+	static uint32_t Scale(uint32_t color, uint8_t brightness);
+
+	uint16_t GetLength();
+	void AddRequirementsTo(FIRSTCommand *command);
+	void SetPixel(uint16_t index, uint32_t color);
+	uint32_t GetPixel(uint16_t index);
+	void Fill(uint32_t color);
+	virtual void Flush();
+
+protected:
+	virtual bool IsBusy();
+	virtual void Show(const uint8_t *pixels, uint16_t first, uint16_t count);
+
+private:
+	FIRSTLEDStrip *m_root;
+	FIRSTLEDStrip *m_firstSegment;
+	FIRSTLEDStrip *m_nextSegment;
+	uint16_t m_start;
+	uint16_t m_length;
+	uint8_t *m_front;
+	uint8_t *m_back;
+	uint16_t m_dirtyFirst;
+	uint16_t m_dirtyLast;
+};
+
+
+#endif /* FIRSTLEDSTRIP_H_ */
@@ -0,0 +1,178 @@
+/*
+ * FIRSTLatency.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include "FIRSTLatency.h"
+#include "FIRSTCommand.h"
+#include "FIRSTSubsystem.h"
+
+FIRSTLatency::FIRSTLatency()
+	: m_pathCount(0)
+	, m_dropped(0)
+{
+}
+
+FIRSTLatency::~FIRSTLatency()
+{
+}
+
+/**
+ * Records one latency sample. Paths are added as they show up; samples of paths beyond
+ * kMaxPaths are dropped.
+ * @param command the command that acted on the input
+ * @param subsystem the subsystem that put out the result
+ * @param latency the time from the input to the output (in microseconds)
+ */
+void FIRSTLatency::Record(FIRSTCommand *command, FIRSTSubsystem *subsystem, unsigned long latency)
+{
+	Path *path = NULL;
+	for (int i = 0; i < m_pathCount; i++)
+	{
+		if (m_paths[i].command == command && m_paths[i].subsystem == subsystem)
+		{
+			path = &m_paths[i];
+			break;
+		}
+	}
+	if (path == NULL)
+	{
+		if (m_pathCount >= kMaxPaths)
+		{
+			m_dropped++;
+			return;
+		}
+		path = &m_paths[m_pathCount++];
+		path->command = command;
+		path->subsystem = subsystem;
+		path->count = 0;
+		path->max = 0;
+		memset(path->buckets, 0, sizeof(path->buckets));
+	}
+
+	uint8_t bucket = Bucket(latency);
+	if (path->buckets[bucket] == 0xFFFF)
+	{
+		for (int i = 0; i < kBuckets; i++)
+			path->buckets[i] >>= 1;
+	}
+	path->buckets[bucket]++;
+	path->count++;
+	if (latency > path->max)
+		path->max = latency;
+}
+
+/**
+ * Returns the bucket of a latency. The latencies under kSubBuckets have a bucket each,
+ * every power of two above is split in kSubBuckets by the bits below its top one.
+ */
+uint8_t FIRSTLatency::Bucket(unsigned long latency)
+{
+	if (latency >= kRange)
+		return kBuckets - 1;
+	if (latency < kSubBuckets)
+		return latency;
+
+	// The top bit is at least bit 2, the two bits below it pick the sub-bucket
+	uint8_t top = 2;
+	while ((latency >> top) > 1)
+		top++;
+	return (top - 1) * kSubBuckets + ((latency >> (top - 2)) & (kSubBuckets - 1));
+}
+
+/**
+ * Returns the largest latency of a bucket.
+ */
+unsigned long FIRSTLatency::Top(uint8_t bucket)
+{
+	if (bucket < kSubBuckets)
+		return bucket;
+	if (bucket >= kBuckets - 1)
+		return (unsigned long)-1;
+
+	uint8_t top = bucket / kSubBuckets + 1;
+	unsigned long low = (unsigned long)(kSubBuckets + bucket % kSubBuckets) << (top - 2);
+	return low + (1UL << (top - 2)) - 1;
+}
+
+int FIRSTLatency::GetPathCount()
+{
+	return m_pathCount;
+}
+
+unsigned long FIRSTLatency::GetCount(int path)
+{
+	return path < m_pathCount ? m_paths[path].count : 0;
+}
+
+/**
+ * Returns a percentile of the latency of a path, rounded up to the top of its bucket
+ * and capped to the maximum. The buckets may have been halved, so the percentile is
+ * that of the recent samples rather than of all of them.
+ * @param path the path
+ * @param percent the percentile, 50 for the median
+ * @return the latency (in microseconds)
+ */
+unsigned long FIRSTLatency::GetPercentile(int path, uint8_t percent)
+{
+	if (path >= m_pathCount)
+		return 0;
+
+	Path *p = &m_paths[path];
+	unsigned long total = 0;
+	for (int i = 0; i < kBuckets; i++)
+		total += p->buckets[i];
+
+	unsigned long rank = (total * percent + 99) / 100;
+	unsigned long seen = 0;
+	for (int i = 0; i < kBuckets; i++)
+	{
+		seen += p->buckets[i];
+		if (seen >= rank && seen > 0)
+		{
+			unsigned long top = Top(i);
+			return top < p->max ? top : p->max;
+		}
+	}
+	return p->max;
+}
+
+unsigned long FIRSTLatency::GetMax(int path)
+{
+	return path < m_pathCount ? m_paths[path].max : 0;
+}
+
+/**
+ * Prints a line per path: command, subsystem, count, p50, p99 and max (in microseconds).
+ * @param out where to print to, &Serial for example
+ */
+void FIRSTLatency::Report(Print *out)
+{
+	for (int i = 0; i < m_pathCount; i++)
+	{
+		out->print(m_paths[i].command->GetCName());
+		out->print(" -> ");
+		out->print(m_paths[i].subsystem->GetCName());
+		out->print(": n=");
+		out->print(m_paths[i].count);
+		out->print(" p50=");
+		out->print(GetPercentile(i, 50));
+		out->print(" p99=");
+		out->print(GetPercentile(i, 99));
+		out->print(" max=");
+		out->println(m_paths[i].max);
+	}
+	if (m_dropped > 0)
+	{
+		out->print("dropped: ");
+		out->println(m_dropped);
+	}
+}
+
+void FIRSTLatency::Reset()
+{
+	m_pathCount = 0;
+	m_dropped = 0;
+}
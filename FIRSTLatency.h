@@ -0,0 +1,68 @@
+/*
+ * FIRSTLatency.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef FIRSTLATENCY_H_
+#define FIRSTLATENCY_H_
+
+#include <Arduino.h>
+
+class FIRSTCommand;
+class FIRSTSubsystem;
+
+/**
+ * Measures the latency from an input to the output it caused.
+ *
+ * A command that acts on an input tags itself with the time of the input, either the
+ * time a subsystem was sampled (see {@link Command#Consume()}) or any micros() timestamp
+ * such as that of a trigger edge (see {@link Command#SetCauseTime()}). A subsystem that
+ * puts out a new value tells so with {@link Subsystem#OutputChanged()}. When the outputs
+ * are committed at the end of the pass, the {@link Scheduler} records the time since
+ * the input for every subsystem of the command whose output changed, and clears the tag.
+ *
+ * Every input -> command -> subsystem path gets a histogram with four buckets per power
+ * of two microseconds, good for the percentiles within 25%, plus the exact maximum.
+ * Latencies from kRange microseconds up share the last bucket. When a bucket is full
+ * all of them are halved, so the older samples weigh less and the percentiles hold.
+ */
+class FIRSTLatency
+{
+public:
+	static const int kMaxPaths = 4;
+	static const int kSubBuckets = 4;
+	static const unsigned long kRange = 1UL << 18;
+	static const int kBuckets = 69;
+
+	FIRSTLatency();
+	virtual ~FIRSTLatency();
+
+	void Record(FIRSTCommand *command, FIRSTSubsystem *subsystem, unsigned long latency);
+	int GetPathCount();
+	unsigned long GetCount(int path);
+	unsigned long GetPercentile(int path, uint8_t percent);
+	unsigned long GetMax(int path);
+	void Report(Print *out);
+	void Reset();
+
+private:
+	static uint8_t Bucket(unsigned long latency);
+	static unsigned long Top(uint8_t bucket);
+
+	typedef struct sPath {
+		FIRSTCommand *command;
+		FIRSTSubsystem *subsystem;
+		unsigned long count;
+		unsigned long max;
+		uint16_t buckets[kBuckets];
+	} Path;
+
+	Path m_paths[kMaxPaths];
+	int m_pathCount;
+	unsigned long m_dropped;
+};
+
+
+#endif /* FIRSTLATENCY_H_ */
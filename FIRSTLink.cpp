@@ -0,0 +1,554 @@
+/*
+ * FIRSTLink.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include "FIRSTLink.h"
+#include "FIRSTScheduler.h"
+#include "FIRSTTelemetry.h"
+
+/**
+ * Drives an exported subsystem for the other board, for as long as the other board
+ * claims it.
+ */
+class FIRSTRemoteCommand : public FIRSTCommand
+{
+public:
+	FIRSTRemoteCommand(FIRSTSetpointSubsystem *subsystem)
+		: FIRSTCommand("Remote")
+		, m_subsystem(subsystem)
+		, m_hasOutput(false)
+		, m_output(0)
+	{
+		Requires(subsystem);
+	}
+
+	void SetOutput(int32_t output)
+	{
+		m_output = output;
+		m_hasOutput = true;
+	}
+
+protected:
+	virtual void Initialize()
+	{
+	}
+
+	virtual void Execute()
+	{
+		if (m_hasOutput)
+			m_subsystem->SetOutput(m_output);
+	}
+
+	virtual bool IsFinished()
+	{
+		return false;
+	}
+
+	virtual void End()
+	{
+		m_hasOutput = false;
+	}
+
+	virtual void Interrupted()
+	{
+		m_hasOutput = false;
+	}
+
+private:
+	FIRSTSetpointSubsystem *m_subsystem;
+	bool m_hasOutput;
+	int32_t m_output;
+};
+
+/**
+ * Creates a link.
+ * @param stream the port the other board is on
+ * @param scheduler the scheduler to register with, the default one if NULL
+ */
+FIRSTLink::FIRSTLink(Stream *stream, FIRSTScheduler *scheduler)
+	: FIRSTSubsystem("Link", scheduler)
+	, m_stream(stream)
+	, m_roomKnown(false)
+	, m_remoteCount(0)
+	, m_exportCount(0)
+	, m_rxLength(0)
+	, m_rxOverflow(false)
+	, m_frameLength(0)
+	, m_sequence(0)
+	, m_expected(0)
+	, m_received(false)
+	, m_echo(0)
+	, m_receivedAt(0)
+	, m_lastReceived(0)
+	, m_lastRefresh(0)
+	, m_framesSent(0)
+	, m_framesReceived(0)
+	, m_bytesSent(0)
+	, m_bytesReceived(0)
+	, m_dropped(0)
+	, m_lost(0)
+	, m_roundTrip(0)
+	, m_maxRoundTrip(0)
+{
+}
+
+FIRSTLink::~FIRSTLink()
+{
+}
+
+/**
+ * Makes a subsystem of this board available to the other board, under the given ID.
+ * @param id the ID the other board knows the subsystem by
+ * @param subsystem the subsystem, on the scheduler of the link
+ * @return false if the subsystem is NULL or there is no room left
+ */
+bool FIRSTLink::Export(uint8_t id, FIRSTSetpointSubsystem *subsystem)
+{
+	if (subsystem == NULL || m_exportCount >= kMaxExports)
+		return false;
+
+	Export_t *e = &m_exports[m_exportCount++];
+	e->id = id;
+	e->claimed = false;
+	e->measured = false;
+	e->measurement = 0;
+	e->pending = 0;
+	e->subsystem = subsystem;
+	e->command = new FIRSTRemoteCommand(subsystem);
+	e->command->SetScheduler(GetScheduler());
+	return true;
+}
+
+bool FIRSTLink::Add(FIRSTRemoteSubsystem *remote)
+{
+	if (m_remoteCount >= kMaxRemotes)
+		return false;
+	m_remotes[m_remoteCount++] = remote;
+	return true;
+}
+
+/**
+ * Returns whether a frame was received from the other board within kTimeout.
+ * @return whether the other board is there
+ */
+bool FIRSTLink::IsConnected()
+{
+	return m_received && GetScheduler()->Millis() - m_lastReceived <= kTimeout;
+}
+
+unsigned int FIRSTLink::GetFramesSent()
+{
+	return m_framesSent;
+}
+
+unsigned int FIRSTLink::GetFramesReceived()
+{
+	return m_framesReceived;
+}
+
+/**
+ * Returns how many bytes were written to the port, the encoding and delimiters included.
+ * @return the number of bytes sent
+ */
+unsigned long FIRSTLink::GetBytesSent()
+{
+	return m_bytesSent;
+}
+
+/**
+ * Returns how many bytes were read from the port, the encoding and delimiters included.
+ * @return the number of bytes received
+ */
+unsigned long FIRSTLink::GetBytesReceived()
+{
+	return m_bytesReceived;
+}
+
+/**
+ * Returns how many frames were held back because the port had no room for them.
+ * @return the number of dropped frames
+ */
+unsigned int FIRSTLink::GetDroppedFrames()
+{
+	return m_dropped;
+}
+
+/**
+ * Returns how many frames of the other board were missed or received corrupted.
+ * @return the number of lost frames
+ */
+unsigned int FIRSTLink::GetLostFrames()
+{
+	return m_lost;
+}
+
+/**
+ * Returns the last round trip to the other board and back (in microseconds).
+ * @return the round trip time
+ */
+unsigned long FIRSTLink::GetRoundTrip()
+{
+	return m_roundTrip;
+}
+
+/**
+ * Returns the longest round trip to the other board and back (in microseconds).
+ * @return the longest round trip time
+ */
+unsigned long FIRSTLink::GetMaxRoundTrip()
+{
+	return m_maxRoundTrip;
+}
+
+uint32_t FIRSTLink::GetLong(const uint8_t *data)
+{
+	return data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+/**
+ * Reads the bytes that arrived and handles the complete frames. Never waits for bytes.
+ * Called by the {@link Scheduler} at the start of every pass.
+ */
+void FIRSTLink::Periodic()
+{
+	Receive();
+
+	if (m_received && !IsConnected())
+		ReleaseAll();
+}
+
+void FIRSTLink::Receive()
+{
+	// Twice a frame worth of bytes per pass at most, to catch up without stretching it
+	for (int count = 0; count < 2 * (int)sizeof(m_rx) && m_stream->available() > 0; count++)
+	{
+		uint8_t c = m_stream->read();
+		m_bytesReceived++;
+		if (c == 0)
+		{
+			int length = m_rxOverflow ? -1 : FIRSTTelemetry::DecodeCOBS(m_rx, m_rxLength, m_rx);
+			if (length > 0)
+				Dispatch(m_rx, length);
+			else if (m_rxLength > 0 || m_rxOverflow)
+				m_lost++;
+			m_rxLength = 0;
+			m_rxOverflow = false;
+		}
+		else if (m_rxLength < (int)sizeof(m_rx))
+			m_rx[m_rxLength++] = c;
+		else
+			m_rxOverflow = true;
+	}
+}
+
+void FIRSTLink::Dispatch(const uint8_t *frame, int length)
+{
+	if (length < kHeaderSize)
+	{
+		m_lost++;
+		return;
+	}
+
+	FIRSTScheduler *scheduler = GetScheduler();
+	unsigned long now = scheduler->Micros();
+	uint8_t sequence = frame[0];
+	if (m_received)
+		m_lost += (uint8_t)(sequence - m_expected);
+	m_expected = sequence + 1;
+	m_received = true;
+	m_echo = GetLong(frame + 1);
+	m_receivedAt = now;
+	m_lastReceived = scheduler->Millis();
+	m_framesReceived++;
+
+	uint16_t hold = frame[9] | ((uint16_t)frame[10] << 8);
+	if (hold != 0xFFFF)
+	{
+		m_roundTrip = now - GetLong(frame + 5) - hold;
+		if (m_roundTrip > m_maxRoundTrip)
+			m_maxRoundTrip = m_roundTrip;
+	}
+
+	for (int i = kHeaderSize; i + 2 <= length; )
+	{
+		uint8_t type = frame[i++];
+		uint8_t id = frame[i++];
+		// Something newer than this board knows, the rest can not be parsed
+		if (type < kClaim || type > kMeasurement)
+			return;
+		int32_t value = 0;
+		if (type == kOutput || type == kMeasurement)
+		{
+			if (i + 4 > length)
+				return;
+			value = GetLong(frame + i);
+			i += 4;
+		}
+
+		if (type == kMeasurement)
+		{
+			for (uint8_t r = 0; r < m_remoteCount; r++)
+			{
+				if (m_remotes[r]->m_id == id)
+					m_remotes[r]->m_measurement = value;
+			}
+			continue;
+		}
+
+		Export_t *e = NULL;
+		for (uint8_t x = 0; x < m_exportCount; x++)
+		{
+			if (m_exports[x].id == id)
+				e = &m_exports[x];
+		}
+		if (e == NULL)
+			continue;
+
+		// Only the changes act, but a refresh drives again a subsystem whose command was
+		// interrupted by a command of this board
+		switch (type)
+		{
+		case kClaim:
+			if (!e->claimed || !e->command->IsRunning())
+			{
+				e->claimed = true;
+				e->command->Start();
+			}
+			break;
+
+		case kRelease:
+			if (e->claimed)
+			{
+				e->claimed = false;
+				e->command->Cancel();
+			}
+			break;
+
+		case kOutput:
+			e->command->SetOutput(value);
+			break;
+		}
+	}
+}
+
+void FIRSTLink::ReleaseAll()
+{
+	for (uint8_t x = 0; x < m_exportCount; x++)
+	{
+		if (m_exports[x].claimed)
+		{
+			m_exports[x].claimed = false;
+			m_exports[x].command->Cancel();
+		}
+	}
+}
+
+void FIRSTLink::PutByte(uint8_t value)
+{
+	if (m_frameLength < kMaxFrame)
+		m_frame[m_frameLength++] = value;
+}
+
+void FIRSTLink::PutLong(uint32_t value)
+{
+	for (uint8_t b = 0; b < 4; b++, value >>= 8)
+		PutByte(value);
+}
+
+/**
+ * Builds the frame of this pass.
+ * @param refresh whether to send the whole state rather than the changes
+ * @return whether there is something to send
+ */
+bool FIRSTLink::Build(bool refresh)
+{
+	FIRSTScheduler *scheduler = GetScheduler();
+	unsigned long now = scheduler->Micros();
+	unsigned long hold = now - m_receivedAt;
+
+	m_frameLength = 0;
+	PutByte(m_sequence);
+	PutLong(now);
+	PutLong(m_echo);
+	// An echo held too long to tell is not sent
+	if (!m_received || hold > 0xFFFE)
+		hold = 0xFFFF;
+	PutByte(hold);
+	PutByte(hold >> 8);
+
+	for (uint8_t r = 0; r < m_remoteCount; r++)
+	{
+		FIRSTRemoteSubsystem *remote = m_remotes[r];
+		bool claimed = remote->GetCurrentCommand() != NULL;
+		if (claimed != remote->m_claimed || refresh)
+		{
+			PutByte(claimed ? kClaim : kRelease);
+			PutByte(remote->m_id);
+		}
+		if (claimed && (remote->m_outputDirty || !remote->m_claimed || refresh))
+		{
+			PutByte(kOutput);
+			PutByte(remote->m_id);
+			PutLong(remote->m_output);
+		}
+	}
+
+	for (uint8_t x = 0; x < m_exportCount; x++)
+	{
+		Export_t *e = &m_exports[x];
+		e->pending = e->subsystem->GetMeasurement();
+		if (!e->measured || e->pending != e->measurement || refresh)
+		{
+			PutByte(kMeasurement);
+			PutByte(e->id);
+			PutLong(e->pending);
+		}
+	}
+
+	return refresh || m_frameLength > kHeaderSize;
+}
+
+/**
+ * Remembers what the frame just sent told the other board.
+ */
+void FIRSTLink::Commit()
+{
+	for (uint8_t r = 0; r < m_remoteCount; r++)
+	{
+		FIRSTRemoteSubsystem *remote = m_remotes[r];
+		remote->m_claimed = remote->GetCurrentCommand() != NULL;
+		if (remote->m_claimed)
+			remote->m_outputDirty = false;
+	}
+	for (uint8_t x = 0; x < m_exportCount; x++)
+	{
+		m_exports[x].measured = true;
+		m_exports[x].measurement = m_exports[x].pending;
+	}
+}
+
+/**
+ * Sends what changed during the pass in a single frame. Called by the {@link Scheduler}
+ * at the end of every pass.
+ */
+void FIRSTLink::Flush()
+{
+	unsigned long now = GetScheduler()->Millis();
+	bool refresh = now - m_lastRefresh >= kRefreshPeriod;
+	if (!Build(refresh))
+		return;
+
+	uint8_t encoded[kMaxFrame + kMaxFrame / 254 + 2];
+	int length = FIRSTTelemetry::EncodeCOBS(m_frame, m_frameLength, encoded) + 1;
+	int room = m_stream->availableForWrite();
+	if (room > 0)
+		m_roomKnown = true;
+	else if (!m_roomKnown)
+		room = length;
+	if (room < length)
+	{
+		// What the frame held is still to be sent
+		m_dropped++;
+		return;
+	}
+
+	m_stream->write(encoded, length);
+	m_bytesSent += length;
+	m_framesSent++;
+	m_sequence++;
+	Commit();
+	if (refresh)
+		m_lastRefresh = now;
+}
+
+/**
+ * Creates the stand-in of a subsystem of the other board.
+ * @param name the name of the subsystem
+ * @param link the link to the other board, the subsystem is on its scheduler
+ * @param id the ID the other board exported the subsystem under
+ */
+FIRSTRemoteSubsystem::FIRSTRemoteSubsystem(const char *name, FIRSTLink *link, uint8_t id)
+	: FIRSTSetpointSubsystem(name, link->GetScheduler())
+	, m_id(id)
+	, m_claimed(false)
+	, m_outputDirty(false)
+	, m_output(0)
+	, m_measurement(0)
+{
+	link->Add(this);
+}
+
+/**
+ * Returns the last measurement received from the other board.
+ * @return the measurement
+ */
+int32_t FIRSTRemoteSubsystem::GetMeasurement()
+{
+	return m_measurement;
+}
+
+/**
+ * Sets the output, sent to the other board at the end of the pass.
+ * @param output the output
+ */
+void FIRSTRemoteSubsystem::SetOutput(int32_t output)
+{
+	if (output != m_output)
+		m_outputDirty = true;
+	m_output = output;
+}
+
+FIRSTLoopbackStream::FIRSTLoopbackStream()
+	: m_peer(NULL)
+	, m_head(0)
+	, m_tail(0)
+{
+}
+
+/**
+ * Connects both ends of the line.
+ * @param peer the other end
+ */
+void FIRSTLoopbackStream::Connect(FIRSTLoopbackStream *peer)
+{
+	m_peer = peer;
+	peer->m_peer = this;
+}
+
+int FIRSTLoopbackStream::available()
+{
+	return (m_head - m_tail + kBufferSize) % kBufferSize;
+}
+
+int FIRSTLoopbackStream::read()
+{
+	if (m_head == m_tail)
+		return -1;
+	uint8_t value = m_buffer[m_tail];
+	m_tail = (m_tail + 1) % kBufferSize;
+	return value;
+}
+
+int FIRSTLoopbackStream::peek()
+{
+	return m_head == m_tail ? -1 : m_buffer[m_tail];
+}
+
+size_t FIRSTLoopbackStream::write(uint8_t value)
+{
+	if (availableForWrite() <= 0)
+		return 0;
+	m_peer->m_buffer[m_peer->m_head] = value;
+	m_peer->m_head = (m_peer->m_head + 1) % kBufferSize;
+	return 1;
+}
+
+int FIRSTLoopbackStream::availableForWrite()
+{
+	if (m_peer == NULL)
+		return 0;
+	return (m_peer->m_tail - m_peer->m_head - 1 + kBufferSize) % kBufferSize;
+}
@@ -0,0 +1,191 @@
+/*
+ * FIRSTLink.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef FIRSTLINK_H_
+#define FIRSTLINK_H_
+
+#include <Arduino.h>
+
+#include "FIRSTControl.h"
+
+class FIRSTRemoteSubsystem;
+class FIRSTRemoteCommand;
+
+/**
+ * A serial link to another board running its own {@link Scheduler}, so that commands
+ * on one board can require and drive subsystems living on the other.
+ *
+ * The board a subsystem lives on exports it under an ID with Export(). The other board
+ * creates a {@link RemoteSubsystem} with the same ID, and commands require it and call
+ * SetOutput() on it like on any {@link SetpointSubsystem}. When a command starts owning
+ * the proxy, the link claims the exported subsystem: a command of the link is started
+ * on the other board, requiring it and applying the outputs. When the proxy is released
+ * the command is canceled and the default command of the subsystem takes over again.
+ * The measurements of the exported subsystems come back the other way.
+ *
+ * All that changed during a pass is batched by Flush() into a single frame, COBS
+ * encoded and terminated by a zero byte like the {@link Telemetry} packets. Decoded:
+ * <pre>
+ *   sequence (1 byte)
+ *   stamp    (4 bytes, LE) the Micros() of the sender
+ *   echo     (4 bytes, LE) the stamp of the last frame received
+ *   hold     (2 bytes, LE) how long ago that frame was received, in microseconds,
+ *                          or 0xFFFF if none was
+ *   messages: kClaim id, kRelease id, kOutput id value (4 bytes, LE),
+ *             kMeasurement id value (4 bytes, LE)
+ * </pre>
+ * The round trip is the time from a stamp to its echo, less the hold time on the other
+ * board, so the two clocks need not agree.
+ *
+ * Only changes are sent, but every kRefreshPeriod the whole state is sent again, so that
+ * a frame lost on the wire is made up for, and a claimed subsystem whose command was
+ * interrupted on this board is driven again. A frame that does not fit in the TX buffer
+ * of the port is not sent and what it held stays to be sent on the next pass; a port
+ * that never tells its room (availableForWrite() always 0) is written regardless. When nothing
+ * was received for kTimeout, the claims of the other board are released.
+ */
+class FIRSTLink : public FIRSTSubsystem
+{
+	friend class FIRSTRemoteSubsystem;
+public:
+	enum {
+		kClaim = 1,
+		kRelease,
+		kOutput,
+		kMeasurement
+	};
+	static const uint8_t kMaxRemotes = 6;
+	static const uint8_t kMaxExports = 6;
+	static const int kHeaderSize = 11;
+	static const int kMaxFrame = 96;
+	static const unsigned long kRefreshPeriod = 100;
+	static const unsigned long kTimeout = 300;
+
+	FIRSTLink(Stream *stream, FIRSTScheduler *scheduler = NULL);
+	virtual ~FIRSTLink();
+
+	bool Export(uint8_t id, FIRSTSetpointSubsystem *subsystem);
+	bool IsConnected();
+	unsigned int GetFramesSent();
+	unsigned int GetFramesReceived();
+	unsigned long GetBytesSent();
+	unsigned long GetBytesReceived();
+	unsigned int GetDroppedFrames();
+	unsigned int GetLostFrames();
+	unsigned long GetRoundTrip();
+	unsigned long GetMaxRoundTrip();
+
+	virtual void Periodic();
+	virtual void Flush();
+
+private:
+	typedef struct sExport {
+		uint8_t id;
+		bool claimed;
+		bool measured;
+		int32_t measurement;
+		int32_t pending;
+		FIRSTSetpointSubsystem *subsystem;
+		FIRSTRemoteCommand *command;
+	} Export_t;
+
+	bool Add(FIRSTRemoteSubsystem *remote);
+	void Receive();
+	void Dispatch(const uint8_t *frame, int length);
+	void ReleaseAll();
+	bool Build(bool refresh);
+	void Commit();
+	void PutByte(uint8_t value);
+	void PutLong(uint32_t value);
+	static uint32_t GetLong(const uint8_t *data);
+
+	Stream *m_stream;
+	bool m_roomKnown;
+
+	FIRSTRemoteSubsystem *m_remotes[kMaxRemotes];
+	uint8_t m_remoteCount;
+	Export_t m_exports[kMaxExports];
+	uint8_t m_exportCount;
+
+	uint8_t m_rx[kMaxFrame + kMaxFrame / 254 + 2];
+	int m_rxLength;
+	bool m_rxOverflow;
+	uint8_t m_frame[kMaxFrame];
+	int m_frameLength;
+
+	uint8_t m_sequence;
+	uint8_t m_expected;
+	bool m_received;
+	unsigned long m_echo;
+	unsigned long m_receivedAt;
+	unsigned long m_lastReceived;
+	unsigned long m_lastRefresh;
+
+	unsigned int m_framesSent;
+	unsigned int m_framesReceived;
+	unsigned long m_bytesSent;
+	unsigned long m_bytesReceived;
+	unsigned int m_dropped;
+	unsigned int m_lost;
+	unsigned long m_roundTrip;
+	unsigned long m_maxRoundTrip;
+};
+
+/**
+ * Stands on one board for a subsystem exported by another board over a {@link Link}.
+ * Commands require it and drive it like a local subsystem; the outputs reach the other
+ * board with the next frame, the measurement is the last one received.
+ */
+class FIRSTRemoteSubsystem : public FIRSTSetpointSubsystem
+{
+	friend class FIRSTLink;
+public:
+	FIRSTRemoteSubsystem(const char *name, FIRSTLink *link, uint8_t id);
+
+	virtual int32_t GetMeasurement();
+	virtual void SetOutput(int32_t output);
+
+private:
+	uint8_t m_id;
+	bool m_claimed;
+	bool m_outputDirty;
+	int32_t m_output;
+	int32_t m_measurement;
+};
+
+/**
+ * One end of an in-memory serial line, a stand-in for a UART off the hardware. The
+ * bytes written to one end are read from the other one:
+ *
+ *   FIRSTLoopbackStream a, b;
+ *   a.Connect(&b);
+ *   FIRSTLink linkA(&a, &schedulerA), linkB(&b, &schedulerB);
+ */
+class FIRSTLoopbackStream : public Stream
+{
+public:
+	static const int kBufferSize = 128;
+
+	FIRSTLoopbackStream();
+	void Connect(FIRSTLoopbackStream *peer);
+
+	virtual int available();
+	virtual int read();
+	virtual int peek();
+	virtual size_t write(uint8_t value);
+	virtual int availableForWrite();
+	using Print::write;
+
+private:
+	FIRSTLoopbackStream *m_peer;
+	uint8_t m_buffer[kBufferSize];
+	uint8_t m_head;
+	uint8_t m_tail;
+};
+
+
+#endif /* FIRSTLINK_H_ */
@@ -0,0 +1,174 @@
+/*
+ * FIRSTOutputs.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include "FIRSTOutputs.h"
+#include "FIRSTScheduler.h"
+
+/**
+ * Finds the port of a pin and the bit of the pin in the port.
+ * @return false if the pin is not a digital pin
+ */
+static bool PinToPort(uint8_t pin, uint8_t *port, uint8_t *bit)
+{
+#if defined(__AVR__)
+	*port = digitalPinToPort(pin);
+	*bit = digitalPinToBitMask(pin);
+	return *port != NOT_A_PORT && *port < FIRSTOutputs::kMaxPorts;
+#else
+	*port = pin / 8 + 1;
+	*bit = 1 << (pin % 8);
+	return *port < FIRSTOutputs::kMaxPorts;
+#endif
+}
+
+FIRSTOutputs::FIRSTOutputs()
+	: m_pwmCount(0)
+	, m_pwmUnwritten(0)
+	, m_portWrites(0)
+{
+	for (int i = 0; i < kMaxPorts; i++)
+	{
+		m_mask[i] = 0;
+		m_staged[i] = 0;
+		m_committed[i] = 0;
+		m_unwritten[i] = 0;
+#if !defined(__AVR__)
+		m_simulated[i] = 0;
+#endif
+	}
+}
+
+FIRSTOutputs::~FIRSTOutputs()
+{
+}
+
+/**
+ * Returns the output stage of the default {@link Scheduler}, creating it if it does not
+ * exist.
+ * @return the output stage
+ */
+FIRSTOutputs *FIRSTOutputs::GetInstance()
+{
+	return FIRSTScheduler::GetInstance()->GetOutputs();
+}
+
+/**
+ * Stages the state of a digital output.
+ * @param pin the pin
+ * @param value HIGH or LOW
+ */
+void FIRSTOutputs::Stage(uint8_t pin, uint8_t value)
+{
+	uint8_t port, bit;
+	if (!PinToPort(pin, &port, &bit))
+		return;
+
+	if (!(m_mask[port] & bit))
+	{
+		// The state of the pin is unknown, make sure the next commit writes it whatever
+		// is staged by then
+		m_mask[port] |= bit;
+		m_unwritten[port] |= bit;
+	}
+
+	if (value == LOW)
+		m_staged[port] &= ~bit;
+	else
+		m_staged[port] |= bit;
+}
+
+/**
+ * Stages the duty cycle of a PWM output.
+ * @param pin the pin, it has to be PWM capable
+ * @param duty the duty cycle, as with analogWrite()
+ * @return false if there is no room for another PWM output
+ */
+bool FIRSTOutputs::StagePWM(uint8_t pin, uint8_t duty)
+{
+	for (int i = 0; i < m_pwmCount; i++)
+	{
+		if (m_pwmPins[i] == pin)
+		{
+			m_pwmStaged[i] = duty;
+			return true;
+		}
+	}
+
+	if (m_pwmCount >= kMaxPWM)
+		return false;
+
+	m_pwmPins[m_pwmCount] = pin;
+	m_pwmStaged[m_pwmCount] = duty;
+	m_pwmUnwritten |= 1 << m_pwmCount;
+	m_pwmCount++;
+	return true;
+}
+
+/**
+ * Writes every port and PWM output whose staged state differs from the committed one.
+ * Called by the {@link Scheduler} at the end of every pass.
+ */
+void FIRSTOutputs::Commit()
+{
+	for (uint8_t port = 0; port < kMaxPorts; port++)
+	{
+		uint8_t mask = m_mask[port];
+		uint8_t staged = m_staged[port];
+		if ((staged & mask) == (m_committed[port] & mask) && m_unwritten[port] == 0)
+			continue;
+
+#if defined(__AVR__)
+		volatile uint8_t *out = portOutputRegister(port);
+		uint8_t oldSREG = SREG;
+		cli();
+		*out = (*out & ~mask) | (staged & mask);
+		SREG = oldSREG;
+#else
+		m_simulated[port] = (m_simulated[port] & ~mask) | (staged & mask);
+#endif
+		m_committed[port] = staged;
+		m_unwritten[port] = 0;
+		m_portWrites++;
+	}
+
+	for (int i = 0; i < m_pwmCount; i++)
+	{
+		if (m_pwmStaged[i] != m_pwmCommitted[i] || (m_pwmUnwritten & (1 << i)))
+		{
+			analogWrite(m_pwmPins[i], m_pwmStaged[i]);
+			m_pwmCommitted[i] = m_pwmStaged[i];
+		}
+	}
+	m_pwmUnwritten = 0;
+}
+
+/**
+ * Returns the last committed value of a port.
+ * On the AVR this reads the output register, elsewhere the simulated one.
+ * @param port the port number, as returned by digitalPinToPort()
+ * @return the state of the port
+ */
+uint8_t FIRSTOutputs::GetPort(uint8_t port)
+{
+	if (port >= kMaxPorts)
+		return 0;
+#if defined(__AVR__)
+	return port == NOT_A_PORT ? 0 : *portOutputRegister(port);
+#else
+	return m_simulated[port];
+#endif
+}
+
+/**
+ * Returns how many port register writes were done, for comparing with the number of
+ * individual pin writes that were staged.
+ * @return the number of port writes
+ */
+unsigned long FIRSTOutputs::GetPortWrites()
+{
+	return m_portWrites;
+}
@@ -0,0 +1,69 @@
+/*
+ * FIRSTOutputs.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef FIRSTOUTPUTS_H_
+#define FIRSTOUTPUTS_H_
+
+#include <Arduino.h>
+
+class FIRSTScheduler;
+
+/**
+ * Output stage of the {@link Scheduler}.
+ *
+ * Instead of writing pins right away, subsystems stage the state they want their outputs
+ * to have. At the end of every pass the scheduler commits the staged states: every port
+ * that changed gets one read-modify-write of its output register, and a PWM output gets
+ * an analogWrite() only when its duty cycle changed. Pins of the same port change at the
+ * same instant, and a pin staged several times during a pass is written once.
+ *
+ * The pins must be set to OUTPUT with pinMode() beforehand. A pin should be staged either
+ * as digital or as PWM, not both. Off the AVR the port registers are simulated, one
+ * port per eight pins, and can be read back with GetPort().
+ *
+ * Every scheduler has an output stage of its own (see {@link Scheduler#GetOutputs()}),
+ * so that simulated schedulers do not share their pins.
+ */
+class FIRSTOutputs
+{
+	friend class FIRSTScheduler;
+public:
+	static const int kMaxPorts = 13;
+	static const int kMaxPWM = 8;
+
+	static FIRSTOutputs *GetInstance();
+
+	void Stage(uint8_t pin, uint8_t value);
+	bool StagePWM(uint8_t pin, uint8_t duty);
+	void Commit();
+
+	uint8_t GetPort(uint8_t port);
+	unsigned long GetPortWrites();
+
+private:
+	FIRSTOutputs();
+	virtual ~FIRSTOutputs();
+
+	uint8_t m_mask[kMaxPorts];
+	uint8_t m_staged[kMaxPorts];
+	uint8_t m_committed[kMaxPorts];
+	uint8_t m_unwritten[kMaxPorts];
+#if !defined(__AVR__)
+	uint8_t m_simulated[kMaxPorts];
+#endif
+
+	uint8_t m_pwmPins[kMaxPWM];
+	uint8_t m_pwmStaged[kMaxPWM];
+	uint8_t m_pwmCommitted[kMaxPWM];
+	uint8_t m_pwmCount;
+	uint8_t m_pwmUnwritten;
+
+	unsigned long m_portWrites;
+};
+
+
+#endif /* FIRSTOUTPUTS_H_ */
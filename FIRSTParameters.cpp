@@ -0,0 +1,398 @@
+/*
+ * FIRSTParameters.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include "FIRSTParameters.h"
+#include "FIRSTScheduler.h"
+#include "FIRSTConsole.h"
+#include "FIRSTEventLog.h"
+
+#if defined(__AVR__)
+#include <avr/eeprom.h>
+#else
+#include <stdio.h>
+
+static const int kImageSize = 4096;
+static uint8_t s_image[kImageSize];
+static FILE *s_file = NULL;
+#endif
+
+/**
+ * Creates the parameter store.
+ * @param address where the banks start in the EEPROM
+ * @param banks how many banks to write in turn, each kBankSize bytes
+ * @param scheduler the scheduler to register with, the default one if NULL
+ */
+FIRSTParameters::FIRSTParameters(int address, uint8_t banks, FIRSTScheduler *scheduler)
+	: FIRSTSubsystem("Parameters", scheduler)
+	, m_address(address)
+	, m_banks(banks == 0 ? 1 : banks)
+	, m_loaded(false)
+	, m_bank(-1)
+	, m_sequence(0)
+	, m_storedCount(0)
+	, m_count(0)
+	, m_dirty(false)
+	, m_writing(false)
+	, m_changedAt(0)
+	, m_writeStep(0)
+	, m_writeCount(0)
+	, m_writeCRC(0)
+	, m_bankWrites(0)
+{
+}
+
+FIRSTParameters::~FIRSTParameters()
+{
+}
+
+/**
+ * Backs the EEPROM image with a file, off the AVR. The file is loaded if it exists,
+ * and every byte written goes to it as well. Call it before declaring any parameter.
+ * @param path the file
+ */
+void FIRSTParameters::SetImageFile(const char *path)
+{
+#if !defined(__AVR__)
+	if (s_file != NULL)
+		fclose(s_file);
+	memset(s_image, 0xFF, sizeof(s_image));
+	s_file = fopen(path, "r+b");
+	if (s_file != NULL)
+	{
+		size_t length = fread(s_image, 1, sizeof(s_image), s_file);
+		(void)length;
+	}
+	else
+	{
+		s_file = fopen(path, "w+b");
+		if (s_file != NULL)
+			fwrite(s_image, 1, sizeof(s_image), s_file);
+	}
+#else
+	(void)path;
+#endif
+}
+
+uint8_t FIRSTParameters::ReadByte(int address)
+{
+#if defined(__AVR__)
+	return eeprom_read_byte((const uint8_t *)address);
+#else
+	return address >= 0 && address < kImageSize ? s_image[address] : 0xFF;
+#endif
+}
+
+// Little endian, as the records are written
+uint32_t FIRSTParameters::ReadWord(int address)
+{
+	uint32_t word = 0;
+	for (int8_t b = 3; b >= 0; b--)
+		word = (word << 8) | ReadByte(address + b);
+	return word;
+}
+
+void FIRSTParameters::WriteByte(int address, uint8_t value)
+{
+#if defined(__AVR__)
+	eeprom_write_byte((uint8_t *)address, value);
+#else
+	if (address < 0 || address >= kImageSize)
+		return;
+	s_image[address] = value;
+	if (s_file != NULL)
+	{
+		fseek(s_file, address, SEEK_SET);
+		fputc(value, s_file);
+		fflush(s_file);
+	}
+#endif
+}
+
+bool FIRSTParameters::IsReady()
+{
+#if defined(__AVR__)
+	return eeprom_is_ready();
+#else
+	return true;
+#endif
+}
+
+uint16_t FIRSTParameters::CRC(uint16_t crc, uint8_t data)
+{
+	crc ^= (uint16_t)data << 8;
+	for (uint8_t i = 0; i < 8; i++)
+		crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+	return crc;
+}
+
+int FIRSTParameters::BankAddress(int bank)
+{
+	return m_address + bank * kBankSize;
+}
+
+/**
+ * Checks the CRC of a bank.
+ * @param bank the bank
+ * @param sequence where to put the sequence of the bank
+ * @param count where to put the number of records in the bank
+ * @return whether the bank is valid
+ */
+bool FIRSTParameters::IsValid(int bank, uint8_t *sequence, uint8_t *count)
+{
+	int address = BankAddress(bank);
+	*sequence = ReadByte(address);
+	*count = ReadByte(address + 1);
+	if (*count > kMaxParameters)
+		return false;
+
+	uint16_t crc = CRC(CRC(0xFFFF, *sequence), *count);
+	for (int i = 0; i < *count * kRecordSize; i++)
+		crc = CRC(crc, ReadByte(address + kHeaderSize + i));
+	return crc == (ReadByte(address + 2) | ((uint16_t)ReadByte(address + 3) << 8));
+}
+
+/**
+ * Finds the newest valid bank, the one the parameters are loaded from.
+ */
+void FIRSTParameters::Load()
+{
+	m_loaded = true;
+	for (uint8_t bank = 0; bank < m_banks; bank++)
+	{
+		uint8_t sequence, count;
+		if (!IsValid(bank, &sequence, &count))
+			continue;
+		// The sequence wraps, newer is at most 127 ahead
+		if (m_bank < 0 || (int8_t)(sequence - m_sequence) > 0)
+		{
+			m_bank = bank;
+			m_sequence = sequence;
+			m_storedCount = count;
+		}
+	}
+}
+
+int FIRSTParameters::Find(uint32_t key)
+{
+	for (uint8_t i = 0; i < m_count; i++)
+	{
+		if (m_keys[i] == key)
+			return i;
+	}
+	return -1;
+}
+
+int FIRSTParameters::Find(const char *name)
+{
+	int index = Find(FIRSTConsole::Hash(name));
+	return index >= 0 && strcmp(m_names[index], name) == 0 ? index : -1;
+}
+
+/**
+ * Declares a parameter, loading its stored value if there is one. Declaring the same
+ * name again returns the same parameter.
+ * @param name the name of the parameter, it is not copied
+ * @param value the default value
+ * @return where to read the parameter from, or NULL if there is no room left or the
+ * name has the hash of another one
+ */
+const long *FIRSTParameters::Declare(const char *name, long value)
+{
+	if (!m_loaded)
+		Load();
+
+	uint32_t key = FIRSTConsole::Hash(name);
+	int index = Find(key);
+	if (index >= 0)
+	{
+		if (strcmp(m_names[index], name) == 0)
+			return &m_values[index];
+		FIRSTEventLog::Log(FIRSTEventLog::kParameterNameClash, key);
+		return NULL;
+	}
+	if (m_count >= kMaxParameters)
+		return NULL;
+
+	if (m_bank >= 0)
+	{
+		int address = BankAddress(m_bank) + kHeaderSize;
+		for (uint8_t i = 0; i < m_storedCount; i++, address += kRecordSize)
+		{
+			if (ReadWord(address) == key)
+			{
+				value = (int32_t)ReadWord(address + 4);
+				break;
+			}
+		}
+	}
+
+	// The slot may hold a record carried over by the bank being written, start it over
+	if (m_writing)
+	{
+		m_writing = false;
+		m_dirty = true;
+	}
+	m_names[m_count] = name;
+	m_keys[m_count] = key;
+	m_values[m_count] = value;
+	return &m_values[m_count++];
+}
+
+/**
+ * Returns a declared parameter.
+ * @param name the name of the parameter
+ * @return where to read the parameter from, or NULL if it was not declared
+ */
+const long *FIRSTParameters::Get(const char *name)
+{
+	int index = Find(name);
+	return index < 0 ? NULL : &m_values[index];
+}
+
+/**
+ * Changes a parameter. It is written back to the EEPROM once the changes settle.
+ * @param name the name of the parameter
+ * @param value the new value
+ * @return false if the parameter was not declared
+ */
+bool FIRSTParameters::Set(const char *name, long value)
+{
+	return Set(Get(name), value);
+}
+
+/**
+ * Changes a parameter. It is written back to the EEPROM once the changes settle.
+ * @param parameter the parameter, as returned by Declare()
+ * @param value the new value
+ * @return false if that is not a parameter
+ */
+bool FIRSTParameters::Set(const long *parameter, long value)
+{
+	if (parameter < m_values || parameter >= m_values + m_count)
+		return false;
+	if (*parameter == value)
+		return true;
+
+	m_values[parameter - m_values] = value;
+	m_dirty = true;
+	m_changedAt = GetScheduler()->Millis();
+	// A bank being written is started over with the new value
+	m_writing = false;
+	return true;
+}
+
+/**
+ * Returns whether some changes are not in the EEPROM yet.
+ * @return whether the parameters are dirty
+ */
+bool FIRSTParameters::IsDirty()
+{
+	return m_dirty || m_writing;
+}
+
+/**
+ * Returns how many banks were written, to keep an eye on the wear.
+ * @return the number of banks written
+ */
+unsigned int FIRSTParameters::GetBankWrites()
+{
+	return m_bankWrites;
+}
+
+/**
+ * Copies the records of the current bank that were not declared after the declared
+ * ones, in the free slots, to be written with them.
+ */
+void FIRSTParameters::CarryOver()
+{
+	m_writeCount = m_count;
+	if (m_bank < 0)
+		return;
+	int address = BankAddress(m_bank) + kHeaderSize;
+	for (uint8_t i = 0; i < m_storedCount && m_writeCount < kMaxParameters; i++, address += kRecordSize)
+	{
+		uint32_t key = ReadWord(address);
+		if (Find(key) >= 0)
+			continue;
+		m_keys[m_writeCount] = key;
+		m_values[m_writeCount] = (int32_t)ReadWord(address + 4);
+		m_writeCount++;
+	}
+}
+
+/**
+ * The byte of the bank being written at a given step: the records come first, the
+ * header last.
+ */
+uint8_t FIRSTParameters::ImageByte(int step)
+{
+	int records = m_writeCount * kRecordSize;
+	if (step < records)
+	{
+		uint8_t b = step % kRecordSize;
+		uint32_t word = b < 4 ? m_keys[step / kRecordSize] : (uint32_t)m_values[step / kRecordSize];
+		return word >> (8 * (b & 3));
+	}
+	switch (step - records)
+	{
+	case 0:
+		return m_sequence + 1;
+	case 1:
+		return m_writeCount;
+	case 2:
+		return m_writeCRC;
+	default:
+		return m_writeCRC >> 8;
+	}
+}
+
+/**
+ * Writes back the changes, a byte at a time. Called by the {@link Scheduler} at the end
+ * of every pass.
+ */
+void FIRSTParameters::Flush()
+{
+	if (!m_writing)
+	{
+		if (!m_dirty || GetScheduler()->Millis() - m_changedAt < kSettleTime)
+			return;
+		m_writing = true;
+		m_dirty = false;
+		m_writeStep = 0;
+		CarryOver();
+		m_writeCRC = CRC(CRC(0xFFFF, m_sequence + 1), m_writeCount);
+	}
+	if (!IsReady())
+		return;
+
+	int bank = BankAddress(m_bank < 0 ? 0 : (m_bank + 1) % m_banks);
+	int records = m_writeCount * kRecordSize;
+	int total = records + kHeaderSize;
+	// The bytes already right are skipped, up to a few per pass
+	for (uint8_t compares = 0; m_writeStep < total && compares < kMaxCompares; compares++)
+	{
+		uint8_t value = ImageByte(m_writeStep);
+		int address = m_writeStep < records ? bank + kHeaderSize + m_writeStep : bank + m_writeStep - records;
+		if (m_writeStep < records)
+			m_writeCRC = CRC(m_writeCRC, value);
+		m_writeStep++;
+		if (ReadByte(address) != value)
+		{
+			WriteByte(address, value);
+			break;
+		}
+	}
+
+	if (m_writeStep >= total)
+	{
+		m_writing = false;
+		m_bank = m_bank < 0 ? 0 : (m_bank + 1) % m_banks;
+		m_sequence++;
+		m_storedCount = m_writeCount;
+		m_bankWrites++;
+	}
+}
@@ -0,0 +1,106 @@
+/*
+ * FIRSTParameters.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef FIRSTPARAMETERS_H_
+#define FIRSTPARAMETERS_H_
+
+#include <Arduino.h>
+
+#include "FIRSTSubsystem.h"
+
+/**
+ * Tunable parameters kept in the EEPROM, so that gains and timeouts can be changed
+ * without reflashing.
+ *
+ * Commands and subsystems declare their parameters by name with a default, usually in
+ * their constructors, and keep the pointer they get: reading a parameter is reading
+ * a long from RAM. The stored value, if there is one, is loaded when the parameter is
+ * declared. Parameters are changed with Set(), from the {@link Console} for example.
+ *
+ * Changes are written back behind the scheduler's back: once no parameter has changed
+ * for kSettleTime, every pass writes at most one byte, and only if the EEPROM is done
+ * with the previous one, so a pass never waits on a write.
+ *
+ * The EEPROM area holds several banks, written in turn to spread the wear. A bank is:
+ * <pre>
+ *   sequence (1 byte), count (1 byte), CRC-16-CCITT of the sequence, the count and
+ *   the records (2 bytes, LE)
+ *   count records: FNV-1a hash of the name (4 bytes, LE), value (4 bytes, LE)
+ * </pre>
+ * The header is written last, so a bank cut short by a reset fails its CRC and the
+ * previous bank, the newest valid one, is loaded instead. A bank carries over the
+ * records of the bank it replaces that were not declared, up to kMaxParameters, so
+ * that the parameters of a program that was not run this time are kept. With a single
+ * bank, which is read while it is rewritten, declare every parameter before changing one.
+ *
+ * A parameter is known in the EEPROM by the hash of its name only; a name with the hash
+ * of another one is not declared, and logged (see {@link EventLog}).
+ *
+ * Off the AVR the EEPROM is a RAM image, saved to the file given to SetImageFile().
+ */
+class FIRSTParameters : public FIRSTSubsystem
+{
+public:
+	static const uint8_t kMaxParameters = 16;
+	static const int kHeaderSize = 4;
+	static const int kRecordSize = 8;
+	static const int kBankSize = kHeaderSize + kMaxParameters * kRecordSize;
+	static const unsigned long kSettleTime = 1000;
+	static const uint8_t kMaxCompares = 16;
+
+	FIRSTParameters(int address, uint8_t banks = 2, FIRSTScheduler *scheduler = NULL);
+	virtual ~FIRSTParameters();
+
+	const long *Declare(const char *name, long value);
+	const long *Get(const char *name);
+	bool Set(const char *name, long value);
+	bool Set(const long *parameter, long value);
+	bool IsDirty();
+	unsigned int GetBankWrites();
+
+	virtual void Flush();
+
+	static void SetImageFile(const char *path);
+
+private:
+	void Load();
+	bool IsValid(int bank, uint8_t *sequence, uint8_t *count);
+	int Find(uint32_t key);
+	int Find(const char *name);
+	void CarryOver();
+	uint8_t ImageByte(int step);
+	int BankAddress(int bank);
+
+	static uint8_t ReadByte(int address);
+	static uint32_t ReadWord(int address);
+	static void WriteByte(int address, uint8_t value);
+	static bool IsReady();
+	static uint16_t CRC(uint16_t crc, uint8_t data);
+
+	int m_address;
+	uint8_t m_banks;
+	bool m_loaded;
+	int8_t m_bank;
+	uint8_t m_sequence;
+	uint8_t m_storedCount;
+
+	const char *m_names[kMaxParameters];
+	uint32_t m_keys[kMaxParameters];
+	long m_values[kMaxParameters];
+	uint8_t m_count;
+
+	bool m_dirty;
+	bool m_writing;
+	unsigned long m_changedAt;
+	int m_writeStep;
+	uint8_t m_writeCount;
+	uint16_t m_writeCRC;
+	unsigned int m_bankWrites;
+};
+
+
+#endif /* FIRSTPARAMETERS_H_ */
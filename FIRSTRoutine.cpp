@@ -0,0 +1,342 @@
+/*
+ * FIRSTRoutine.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include "FIRSTRoutine.h"
+#include "FIRSTScheduler.h"
+#include "FIRSTEventLog.h"
+
+#if defined(__AVR__)
+#include <avr/eeprom.h>
+#endif
+
+FIRSTRoutine *FIRSTRoutine::_routines = NULL;
+
+/**
+ * Creates a routine.
+ * @param program the bytecode; its address in flash for kPROGMEM, its offset in the
+ * EEPROM for kEEPROM (off the AVR EEPROM routines are read from RAM)
+ * @param length the length of the bytecode
+ * @param source where the bytecode is: kRAM, kPROGMEM or kEEPROM
+ * @param commands the commands the routine refers to, at most kMaxCommands
+ * @param commandCount the number of commands
+ * @param conditions the conditions the routine refers to
+ * @param conditionCount the number of conditions
+ */
+FIRSTRoutine::FIRSTRoutine(const uint8_t *program, uint16_t length, uint8_t source,
+		FIRSTCommand **commands, uint8_t commandCount,
+		FIRSTCondition *conditions, uint8_t conditionCount)
+	: m_program(program)
+	, m_length(length)
+	, m_source(source)
+	, m_commands(commands)
+	, m_commandCount(commandCount > kMaxCommands ? kMaxCommands : commandCount)
+	, m_conditions(conditions)
+	, m_conditionCount(conditionCount)
+	, m_pc(0)
+	, m_wait(kNone)
+	, m_condition(0)
+	, m_skipCheck(false)
+	, m_hasTimeout(false)
+	, m_finished(false)
+	, m_faulted(false)
+	, m_awaited(0)
+	, m_owned(0)
+	, m_deadline(0)
+	, m_timeoutAt(0)
+{
+	// One callback per command serves all the routines that share it
+	for (uint8_t i = 0; i < m_commandCount; i++)
+	{
+		bool watched = false;
+		for (FIRSTRoutine *routine = _routines; routine != NULL && !watched; routine = routine->m_nextRoutine)
+			watched = routine->Watches(m_commands[i]);
+		for (uint8_t j = 0; j < i && !watched; j++)
+			watched = m_commands[j] == m_commands[i];
+		if (!watched && m_commands[i] != NULL)
+			m_commands[i]->OnCompletion(&FIRSTRoutine::Released);
+	}
+	m_nextRoutine = _routines;
+	_routines = this;
+}
+
+FIRSTRoutine::~FIRSTRoutine()
+{
+	FIRSTRoutine **link = &_routines;
+	while (*link != NULL && *link != this)
+		link = &(*link)->m_nextRoutine;
+	if (*link == this)
+		*link = m_nextRoutine;
+}
+
+/**
+ * Returns the offset of the next instruction, or of the one being waited on.
+ * @return the program counter
+ */
+uint16_t FIRSTRoutine::GetProgramCounter()
+{
+	return m_pc;
+}
+
+/**
+ * Returns whether the routine stopped on an invalid instruction or operand.
+ * @return whether the routine is faulted
+ */
+bool FIRSTRoutine::IsFaulted()
+{
+	return m_faulted;
+}
+
+uint8_t FIRSTRoutine::Read()
+{
+	if (m_pc >= m_length)
+	{
+		Fault();
+		return kEnd;
+	}
+
+	const uint8_t *address = m_program + m_pc++;
+	switch (m_source)
+	{
+	case kPROGMEM:
+		return pgm_read_byte(address);
+#if defined(__AVR__)
+	case kEEPROM:
+		return eeprom_read_byte(address);
+#endif
+	default:
+		return *address;
+	}
+}
+
+uint16_t FIRSTRoutine::Read16()
+{
+	uint16_t low = Read();
+	return low | ((uint16_t)Read() << 8);
+}
+
+FIRSTCommand *FIRSTRoutine::Command(uint8_t index)
+{
+	if (index >= m_commandCount)
+	{
+		Fault();
+		return NULL;
+	}
+	return m_commands[index];
+}
+
+bool FIRSTRoutine::Watches(FIRSTCommand *command)
+{
+	for (uint8_t i = 0; i < m_commandCount; i++)
+	{
+		if (m_commands[i] == command)
+			return true;
+	}
+	return false;
+}
+
+/**
+ * Called whenever a command of a routine ends: no routine owns it anymore.
+ */
+void FIRSTRoutine::Released(FIRSTCommand *command, uint8_t)
+{
+	for (FIRSTRoutine *routine = _routines; routine != NULL; routine = routine->m_nextRoutine)
+	{
+		for (uint8_t i = 0; i < routine->m_commandCount; i++)
+		{
+			if (routine->m_commands[i] == command)
+				routine->m_owned &= ~(1 << i);
+		}
+	}
+}
+
+void FIRSTRoutine::Fault()
+{
+	FIRSTEventLog::Log(FIRSTEventLog::kRoutineFault, m_pc);
+	m_faulted = true;
+	m_finished = true;
+}
+
+void FIRSTRoutine::Initialize()
+{
+	m_pc = 0;
+	m_wait = kNone;
+	m_hasTimeout = false;
+	m_finished = false;
+	m_faulted = false;
+	m_awaited = 0;
+	m_owned = 0;
+}
+
+/**
+ * Checks whether what the routine is waiting on is over. A timeout ends any wait, and
+ * cancels the commands being waited on.
+ */
+bool FIRSTRoutine::IsWaitOver()
+{
+	bool over = false;
+	switch (m_wait)
+	{
+	case kTime:
+		over = (long)(GetScheduler()->Millis() - m_deadline) >= 0;
+		break;
+	case kCondition:
+		over = m_conditions[m_condition]();
+		break;
+	case kCommands:
+		// Commands started during this pass only begin running at its end
+		if (m_skipCheck)
+		{
+			m_skipCheck = false;
+			break;
+		}
+		over = true;
+		for (uint8_t i = 0; i < m_commandCount && over; i++)
+		{
+			if ((m_awaited & (1 << i)) && m_commands[i]->IsRunning())
+				over = false;
+		}
+		break;
+	default:
+		over = true;
+		break;
+	}
+
+	if (!over && m_hasTimeout && (long)(GetScheduler()->Millis() - m_timeoutAt) >= 0)
+	{
+		for (uint8_t i = 0; i < m_commandCount; i++)
+		{
+			if (m_awaited & (1 << i))
+				m_commands[i]->Cancel();
+		}
+		over = true;
+	}
+
+	if (over)
+	{
+		m_wait = kNone;
+		m_hasTimeout = false;
+		m_awaited = 0;
+	}
+	return over;
+}
+
+void FIRSTRoutine::Execute()
+{
+	// The commands started on the previous pass that are not running were refused, or
+	// canceled before they ever ran, and end without a completion
+	for (uint8_t i = 0; i < m_commandCount; i++)
+	{
+		if ((m_owned & (1 << i)) && !m_commands[i]->IsRunning())
+			m_owned &= ~(1 << i);
+	}
+
+	for (uint8_t step = 0; step < kMaxSteps && !m_finished; step++)
+	{
+		if (m_wait != kNone && !IsWaitOver())
+			return;
+
+		uint8_t opcode = Read();
+		if (m_finished)
+			return;
+
+		uint8_t operand;
+		FIRSTCommand *command;
+		switch (opcode)
+		{
+		case kEnd:
+			m_finished = true;
+			break;
+
+		case kStart:
+		case kRun:
+		case kWaitFor:
+			operand = Read();
+			command = Command(operand);
+			if (command == NULL)
+				break;
+			if (opcode != kWaitFor)
+			{
+				command->Start();
+				m_owned |= 1 << operand;
+			}
+			if (opcode != kStart)
+			{
+				m_awaited = 1 << operand;
+				m_wait = kCommands;
+				m_skipCheck = true;
+			}
+			break;
+
+		case kParallel:
+			m_awaited = 0;
+			for (uint8_t count = Read(); count > 0 && !m_finished; count--)
+			{
+				operand = Read();
+				command = Command(operand);
+				if (command == NULL)
+					break;
+				command->Start();
+				m_owned |= 1 << operand;
+				m_awaited |= 1 << operand;
+			}
+			m_wait = kCommands;
+			m_skipCheck = true;
+			break;
+
+		case kWait:
+			m_deadline = GetScheduler()->Millis() + Read16();
+			m_wait = kTime;
+			break;
+
+		case kUntil:
+			m_condition = Read();
+			if (m_condition >= m_conditionCount)
+				Fault();
+			else
+				m_wait = kCondition;
+			break;
+
+		case kTimeout:
+			m_timeoutAt = GetScheduler()->Millis() + Read16();
+			m_hasTimeout = true;
+			break;
+
+		case kCancel:
+			command = Command(Read());
+			if (command != NULL)
+				command->Cancel();
+			break;
+
+		case kJump:
+			m_pc = Read16();
+			break;
+
+		default:
+			Fault();
+			break;
+		}
+	}
+}
+
+bool FIRSTRoutine::IsFinished()
+{
+	return m_finished;
+}
+
+void FIRSTRoutine::End()
+{
+}
+
+void FIRSTRoutine::Interrupted()
+{
+	for (uint8_t i = 0; i < m_commandCount; i++)
+	{
+		if (m_owned & (1 << i))
+			m_commands[i]->Cancel();
+	}
+	m_owned = 0;
+}
@@ -0,0 +1,135 @@
+/*
+ * FIRSTRoutine.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef FIRSTROUTINE_H_
+#define FIRSTROUTINE_H_
+
+#include <Arduino.h>
+
+#include "FIRSTCommand.h"
+
+/*
+ * The routine "assembler": each macro expands to the bytes of one instruction, so that
+ * a routine is written as a byte array, in PROGMEM or in RAM, or dumped to EEPROM or
+ * a file. Commands and conditions are referred to by their index in the tables given
+ * to the routine, times are in milliseconds up to 65535.
+ *
+ *   static const uint8_t auto1[] PROGMEM = {
+ *       FIRST_RUN(0),                  // drive forward and wait for it to finish
+ *       FIRST_PARALLEL(2), 1, 2,       // raise the arm and open the claw together
+ *       FIRST_TIMEOUT(1500), FIRST_UNTIL(0),   // wait for the sensor, 1.5 s at most
+ *       FIRST_END()
+ *   };
+ */
+#define FIRST_END()               FIRSTRoutine::kEnd
+#define FIRST_START(command)      FIRSTRoutine::kStart, (command)
+#define FIRST_RUN(command)        FIRSTRoutine::kRun, (command)
+#define FIRST_WAIT_FOR(command)   FIRSTRoutine::kWaitFor, (command)
+#define FIRST_PARALLEL(count)     FIRSTRoutine::kParallel, (count)
+#define FIRST_WAIT(ms)            FIRSTRoutine::kWait, ((ms) & 0xFF), (((ms) >> 8) & 0xFF)
+#define FIRST_UNTIL(condition)    FIRSTRoutine::kUntil, (condition)
+#define FIRST_TIMEOUT(ms)         FIRSTRoutine::kTimeout, ((ms) & 0xFF), (((ms) >> 8) & 0xFF)
+#define FIRST_CANCEL(command)     FIRSTRoutine::kCancel, (command)
+#define FIRST_JUMP(address)       FIRSTRoutine::kJump, ((address) & 0xFF), (((address) >> 8) & 0xFF)
+
+/**
+ * Runs an autonomous routine from bytecode, so that routines can be changed without
+ * building new command classes, or even without reflashing when kept in EEPROM.
+ *
+ * The instructions start the commands from a table, wait for them, for some time or
+ * for a condition, optionally with a timeout. A routine needs a couple dozen bytes of RAM
+ * whatever its length, and every pass runs a bounded number of instructions, stopping
+ * at the first one that has to wait.
+ *
+ * The commands are started as independent commands, the routine itself requires nothing.
+ * When the routine is interrupted it cancels the commands it started that are still
+ * running on its behalf: not those that ended since, even if something else started
+ * them again. The routine learns of their ending through a completion callback (see
+ * {@link Command#OnCompletion()}), which takes one slot of each command of its table.
+ *
+ * Off the AVR a routine can be loaded from a memory-mapped file as a RAM one.
+ */
+class FIRSTRoutine : public FIRSTCommand
+{
+public:
+	enum {
+		kEnd,
+		kStart,
+		kRun,
+		kWaitFor,
+		kParallel,
+		kWait,
+		kUntil,
+		kTimeout,
+		kCancel,
+		kJump
+	};
+	enum {
+		kRAM,
+		kPROGMEM,
+		kEEPROM
+	};
+	static const uint8_t kMaxCommands = 16;
+	static const uint8_t kMaxSteps = 8;
+
+	FIRSTRoutine(const uint8_t *program, uint16_t length, uint8_t source,
+			FIRSTCommand **commands, uint8_t commandCount,
+			FIRSTCondition *conditions = NULL, uint8_t conditionCount = 0);
+	virtual ~FIRSTRoutine();
+
+	uint16_t GetProgramCounter();
+	bool IsFaulted();
+
+protected:
+	virtual void Initialize();
+	virtual void Execute();
+	virtual bool IsFinished();
+	virtual void End();
+	virtual void Interrupted();
+
+private:
+	enum {
+		kNone,
+		kTime,
+		kCommands,
+		kCondition
+	};
+
+	uint8_t Read();
+	uint16_t Read16();
+	FIRSTCommand *Command(uint8_t index);
+	bool IsWaitOver();
+	void Fault();
+	bool Watches(FIRSTCommand *command);
+	static void Released(FIRSTCommand *command, uint8_t reason);
+
+	static FIRSTRoutine *_routines;
+	FIRSTRoutine *m_nextRoutine;
+
+	const uint8_t *m_program;
+	uint16_t m_length;
+	uint8_t m_source;
+	FIRSTCommand **m_commands;
+	uint8_t m_commandCount;
+	FIRSTCondition *m_conditions;
+	uint8_t m_conditionCount;
+
+	uint16_t m_pc;
+	uint8_t m_wait;
+	uint8_t m_condition;
+	bool m_skipCheck;
+	bool m_hasTimeout;
+	bool m_finished;
+	bool m_faulted;
+	uint16_t m_awaited;
+	uint16_t m_owned;
+	unsigned long m_deadline;
+	unsigned long m_timeoutAt;
+};
+
+
+#endif /* FIRSTROUTINE_H_ */
@@ -13,20 +13,62 @@
 
 #include "FIRSTScheduler.h"
 #include "FIRSTSubsystem.h"
+#include "FIRSTTelemetry.h"
+#include "FIRSTOutputs.h"
+#include "FIRSTBatch.h"
+#include "FIRSTLatency.h"
+#include "FIRSTEventLog.h"
+#include "FIRSTConsole.h"
+#include "FIRSTFixed.h"
+
+#if defined(__AVR__)
+#include <avr/wdt.h>
+#endif
 
 FIRSTScheduler *FIRSTScheduler::_instance = NULL;
 
+/**
+ * Creates a scheduler.
+ * Most programs only need the one returned by GetInstance(). Programs that run groups of
+ * subsystems at different rates create one scheduler per group, see {@link Executive}.
+ */
 FIRSTScheduler::FIRSTScheduler() :
 	m_adding(false) {
 	m_enabled = true;
+	m_disabling = false;
 	m_runningCommandsChanged = false;
+	m_telemetry = NULL;
+	m_latency = NULL;
+	m_console = NULL;
+	m_outputs = NULL;
+	m_lastRunTime = 0;
+	m_maxRunTime = 0;
+	m_hasPassStart = false;
+	m_passStart = 0;
+	m_passDelta = 0;
+	m_passBudget = 0;
+	m_passOverruns = 0;
+	m_resetOnOverrun = false;
+	m_timeCommands = false;
+	m_frozen = false;
+	m_freezeTime = 0;
+	m_commandCounter = 0;
+	m_virtualClock = false;
+	m_clockMicros = 0;
+	m_clockMillis = 0;
+	m_clockRemainder = 0;
+	ResetStatistics();
 }
 
 FIRSTScheduler::~FIRSTScheduler() {
+	delete m_outputs;
+	if (FIRSTEventLog::GetClock() == this)
+		FIRSTEventLog::SetClock(NULL);
 }
 
 /**
- * Returns the {@link Scheduler}, creating it if one does not exist.
+ * Returns the default {@link Scheduler}, creating it if one does not exist.
+ * Subsystems and commands that are not given a scheduler are bound to this one.
  * @return the {@link Scheduler}
  */
 FIRSTScheduler *FIRSTScheduler::GetInstance() {
@@ -35,29 +77,88 @@ FIRSTScheduler *FIRSTScheduler::GetInstance() {
 	return _instance;
 }
 
+/**
+ * Enables or disables the {@link Scheduler}.
+ * When disabled, every running command that does not run when disabled is canceled
+ * on the next pass, and only the commands that do are executed afterwards.
+ * @param enabled whether or not the scheduler should be enabled
+ * @see Command#SetRunWhenDisabled()
+ */
 void FIRSTScheduler::SetEnabled(bool enabled) {
+	if (m_enabled && !enabled)
+		m_disabling = true;
 	m_enabled = enabled;
 }
 
+/**
+ * Sets where the state of the scheduler is streamed to at the end of every pass.
+ * @param telemetry the telemetry stream (or NULL if there should be none)
+ */
+void FIRSTScheduler::SetTelemetry(FIRSTTelemetry *telemetry) {
+	m_telemetry = telemetry;
+}
+
+/**
+ * Sets where the input to output latencies are recorded when the outputs are committed.
+ * @param latency the latency recorder (or NULL if there should be none)
+ */
+void FIRSTScheduler::SetLatency(FIRSTLatency *latency) {
+	m_latency = latency;
+}
+
+/**
+ * Sets the console polled for lines at the start of every pass.
+ * @param console the console (or NULL if there should be none)
+ */
+void FIRSTScheduler::SetConsole(FIRSTConsole *console) {
+	m_console = console;
+}
+
 /**
  * Add a command to be scheduled later.
  * In any pass through the scheduler, all commands are added to the additions list, then
  * at the end of the pass, they are all scheduled.
+ * While disabled, commands that do not run when disabled are ignored.
  * @param command The command to be scheduled
  */
 void FIRSTScheduler::AddCommand(FIRSTCommand *command) {
+	if (command == NULL) {
+		FIRSTEventLog::Log(FIRSTEventLog::kNullCommand, 0);
+		return;
+	}
+	if (!m_enabled && !command->WillRunWhenDisabled())
+		return;
 	if (m_additions.find(command) != m_additions.end())
 		return;
 	m_additions.push_back(command);
 }
 
+/**
+ * Moves a running command in or out of the commands run when disabled, after its
+ * setting changed. One that no longer runs when disabled is canceled on the next pass
+ * if the scheduler is disabled.
+ * @param command the command
+ */
+void FIRSTScheduler::UpdateRunWhenDisabled(FIRSTCommand *command) {
+	if (m_commands.find(command) == m_commands.end())
+		return;
+	m_disabledCommands.erase(command);
+	if (command->WillRunWhenDisabled()) {
+		// At the front, where a walk of the list going on does not run it twice
+		m_disabledCommands.insert(command);
+	}
+	else if (!m_enabled) {
+		m_disabling = true;
+	}
+}
+
 void FIRSTScheduler::ProcessCommandAddition(FIRSTCommand *command) {
 	if (command == NULL)
 		return;
 
 	// Check to make sure no adding during adding
 	if (m_adding) {
-		//wpi_setWPIErrorWithContext(IncompatibleState, "Can not start command from cancel method");
+		FIRSTEventLog::Log(FIRSTEventLog::kAddDuringAdd, command->GetID());
 		return;
 	}
 
@@ -65,7 +166,7 @@ void FIRSTScheduler::ProcessCommandAddition(FIRSTCommand *command) {
 	CommandVector::iterator found = m_commands.find(command);
 	if (found == m_commands.end()) {
 		// Check that the requirements can be had
-		FIRSTCommand::SubsystemSet requirements = command->GetRequirements();
+		const FIRSTCommand::SubsystemSet &requirements = command->GetRequirements();
 		FIRSTCommand::SubsystemSet::iterator iter;
 		for (iter = requirements.begin(); iter != requirements.end(); iter++) {
 			FIRSTSubsystem *lock = *iter;
@@ -75,18 +176,23 @@ void FIRSTScheduler::ProcessCommandAddition(FIRSTCommand *command) {
 		}
 
 		// Give it the requirements
+		// Removing a command releases all of its subsystems and calls its Interrupted(),
+		// so the current owner has to be fetched again for every subsystem.
 		m_adding = true;
 		for (iter = requirements.begin(); iter != requirements.end(); iter++) {
 			FIRSTSubsystem *lock = *iter;
-			if (lock->GetCurrentCommand() != NULL) {
-				lock->GetCurrentCommand()->Cancel();
-				Remove(lock->GetCurrentCommand());
+			FIRSTCommand *owner = lock->GetCurrentCommand();
+			if (owner != NULL && owner != command) {
+				owner->_Cancel();
+				Remove(owner);
 			}
 			lock->SetCurrentCommand(command);
 		}
 		m_adding = false;
 
 		m_commands.insert(command);
+		if (command->WillRunWhenDisabled())
+			m_disabledCommands.insert(command);
 
 		command->StartRunning();
 		m_runningCommandsChanged = true;
@@ -95,17 +201,41 @@ void FIRSTScheduler::ProcessCommandAddition(FIRSTCommand *command) {
 
 /**
  * Runs a single iteration of the loop.  This method should be called often in order to have a functioning
- * {@link Command} system.  The loop has five stages:
+ * {@link Command} system.  The loop has nine stages:
  *
  * <ol>
  * <li> Poll the Buttons </li>
+ * <li> Poll the console (see {@link Console}) </li>
+ * <li> Sample the Subsystems (see {@link Subsystem#Periodic()}) </li>
  * <li> Execute/Remove the Commands </li>
- * <li> Send values to SmartDashboard </li>
- * <li> Add Commands </li>
+ * <li> Run the kernels of the command batches (see {@link Batch}) </li>
+ * <li> Add Commands, those chained to the ones just removed included (see {@link Command#Then()}) </li>
  * <li> Add Defaults </li>
+ * <li> Flush the Subsystems and commit the staged outputs (see {@link Outputs}) </li>
+ * <li> Send values to the dashboard (see {@link Telemetry}) </li>
  * </ol>
+ *
+ * When the scheduler is disabled, the console is polled and the subsystems are sampled
+ * as usual. The first disabled pass then cancels every command that does not run when
+ * disabled. Every disabled pass adds the commands started since that run when disabled
+ * (the others are not even queued, see AddCommand()), before rather than after executing
+ * the commands that run when disabled. It then runs the batches, flushes the outputs and
+ * sends the telemetry. The default commands are not added while disabled.
  */
 void FIRSTScheduler::Run() {
+	// The cost of the pass is measured in real time, the rest uses the clock
+	unsigned long start = micros();
+	unsigned long now = Micros();
+	// The clock may well read 0 at the first pass, or wrap to it
+	m_passDelta = m_hasPassStart ? now - m_passStart : 0;
+	m_passStart = now;
+	m_hasPassStart = true;
+	FIRSTEventLog::SetClock(this);
+#if defined(__AVR__)
+	if (m_resetOnOverrun)
+		wdt_reset();
+#endif
+
 /*	// Get button input (going backwards preserves button priority)
 	{
 		if (!m_enabled)
@@ -120,18 +250,22 @@ void FIRSTScheduler::Run() {
 
 	m_runningCommandsChanged = false;
 
-	// Loop through the commands
-	CommandVector::iterator commandIter = m_commands.begin();
-	for (; commandIter != m_commands.end();) {
-		FIRSTCommand *command = *commandIter;
-		// Increment before potentially removing to keep the iterator valid
-		commandIter++;
-		if (!command->Run()) {
-			Remove(command);
-			m_runningCommandsChanged = true;
-		}
+	if (m_console != NULL)
+		m_console->Poll(this);
+
+	SampleSubsystems();
+
+	if (!m_enabled) {
+		RunDisabled(start);
+		RecordRunTime(start);
+		return;
 	}
 
+	// Loop through the commands
+	RunCommands(m_commands, start);
+
+	RunBatches();
+
 	// Add the new things
 	{
 		//Synchronized sync(m_additionsLock);
@@ -151,6 +285,392 @@ void FIRSTScheduler::Run() {
 		}
 		lock->ConfirmCommand();
 	}
+
+	// Write the outputs all at once
+	FlushOutputs();
+
+	// Send values to the dashboard
+	if (m_telemetry != NULL)
+		m_telemetry->Update(this, m_runningCommandsChanged);
+
+	RecordRunTime(start);
+}
+
+/**
+ * Lets every subsystem read its sensors once, ahead of the commands that use them, and
+ * filters the readings (see {@link Subsystem#AddFilter()}).
+ */
+void FIRSTScheduler::SampleSubsystems() {
+	int32_t dt = FIRSTFixed::FromMicros(m_passDelta);
+	FIRSTCommand::SubsystemSet::iterator subsystemIter = m_subsystems.begin();
+	for (; subsystemIter != m_subsystems.end(); subsystemIter++) {
+		FIRSTSubsystem *subsystem = *subsystemIter;
+		subsystem->m_sampleTime = Micros();
+		subsystem->Periodic();
+		subsystem->UpdateFilters(dt);
+	}
+}
+
+/**
+ * Lets every subsystem send out its buffered outputs, then commits the staged pins.
+ * The outputs being out, the latency of every command that acted on an input this pass
+ * is recorded for each of the subsystems it owns whose output changed.
+ */
+void FIRSTScheduler::FlushOutputs() {
+	FIRSTCommand::SubsystemSet::iterator subsystemIter = m_subsystems.begin();
+	for (; subsystemIter != m_subsystems.end(); subsystemIter++) {
+		(*subsystemIter)->Flush();
+	}
+	if (m_outputs != NULL)
+		m_outputs->Commit();
+
+	if (m_latency == NULL)
+		return;
+
+	unsigned long now = Micros();
+	for (subsystemIter = m_subsystems.begin(); subsystemIter != m_subsystems.end(); subsystemIter++) {
+		FIRSTSubsystem *subsystem = *subsystemIter;
+		FIRSTCommand *owner = subsystem->GetCurrentCommand();
+		if (subsystem->m_outputChanged && owner != NULL && owner->m_hasCause)
+			m_latency->Record(owner, subsystem, now - owner->m_causeTime);
+		subsystem->m_outputChanged = false;
+	}
+	// A command may own several subsystems, clear the tags once all are recorded
+	for (subsystemIter = m_subsystems.begin(); subsystemIter != m_subsystems.end(); subsystemIter++) {
+		FIRSTCommand *owner = (*subsystemIter)->GetCurrentCommand();
+		if (owner != NULL)
+			owner->m_hasCause = false;
+	}
+}
+
+/**
+ * Runs the commands of the given list, removing those that are finished. The demoted
+ * commands run last, and only while the pass is within its budget.
+ * @param commands the commands to run
+ * @param start the start of the pass
+ */
+void FIRSTScheduler::RunCommands(CommandVector &commands, unsigned long start) {
+	bool deferred = false;
+	CommandVector::iterator commandIter = commands.begin();
+	for (; commandIter != commands.end();) {
+		FIRSTCommand *command = *commandIter;
+		// Increment before potentially removing to keep the iterator valid
+		commandIter++;
+		// Nothing to do for a command waiting on its flag, not even to time it
+		if (command->m_doneFlag != NULL && command->m_initialized && !command->m_canceled
+				&& *command->m_doneFlag == 0)
+			continue;
+		// A command demoted during this loop already ran, it must not run again below
+		command->m_deferred = command->m_demoted;
+		if (command->m_deferred)
+			deferred = true;
+		else
+			RunCommand(command);
+	}
+
+	if (!deferred)
+		return;
+
+	for (commandIter = commands.begin(); commandIter != commands.end();) {
+		FIRSTCommand *command = *commandIter;
+		commandIter++;
+		if (!command->m_deferred)
+			continue;
+		command->m_deferred = false;
+		if (m_passBudget == 0 || micros() - start < m_passBudget)
+			RunCommand(command);
+	}
+}
+
+/**
+ * Runs a command, measuring how long it takes against its execution budget, and
+ * removes it if it is finished. A command with no budget is only timed when all the
+ * commands are (see SetCommandTiming()).
+ * @param command the command to run
+ * @return whether the command is still running
+ * @see Command#SetExecutionBudget()
+ */
+bool FIRSTScheduler::RunCommand(FIRSTCommand *command) {
+	if (command->m_budget == 0 && !m_timeCommands) {
+		bool running = command->Run();
+		if (!running) {
+			Remove(command);
+			m_runningCommandsChanged = true;
+		}
+		return running;
+	}
+
+	unsigned long start = micros();
+	bool running = command->Run();
+	unsigned long elapsed = micros() - start;
+
+	if (elapsed > command->m_maxExecutionTime)
+		command->m_maxExecutionTime = elapsed;
+	if (command->m_budget != 0 && elapsed > command->m_budget) {
+		command->m_budgetViolations++;
+		FIRSTEventLog::Log(FIRSTEventLog::kBudgetExceeded, command->GetID());
+		if (running && command->m_budgetPolicy == FIRSTCommand::kBudgetDemote) {
+			command->m_demoted = true;
+		}
+		else if (running && command->m_budgetPolicy == FIRSTCommand::kBudgetCancel) {
+			command->_Cancel();
+			running = false;
+		}
+	}
+
+	if (!running) {
+		Remove(command);
+		m_runningCommandsChanged = true;
+	}
+	return running;
+}
+
+/**
+ * Runs the kernel of every batch, once for all of its members.
+ */
+void FIRSTScheduler::RunBatches() {
+	AVector<FIRSTBatch *>::iterator batchIter = m_batches.begin();
+	for (; batchIter != m_batches.end(); batchIter++) {
+		(*batchIter)->Run();
+	}
+}
+
+/**
+ * A pass through the scheduler while disabled.
+ * The first pass after disabling cancels all the commands that do not run when disabled,
+ * after that only the pre-filtered list of commands that do is walked.
+ * @param start the start of the pass
+ */
+void FIRSTScheduler::RunDisabled(unsigned long start) {
+	if (m_disabling) {
+		m_disabling = false;
+		CancelDisabledCommands();
+	}
+
+	// Commands that run when disabled may still be started
+	if (!m_additions.empty()) {
+		CommandVector::iterator additionsIter = m_additions.begin();
+		for (; additionsIter != m_additions.end(); additionsIter++) {
+			ProcessCommandAddition(*additionsIter);
+		}
+		m_additions.clear();
+	}
+
+	RunCommands(m_disabledCommands, start);
+
+	RunBatches();
+	FlushOutputs();
+
+	if (m_telemetry != NULL)
+		m_telemetry->Update(this, m_runningCommandsChanged);
+}
+
+/**
+ * Cancels every running or pending command that does not run when disabled in one batch,
+ * so their Interrupted() methods get the chance to stop the actuators.
+ */
+void FIRSTScheduler::CancelDisabledCommands() {
+	m_additions.clear();
+
+	CommandVector::iterator commandIter = m_commands.begin();
+	for (; commandIter != m_commands.end();) {
+		FIRSTCommand *command = *commandIter;
+		commandIter++;
+		if (!command->WillRunWhenDisabled()) {
+			command->_Cancel();
+			Remove(command);
+			m_runningCommandsChanged = true;
+		}
+	}
+}
+
+void FIRSTScheduler::RecordRunTime(unsigned long start) {
+	m_lastRunTime = micros() - start;
+	if (m_lastRunTime > m_maxRunTime)
+		m_maxRunTime = m_lastRunTime;
+
+	if (m_passBudget == 0 || m_lastRunTime <= m_passBudget)
+		return;
+	m_passOverruns++;
+	FIRSTEventLog::Log(FIRSTEventLog::kPassOverrun,
+			m_lastRunTime > 0xFFFF ? 0xFFFF : m_lastRunTime);
+#if defined(__AVR__)
+	if (m_resetOnOverrun) {
+		// Let the watchdog reset the board at its shortest timeout
+		wdt_enable(WDTO_15MS);
+		for (;;)
+			;
+	}
+#endif
+}
+
+/**
+ * Returns how long the last pass through the scheduler took.
+ * The resolution is that of micros(), 4 microseconds on a 16 MHz board.
+ * @return the duration of the last call to Run() (in microseconds)
+ */
+unsigned long FIRSTScheduler::GetLastRunTime() {
+	return m_lastRunTime;
+}
+
+/**
+ * Returns the longest pass through the scheduler since the start or the last
+ * call to ResetMaxRunTime().
+ * @return the duration of the longest call to Run() (in microseconds)
+ */
+unsigned long FIRSTScheduler::GetMaxRunTime() {
+	return m_maxRunTime;
+}
+
+void FIRSTScheduler::ResetMaxRunTime() {
+	m_maxRunTime = 0;
+}
+
+/**
+ * Returns when the current (or the last) pass through the scheduler started.
+ * @return the start of the pass (in microseconds, see Micros())
+ */
+unsigned long FIRSTScheduler::GetPassTime() {
+	return m_passStart;
+}
+
+/**
+ * Returns the time between the starts of the current and the previous pass, the time
+ * step for the commands that integrate or differentiate. It is 0 on the first pass.
+ * @return the time since the previous pass (in microseconds)
+ */
+unsigned long FIRSTScheduler::GetPassDelta() {
+	return m_passDelta;
+}
+
+/**
+ * Switches the scheduler to a virtual clock, for simulating on a host: time then only
+ * moves by AdvanceClock(), so runs are repeatable and as fast as the host goes. The
+ * commands, subsystems and routines of the scheduler all read the time from its clock;
+ * only the costs of the passes and of the commands (see GetLastRunTime() and
+ * {@link Command#SetExecutionBudget()}) are still measured in real time.
+ * Every scheduler has its own clock, and its own command IDs, so many can be simulated
+ * side by side.
+ * @param enabled whether to use the virtual clock, starting at 0
+ */
+void FIRSTScheduler::SetVirtualClock(bool enabled) {
+	m_virtualClock = enabled;
+	m_hasPassStart = false;
+	m_clockMicros = 0;
+	m_clockMillis = 0;
+	m_clockRemainder = 0;
+}
+
+/**
+ * Moves the virtual clock forward.
+ * @param micros the time step (in microseconds)
+ */
+void FIRSTScheduler::AdvanceClock(unsigned long micros) {
+	m_clockMicros += micros;
+	// Kept apart, so the milliseconds do not wrap with the microseconds
+	m_clockMillis += micros / 1000;
+	m_clockRemainder += micros % 1000;
+	if (m_clockRemainder >= 1000) {
+		m_clockRemainder -= 1000;
+		m_clockMillis++;
+	}
+}
+
+/**
+ * Returns the output stage of this scheduler, creating it if it does not exist. The
+ * scheduler commits it at the end of every pass (see {@link Outputs}).
+ * @return the output stage
+ */
+FIRSTOutputs *FIRSTScheduler::GetOutputs() {
+	if (m_outputs == NULL)
+		m_outputs = new FIRSTOutputs();
+	return m_outputs;
+}
+
+/**
+ * Returns the time of this scheduler: micros(), or the virtual clock.
+ * @return the time (in microseconds)
+ */
+unsigned long FIRSTScheduler::Micros() {
+	return m_virtualClock ? m_clockMicros : micros();
+}
+
+/**
+ * Returns the time of this scheduler: millis(), or the virtual clock.
+ * @return the time (in milliseconds)
+ */
+unsigned long FIRSTScheduler::Millis() {
+	return m_virtualClock ? m_clockMillis : millis();
+}
+
+/**
+ * Returns how the commands removed from this scheduler ended: completed, completed
+ * by timing out, or interrupted, and the total and longest times (in milliseconds)
+ * from their initialization to their completion.
+ * @return the statistics
+ */
+const FIRSTScheduler::Statistics &FIRSTScheduler::GetStatistics() {
+	return m_statistics;
+}
+
+void FIRSTScheduler::ResetStatistics() {
+	memset(&m_statistics, 0, sizeof(m_statistics));
+}
+
+/**
+ * Sets how long a pass through the scheduler may take. Passes that take longer are
+ * counted and logged (see {@link EventLog}), and the demoted commands only run while
+ * the pass is within the budget (see {@link Command#SetExecutionBudget()}).
+ *
+ * With resetOnOverrun, the board is reset by the hardware watchdog on the first pass
+ * that overruns. The watchdog is also armed and fed at the start of every pass, so a
+ * command that hangs for good resets the board too. Being fed only there, its timeout
+ * must outlast a pass and the wait until the next one: it is the shortest timeout
+ * above budget + period (at least 15 ms, at most 2 s), period being the longest time
+ * loop() spends outside of Run(), such as its delay(). Only the AVR has the watchdog.
+ * @param budget the pass budget (in microseconds), 0 for none
+ * @param resetOnOverrun whether to reset the board when a pass overruns
+ * @param period the longest time between the end of a pass and the start of the next
+ * one (in microseconds)
+ */
+void FIRSTScheduler::SetPassBudget(unsigned long budget, bool resetOnOverrun, unsigned long period) {
+	bool armed = m_resetOnOverrun;
+	m_passBudget = budget;
+	m_resetOnOverrun = resetOnOverrun && budget != 0;
+#if defined(__AVR__)
+	if (m_resetOnOverrun) {
+		// The timeouts go from WDTO_15MS = 0 up, doubling each step
+		unsigned long gap = budget + period;
+		uint8_t timeout = WDTO_15MS;
+		while (timeout < WDTO_2S && (15000UL << timeout) <= gap)
+			timeout++;
+		wdt_enable(timeout);
+	}
+	else if (armed) {
+		wdt_disable();
+	}
+#else
+	(void)armed;
+	(void)period;
+#endif
+}
+
+/**
+ * Times every command, so that {@link Command#GetMaxExecutionTime()} is known for the
+ * commands without an execution budget as well. That costs two calls to micros() per
+ * command and pass, which is why only the commands with a budget are timed otherwise.
+ * @param enabled whether to time every command
+ */
+void FIRSTScheduler::SetCommandTiming(bool enabled) {
+	m_timeCommands = enabled;
+}
+
+/**
+ * Returns how many passes through the scheduler exceeded the pass budget.
+ * @return the number of pass overruns
+ */
+unsigned long FIRSTScheduler::GetPassOverruns() {
+	return m_passOverruns;
 }
 
 /**
@@ -160,37 +680,145 @@ void FIRSTScheduler::Run() {
  */
 void FIRSTScheduler::RegisterSubsystem(FIRSTSubsystem *subsystem) {
 	if (subsystem == NULL) {
-		//wpi_setWPIErrorWithContext(NullParameter, "subsystem");
+		FIRSTEventLog::Log(FIRSTEventLog::kNullSubsystem, 0);
+		return;
+	}
+	if (m_frozen) {
+		FIRSTEventLog::Log(FIRSTEventLog::kRegisterAfterFreeze, 0);
 		return;
 	}
 	m_subsystems.insert(subsystem);
 }
 
+/**
+ * Registers a {@link Batch} to this {@link Scheduler}, so that its kernel runs on every pass.
+ * All {@link Batch Batches} register themselves when created.
+ * @param batch the batch
+ */
+void FIRSTScheduler::RegisterBatch(FIRSTBatch *batch) {
+	if (batch == NULL)
+		return;
+	if (m_frozen) {
+		FIRSTEventLog::Log(FIRSTEventLog::kRegisterAfterFreeze, 0);
+		return;
+	}
+	m_batches.push_back(batch);
+}
+
+/**
+ * Does ahead of the first pass everything that would otherwise be done lazily during the
+ * first passes, and locks the configuration. Call it at the end of setup(), once all the
+ * subsystems and batches are created:
+ * <ul>
+ * <li> the default commands are initialized (see {@link Subsystem#InitDefaultCommand()}) </li>
+ * <li> the names of the default, running and pending commands are resolved </li>
+ * <li> the command lists get room for a command per subsystem, plus extraCommands </li>
+ * <li> the output stage is created (see {@link Outputs}) </li>
+ * <li> the perfect hash of the console is built (see {@link Console}) </li>
+ * </ul>
+ * Afterwards no subsystem or batch can be registered, and Run() does not allocate as long
+ * as no more commands run at once than there is room for. The names are to be read with
+ * GetCName() from then on: GetName() returns a copy, which allocates on the AVR.
+ * @param extraCommands how many commands that require no subsystem may run at once
+ */
+void FIRSTScheduler::Freeze(int extraCommands) {
+	unsigned long start = micros();
+
+	FIRSTCommand::SubsystemSet::iterator subsystemIter = m_subsystems.begin();
+	for (; subsystemIter != m_subsystems.end(); subsystemIter++) {
+		FIRSTCommand *command = (*subsystemIter)->GetDefaultCommand();
+		if (command != NULL)
+			command->GetCName();
+	}
+	CommandVector::iterator commandIter = m_commands.begin();
+	for (; commandIter != m_commands.end(); commandIter++) {
+		(*commandIter)->GetCName();
+	}
+	for (commandIter = m_additions.begin(); commandIter != m_additions.end(); commandIter++) {
+		(*commandIter)->GetCName();
+	}
+
+	int size = m_subsystems.size() + extraCommands;
+	m_commands.reserve(size);
+	m_disabledCommands.reserve(size);
+	m_additions.reserve(size);
+	GetOutputs();
+	if (m_console != NULL)
+		m_console->Build(this);
+
+	m_frozen = true;
+	m_freezeTime = micros() - start;
+}
+
+/**
+ * Returns whether the configuration is locked by Freeze().
+ * @return whether the scheduler is frozen
+ */
+bool FIRSTScheduler::IsFrozen() {
+	return m_frozen;
+}
+
+/**
+ * Returns how long Freeze() took, the startup time the first passes no longer pay.
+ * @return the duration of Freeze() (in microseconds)
+ */
+unsigned long FIRSTScheduler::GetFreezeTime() {
+	return m_freezeTime;
+}
+
 /**
  * Removes the {@link Command} from the {@link Scheduler}.
  * @param command the command to remove
  */
 void FIRSTScheduler::Remove(FIRSTCommand *command) {
 	if (command == NULL) {
-		//wpi_setWPIErrorWithContext(NullParameter, "command");
+		FIRSTEventLog::Log(FIRSTEventLog::kNullCommand, 0);
 		return;
 	}
 
 	if (!m_commands.erase(command))
 		return;
+	m_disabledCommands.erase(command);
 
-	FIRSTCommand::SubsystemSet requirements = command->GetRequirements();
+	const FIRSTCommand::SubsystemSet &requirements = command->GetRequirements();
 	FIRSTCommand::SubsystemSet::iterator iter = requirements.begin();
 	for (; iter != requirements.end(); iter++) {
 		FIRSTSubsystem *lock = *iter;
 		lock->SetCurrentCommand(NULL);
 	}
 
+	// Count how the command ended, if it ever ran
+	uint8_t reason = 0;
+	if (command->m_initialized) {
+		if (command->IsCanceled()) {
+			m_statistics.interrupted++;
+			reason = FIRSTCommand::kEndInterrupted;
+		}
+		else {
+			unsigned long time = Millis() - command->m_startTime;
+			if (command->IsTimedOut()) {
+				m_statistics.timedOut++;
+				reason = FIRSTCommand::kEndTimedOut;
+			}
+			else {
+				m_statistics.completed++;
+				reason = FIRSTCommand::kEndFinished;
+			}
+			m_statistics.totalTime += time;
+			if (time > m_statistics.maxTime)
+				m_statistics.maxTime = time;
+		}
+	}
+
 	command->Removed();
+
+	// The chained commands join the additions of this pass
+	if (reason != 0)
+		command->Complete(reason);
 }
 
 void FIRSTScheduler::RemoveAll() {
-	while (m_commands.size() > 0) {
+	while (!m_commands.empty()) {
 		Remove(*m_commands.begin());
 	}
 }
@@ -204,6 +832,9 @@ void FIRSTScheduler::ResetAll()
 	m_subsystems.clear();
 	m_additions.clear();
 	m_commands.clear();
+	m_disabledCommands.clear();
+	m_batches.clear();
+	m_frozen = false;
 }
 
 String FIRSTScheduler::GetName() {
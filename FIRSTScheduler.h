@@ -18,37 +18,108 @@
 
 class ButtonScheduler;
 class FIRSTSubsystem;
+class FIRSTTelemetry;
+class FIRSTBatch;
+class FIRSTLatency;
+class FIRSTConsole;
+class FIRSTOutputs;
 
 class FIRSTScheduler
 {
+	friend class FIRSTTelemetry;
+	friend class FIRSTConsole;
+	friend class FIRSTCommand;
 public:
+	typedef struct sStatistics {
+		unsigned long completed;
+		unsigned long timedOut;
+		unsigned long interrupted;
+		unsigned long totalTime;
+		unsigned long maxTime;
+	} Statistics;
+
+	FIRSTScheduler();
+	virtual ~FIRSTScheduler();
 	static FIRSTScheduler *GetInstance();
 
 	void AddCommand(FIRSTCommand* command);
 	void RegisterSubsystem(FIRSTSubsystem *subsystem);
+	void RegisterBatch(FIRSTBatch *batch);
+	void Freeze(int extraCommands = 0);
+	bool IsFrozen();
+	unsigned long GetFreezeTime();
 	void Run();
 	void Remove(FIRSTCommand *command);
 	void RemoveAll();
 	void ResetAll();
 	void SetEnabled(bool enabled);
+	void SetTelemetry(FIRSTTelemetry *telemetry);
+	void SetLatency(FIRSTLatency *latency);
+	void SetConsole(FIRSTConsole *console);
+	FIRSTOutputs *GetOutputs();
+	unsigned long GetLastRunTime();
+	unsigned long GetMaxRunTime();
+	void ResetMaxRunTime();
+	unsigned long GetPassTime();
+	unsigned long GetPassDelta();
+	void SetPassBudget(unsigned long budget, bool resetOnOverrun = false, unsigned long period = 0);
+	void SetCommandTiming(bool enabled);
+	unsigned long GetPassOverruns();
+	void SetVirtualClock(bool enabled);
+	void AdvanceClock(unsigned long micros);
+	unsigned long Micros();
+	unsigned long Millis();
+	const Statistics &GetStatistics();
+	void ResetStatistics();
 
 	String GetName();
 	String GetType();
 
 private:
-	FIRSTScheduler();
-	virtual ~FIRSTScheduler();
+	typedef AVector<FIRSTCommand *> CommandVector;
 
 	void ProcessCommandAddition(FIRSTCommand *command);
+	void UpdateRunWhenDisabled(FIRSTCommand *command);
+	void SampleSubsystems();
+	void FlushOutputs();
+	void RunCommands(CommandVector &commands, unsigned long start);
+	bool RunCommand(FIRSTCommand *command);
+	void RunBatches();
+	void RunDisabled(unsigned long start);
+	void CancelDisabledCommands();
+	void RecordRunTime(unsigned long start);
 
 	static FIRSTScheduler *_instance;
 	FIRSTCommand::SubsystemSet m_subsystems;
-	typedef AVector<FIRSTCommand *> CommandVector;
 	CommandVector m_additions;
 	CommandVector m_commands;
+	CommandVector m_disabledCommands;
+	AVector<FIRSTBatch *> m_batches;
 	bool m_adding;
 	bool m_enabled;
+	bool m_disabling;
 	bool m_runningCommandsChanged;
+	FIRSTTelemetry *m_telemetry;
+	FIRSTLatency *m_latency;
+	FIRSTConsole *m_console;
+	FIRSTOutputs *m_outputs;
+	unsigned long m_lastRunTime;
+	unsigned long m_maxRunTime;
+	bool m_hasPassStart;
+	unsigned long m_passStart;
+	unsigned long m_passDelta;
+	unsigned long m_passBudget;
+	unsigned long m_passOverruns;
+	bool m_resetOnOverrun;
+	bool m_timeCommands;
+	bool m_frozen;
+	unsigned long m_freezeTime;
+	int m_commandCounter;
+	bool m_virtualClock;
+	unsigned long m_clockMicros;
+	unsigned long m_clockMillis;
+	unsigned int m_clockRemainder;
+	Statistics m_statistics;
 };
 
 
@@ -0,0 +1,279 @@
+/*
+ * FIRSTStateMachine.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include "FIRSTStateMachine.h"
+
+/**
+ * Creates a state machine.
+ * @param machine the tables of the machine, in flash
+ * @param commands the commands the states refer to (or NULL if none do)
+ */
+FIRSTStateMachine::FIRSTStateMachine(const FIRSTMachine *machine, FIRSTCommand **commands)
+	: m_commands(commands)
+	, m_state(kNone)
+	, m_restartCount(0)
+	, m_skipCheck(false)
+	, m_finished(false)
+{
+	memcpy_P(&m_tables, machine, sizeof(m_tables));
+}
+
+/**
+ * Returns the innermost active state, for telemetry.
+ * @return the current state, or kNone if the machine is not running
+ */
+uint8_t FIRSTStateMachine::GetState()
+{
+	return m_state;
+}
+
+/**
+ * Returns whether the given state is active, being the current state or one of its
+ * parents.
+ * @param state the state
+ * @return whether the state is active
+ */
+bool FIRSTStateMachine::IsInState(uint8_t state)
+{
+	for (uint8_t s = m_state, depth = 0; s != kNone && depth < kMaxDepth; s = Parent(s), depth++)
+	{
+		if (s == state)
+			return true;
+	}
+	return false;
+}
+
+void FIRSTStateMachine::ReadState(uint8_t index, FIRSTState *state)
+{
+	memcpy_P(state, &m_tables.states[index], sizeof(FIRSTState));
+}
+
+uint8_t FIRSTStateMachine::Parent(uint8_t index)
+{
+	return pgm_read_byte(&m_tables.states[index].parent);
+}
+
+bool FIRSTStateMachine::Guard(uint8_t guard, const FIRSTState *state)
+{
+	if (guard == kAlways)
+		return true;
+	if (guard == kCommandDone)
+		return state->command == kNone
+				|| (!m_skipCheck && !IsRestarting(state->command)
+						&& !m_commands[state->command]->IsRunning());
+	FIRSTCondition condition = (FIRSTCondition)pgm_read_ptr(&m_tables.guards[guard]);
+	return condition();
+}
+
+void FIRSTStateMachine::Act(uint8_t action)
+{
+	if (action == kNone)
+		return;
+	FIRSTAction act = (FIRSTAction)pgm_read_ptr(&m_tables.actions[action]);
+	act();
+}
+
+void FIRSTStateMachine::Enter(uint8_t index)
+{
+	FIRSTState state;
+	ReadState(index, &state);
+	Act(state.entry);
+	if (state.command == kNone)
+		return;
+
+	// Starting a command that is still running would do nothing, see StartWaiting()
+	FIRSTCommand *command = m_commands[state.command];
+	if (!command->IsRunning())
+		command->Start();
+	else if (!IsRestarting(state.command) && m_restartCount < kMaxDepth)
+	{
+		m_restarts[m_restartCount].command = state.command;
+		m_restarts[m_restartCount].started = false;
+		m_restartCount++;
+	}
+}
+
+void FIRSTStateMachine::Leave(uint8_t index)
+{
+	FIRSTState state;
+	ReadState(index, &state);
+	if (state.command != kNone && !Forget(state.command))
+		m_commands[state.command]->Cancel();
+	Act(state.exit);
+}
+
+bool FIRSTStateMachine::IsRestarting(uint8_t command)
+{
+	for (uint8_t i = 0; i < m_restartCount; i++)
+	{
+		if (m_restarts[i].command == command)
+			return true;
+	}
+	return false;
+}
+
+/**
+ * Drops a command waiting to start again, its state being left.
+ * @return false if the command was not waiting, or was started already and has to be
+ * canceled
+ */
+bool FIRSTStateMachine::Forget(uint8_t command)
+{
+	for (uint8_t i = 0; i < m_restartCount; i++)
+	{
+		if (m_restarts[i].command == command)
+		{
+			bool started = m_restarts[i].started;
+			m_restarts[i] = m_restarts[--m_restartCount];
+			return !started;
+		}
+	}
+	return false;
+}
+
+/**
+ * Starts the commands waiting to start again once the scheduler removed them. Called at
+ * the end of Execute(), after the transitions, so a command started here is added at the
+ * end of the pass before its state can be left; it stops waiting on the next pass.
+ */
+void FIRSTStateMachine::StartWaiting()
+{
+	for (uint8_t i = 0; i < m_restartCount; i++)
+	{
+		FIRSTCommand *command = m_commands[m_restarts[i].command];
+		if (!m_restarts[i].started && !command->IsRunning())
+		{
+			command->Start();
+			m_restarts[i].started = true;
+		}
+	}
+}
+
+/**
+ * Leaves the active states, innermost first, up to the given one.
+ * @param ancestor the first state to stay in, kNone to leave them all
+ */
+void FIRSTStateMachine::ExitTo(uint8_t ancestor)
+{
+	for (uint8_t depth = 0; m_state != ancestor && m_state != kNone && depth < kMaxDepth; depth++)
+	{
+		Leave(m_state);
+		m_state = Parent(m_state);
+	}
+}
+
+void FIRSTStateMachine::Transition(uint8_t target, uint8_t action)
+{
+	// The innermost state enclosing the target that stays active; for a transition to
+	// the current state or one of its parents, that state is left and entered again
+	uint8_t common = Parent(target);
+	for (uint8_t depth = 0; common != kNone && !IsInState(common) && depth < kMaxDepth; depth++)
+		common = Parent(common);
+
+	ExitTo(common);
+	Act(action);
+
+	uint8_t path[kMaxDepth];
+	uint8_t length = 0;
+	for (uint8_t s = target; s != common && length < kMaxDepth; s = Parent(s))
+		path[length++] = s;
+	while (length > 0)
+		Enter(path[--length]);
+
+	m_state = target;
+	for (uint8_t depth = 0; depth < kMaxDepth; depth++)
+	{
+		uint8_t initial = pgm_read_byte(&m_tables.states[m_state].initial);
+		if (initial == kNone)
+			break;
+		Enter(initial);
+		m_state = initial;
+	}
+}
+
+void FIRSTStateMachine::Initialize()
+{
+	m_finished = false;
+	m_state = kNone;
+	m_restartCount = 0;
+	Transition(m_tables.initial, kNone);
+	// Commands started during this pass only begin running at its end
+	m_skipCheck = true;
+}
+
+void FIRSTStateMachine::Execute()
+{
+	if (m_finished)
+		return;
+
+	// The commands started again on the last pass were added at its end
+	for (uint8_t i = 0; i < m_restartCount;)
+	{
+		if (m_restarts[i].started)
+			m_restarts[i] = m_restarts[--m_restartCount];
+		else
+			i++;
+	}
+
+	// The guards of the current state come first, then those of its parents
+	FIRSTState state;
+	uint8_t target = kNone;
+	uint8_t action = kNone;
+	for (uint8_t s = m_state, depth = 0; s != kNone && depth < kMaxDepth; s = state.parent, depth++)
+	{
+		ReadState(s, &state);
+		for (uint8_t i = 0; i < state.transitionCount; i++)
+		{
+			FIRSTTransition transition;
+			memcpy_P(&transition, &m_tables.transitions[state.firstTransition + i], sizeof(transition));
+			if (Guard(transition.guard, &state))
+			{
+				target = transition.target;
+				action = transition.action;
+				break;
+			}
+		}
+		if (target != kNone)
+			break;
+	}
+	m_skipCheck = false;
+
+	if (target == kFinished)
+	{
+		ExitTo(kNone);
+		Act(action);
+		m_finished = true;
+		return;
+	}
+	if (target != kNone)
+		Transition(target, action);
+	else
+	{
+		// Staying, run the during actions from the outermost state in
+		uint8_t path[kMaxDepth];
+		uint8_t length = 0;
+		for (uint8_t s = m_state; s != kNone && length < kMaxDepth; s = Parent(s))
+			path[length++] = s;
+		while (length > 0)
+			Act(pgm_read_byte(&m_tables.states[path[--length]].during));
+	}
+	StartWaiting();
+}
+
+bool FIRSTStateMachine::IsFinished()
+{
+	return m_finished;
+}
+
+void FIRSTStateMachine::End()
+{
+}
+
+void FIRSTStateMachine::Interrupted()
+{
+	ExitTo(kNone);
+}
@@ -0,0 +1,127 @@
+/*
+ * FIRSTStateMachine.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef FIRSTSTATEMACHINE_H_
+#define FIRSTSTATEMACHINE_H_
+
+#include <Arduino.h>
+
+#include "FIRSTCommand.h"
+
+/**
+ * A state of a {@link StateMachine}. Actions, guards and commands are indexes in the
+ * tables of the machine, kNone (0xFF) for none.
+ */
+typedef struct sFIRSTState {
+	uint8_t parent;          // the enclosing state, or kNone for a top state
+	uint8_t initial;         // the child entered along with this state, or kNone
+	uint8_t entry;           // the action run when the state is entered
+	uint8_t during;          // the action run on every pass the state stays active
+	uint8_t exit;            // the action run when the state is left
+	uint8_t command;         // the command started on entry and canceled on exit
+	uint8_t firstTransition; // the index of the first transition of the state
+	uint8_t transitionCount; // how many transitions follow it
+} FIRSTState;
+
+/**
+ * A transition of a {@link StateMachine}, taken when its guard is true.
+ */
+typedef struct sFIRSTTransition {
+	uint8_t guard;           // a condition, kAlways, or kCommandDone for the state's command
+	uint8_t target;          // the state to go to, or kFinished to finish the command
+	uint8_t action;          // the action run between the exits and the entries, or kNone
+} FIRSTTransition;
+
+/**
+ * The tables of a {@link StateMachine}, all of them in flash.
+ */
+typedef struct sFIRSTMachine {
+	const FIRSTState *states;
+	const FIRSTTransition *transitions;
+	const FIRSTCondition *guards;
+	const FIRSTAction *actions;
+	uint8_t initial;
+} FIRSTMachine;
+
+/**
+ * Runs a hierarchical state machine declared as constant tables in flash, instead of
+ * phases hand coded as a switch in Execute():
+ *
+ *   static const FIRSTState states[] PROGMEM = {
+ *     // parent  initial  entry  during  exit   command  first  count
+ *     { kNone,   kNone,   kNone, kNone,  kNone, 0,       0,     1 },   // 0 home
+ *     { kNone,   2,       0,     kNone,  kNone, kNone,   1,     1 },   // 1 grab
+ *     { 1,       kNone,   kNone, 1,      kNone, 1,       2,     1 },   // 2 grab/approach
+ *     ...
+ *   };
+ *
+ * Each pass only the guards of the active states are evaluated, those of the current
+ * state first, then those of its parents, and the first one that is true is taken: the
+ * states up to the one enclosing both ends are exited, innermost first, then the states
+ * down to the target are entered, along with its initial children. Otherwise the
+ * during actions of the active states are run, outermost first.
+ *
+ * A state can own subsystems through a command of its own, started when the state is
+ * entered and canceled when it is left; the commands have their own requirements, which
+ * the state machine must not require itself, or starting them would interrupt it.
+ * A command canceled and started again by the same transition, that of a state entered
+ * again or shared by two states, is still running until the scheduler removes it: it is
+ * started again on the first pass after, and meanwhile does not count as done.
+ *
+ * A state machine keeps a copy of the pointers to its tables, its current state and the
+ * commands waiting to start again, about thirty bytes of RAM besides the command itself.
+ */
+class FIRSTStateMachine : public FIRSTCommand
+{
+public:
+	static const uint8_t kNone = 0xFF;
+	static const uint8_t kAlways = 0xFE;
+	static const uint8_t kCommandDone = 0xFD;
+	static const uint8_t kFinished = 0xFE;
+	static const uint8_t kMaxDepth = 8;
+
+	FIRSTStateMachine(const FIRSTMachine *machine, FIRSTCommand **commands = NULL);
+
+	uint8_t GetState();
+	bool IsInState(uint8_t state);
+
+protected:
+	virtual void Initialize();
+	virtual void Execute();
+	virtual bool IsFinished();
+	virtual void End();
+	virtual void Interrupted();
+
+private:
+	void ReadState(uint8_t index, FIRSTState *state);
+	uint8_t Parent(uint8_t index);
+	bool Guard(uint8_t guard, const FIRSTState *state);
+	void Act(uint8_t action);
+	void Enter(uint8_t index);
+	void Leave(uint8_t index);
+	void ExitTo(uint8_t ancestor);
+	void Transition(uint8_t target, uint8_t action);
+	bool IsRestarting(uint8_t command);
+	bool Forget(uint8_t command);
+	void StartWaiting();
+
+	typedef struct sRestart {
+		uint8_t command;
+		bool started;
+	} Restart;
+
+	FIRSTCommand **m_commands;
+	FIRSTMachine m_tables;
+	uint8_t m_state;
+	Restart m_restarts[kMaxDepth];
+	uint8_t m_restartCount;
+	bool m_skipCheck;
+	bool m_finished;
+};
+
+
+#endif /* FIRSTSTATEMACHINE_H_ */
@@ -15,18 +15,25 @@
 #include "FIRSTSubsystem.h"
 #include "FIRSTCommand.h"
 #include "FIRSTScheduler.h"
+#include "FIRSTEventLog.h"
+#include "FIRSTFilter.h"
 
 /**
  * Creates a subsystem with the given name
  * @param name the name of the subsystem
+ * @param scheduler the scheduler to register with, the default one if NULL
  */
-FIRSTSubsystem::FIRSTSubsystem(const char *name) :
+FIRSTSubsystem::FIRSTSubsystem(const char *name, FIRSTScheduler *scheduler) :
 	m_currentCommand(NULL),
 	m_defaultCommand(NULL),
-	m_initializedDefaultCommand(false)
+	m_initializedDefaultCommand(false),
+	m_sampleTime(0),
+	m_filters(NULL),
+	m_outputChanged(false)
 {
 	m_name = name;
-	FIRSTScheduler::GetInstance()->RegisterSubsystem(this);
+	m_scheduler = scheduler == NULL ? FIRSTScheduler::GetInstance() : scheduler;
+	m_scheduler->RegisterSubsystem(this);
 	m_currentCommandChanged = true;
 }
 /**
@@ -41,6 +48,84 @@ void FIRSTSubsystem::InitDefaultCommand() {
 
 }
 
+/**
+ * Called by the {@link Scheduler} once per pass, before any command is executed.
+ * This is the place to read the sensors of the subsystem into members, so that the
+ * commands read the cached values instead of the hardware. That way every sensor is read
+ * once per pass however many commands look at it, and all the commands see the same values.
+ *
+ * This should be overridden by a Subsystem that has sensors
+ */
+void FIRSTSubsystem::Periodic() {
+
+}
+
+/**
+ * Called by the {@link Scheduler} once per pass, after all the commands were executed and
+ * right before the staged outputs are committed.
+ * This is the place to send out what the commands asked of the subsystem during the pass,
+ * all at once.
+ *
+ * This should be overridden by a Subsystem that buffers its outputs
+ */
+void FIRSTSubsystem::Flush() {
+
+}
+
+/**
+ * Returns when the sensors of this subsystem were last sampled by Periodic().
+ * @return the time of the last sample (in microseconds, see {@link Scheduler#Micros()})
+ */
+unsigned long FIRSTSubsystem::GetSampleTime()
+{
+	return m_sampleTime;
+}
+
+/**
+ * Returns how old the values sampled by Periodic() are.
+ * @return the time since the last sample (in microseconds)
+ */
+unsigned long FIRSTSubsystem::GetSampleAge()
+{
+	return m_scheduler->Micros() - m_sampleTime;
+}
+
+/**
+ * Has the given filters updated every pass, right after Periodic() put the samples in
+ * (see {@link FilterChannel}). The filters are updated in the order they were added.
+ * @param filter the filters
+ */
+void FIRSTSubsystem::AddFilter(FIRSTFilterInput *filter)
+{
+	if (filter == NULL)
+		return;
+	FIRSTFilterInput **last = &m_filters;
+	while (*last != NULL)
+	{
+		if (*last == filter)
+			return;
+		last = &(*last)->m_nextInput;
+	}
+	*last = filter;
+}
+
+/**
+ * Tells the {@link Scheduler} that the subsystem puts out a new value this pass, so that
+ * the latency from the input its command acted on is recorded (see {@link Latency}).
+ * To be called when the value written to the hardware differs from the last one; only
+ * looked at while the scheduler has a Latency.
+ */
+void FIRSTSubsystem::OutputChanged()
+{
+	m_outputChanged = true;
+}
+
+void FIRSTSubsystem::UpdateFilters(int32_t dt)
+{
+	for (FIRSTFilterInput *filter = m_filters; filter != NULL; filter = filter->m_nextInput)
+		filter->Update(dt);
+}
+
 /**
  * Sets the default command.  If this is not called or is called with null,
  * then there will be no default command for the subsystem.
@@ -59,7 +144,7 @@ void FIRSTSubsystem::SetDefaultCommand(FIRSTCommand *command)
 	else
 	{
 		bool found = false;
-		FIRSTCommand::SubsystemSet requirements = command->GetRequirements();
+		const FIRSTCommand::SubsystemSet &requirements = command->GetRequirements();
 		FIRSTCommand::SubsystemSet::iterator iter = requirements.begin();
 		for (; iter != requirements.end(); iter++)
 		{
@@ -72,7 +157,7 @@ void FIRSTSubsystem::SetDefaultCommand(FIRSTCommand *command)
 
 		if (!found)
 		{
-			//wpi_setWPIErrorWithContext(CommandIllegalUse, "A default command must require the subsystem");
+			FIRSTEventLog::Log(FIRSTEventLog::kDefaultNotRequiring, command->GetID());
 			return;
 		}
 
@@ -112,6 +197,15 @@ FIRSTCommand *FIRSTSubsystem::GetCurrentCommand()
 	return m_currentCommand;
 }
 
+/**
+ * Returns the scheduler this subsystem is registered with.
+ * @return the scheduler of this subsystem
+ */
+FIRSTScheduler *FIRSTSubsystem::GetScheduler()
+{
+	return m_scheduler;
+}
+
 /**
  * Call this to alert Subsystem that the current command is actually the command.
  * Sometimes, the {@link Subsystem} is told that it has no command while the {@link Scheduler}
@@ -131,3 +225,12 @@ String FIRSTSubsystem::GetName()
 	return m_name;
 }
 
+/**
+ * Returns the name without the copy GetName() makes, which allocates on the AVR.
+ * @return the name, valid as long as the subsystem
+ */
+const char *FIRSTSubsystem::GetCName()
+{
+	return m_name.c_str();
+}
+
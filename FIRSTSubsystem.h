@@ -11,30 +11,45 @@
 #include <Arduino.h>
 
 class FIRSTCommand;
+class FIRSTScheduler;
+class FIRSTFilterInput;
 
 class FIRSTSubsystem {
     friend class FIRSTScheduler;
 public:
-    FIRSTSubsystem(const char *name);
+    FIRSTSubsystem(const char *name, FIRSTScheduler *scheduler = NULL);
     virtual ~FIRSTSubsystem() {}
 
     void SetDefaultCommand(FIRSTCommand *command);
     FIRSTCommand *GetDefaultCommand();
     void SetCurrentCommand(FIRSTCommand *command);
     FIRSTCommand *GetCurrentCommand();
+    FIRSTScheduler *GetScheduler();
     virtual void InitDefaultCommand();
+    virtual void Periodic();
+    virtual void Flush();
+    unsigned long GetSampleTime();
+    unsigned long GetSampleAge();
+    void AddFilter(FIRSTFilterInput *filter);
+    void OutputChanged();
 
 private:
     void ConfirmCommand();
+    void UpdateFilters(int32_t dt);
 
     FIRSTCommand *m_currentCommand;
     bool m_currentCommandChanged;
     FIRSTCommand *m_defaultCommand;
     String m_name;
     bool m_initializedDefaultCommand;
+    FIRSTScheduler *m_scheduler;
+    unsigned long m_sampleTime;
+    FIRSTFilterInput *m_filters;
+    bool m_outputChanged;
 
 public:
     virtual String GetName();
+    const char *GetCName();
 };
 
 
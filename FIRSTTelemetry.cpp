@@ -0,0 +1,343 @@
+/*
+ * FIRSTTelemetry.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include "FIRSTTelemetry.h"
+#include "FIRSTScheduler.h"
+#include "FIRSTSubsystem.h"
+#include "FIRSTEventLog.h"
+
+/**
+ * Creates a telemetry stream.
+ * @param port where to send the packets to, usually &Serial
+ * @param period the minimum time (in milliseconds) between two packets
+ */
+FIRSTTelemetry::FIRSTTelemetry(Print *port, unsigned long period)
+	: m_port(port)
+	, m_period(period)
+	, m_lastSent(0)
+	, m_commandsDirty(true)
+	, m_sequence(0)
+	, m_sinceKeyframe(0)
+	, m_dropped(0)
+	, m_roomKnown(false)
+	, m_truncated(false)
+	, m_valueCount(0)
+	, m_frameLength(0)
+	, m_head(0)
+	, m_tail(0)
+{
+	for (int i = 0; i < kMaxSubsystems; i++)
+		m_sentOwners[i] = 0;
+}
+
+FIRSTTelemetry::~FIRSTTelemetry()
+{
+}
+
+/**
+ * Registers a value to be streamed. Only the address is kept, the value is read
+ * each time a packet is built and only sent when it changed.
+ * @param id the ID the dashboard knows the value by
+ * @param value the address of the value
+ * @return false if there is no room for another value
+ */
+bool FIRSTTelemetry::AddValue(uint8_t id, const long *value)
+{
+	if (value == NULL || m_valueCount >= kMaxValues)
+		return false;
+
+	m_valueIDs[m_valueCount] = id;
+	m_values[m_valueCount] = value;
+	m_sentValues[m_valueCount] = 0;
+	m_valueCount++;
+	return true;
+}
+
+/**
+ * The telemetry stage of the {@link Scheduler}, called on every pass.
+ * Drains the TX ring and, once the period has passed, queues a packet with whatever
+ * changed since the last one.
+ * @param scheduler the scheduler to report on
+ * @param commandsChanged whether the set of running commands changed during this pass
+ */
+void FIRSTTelemetry::Update(FIRSTScheduler *scheduler, bool commandsChanged)
+{
+	m_commandsDirty |= commandsChanged;
+	Flush();
+
+	unsigned long now = scheduler->Millis();
+	if (now - m_lastSent < m_period)
+		return;
+	m_lastSent = now;
+
+	bool keyframe = m_sinceKeyframe == 0;
+	uint8_t flags = keyframe ? kKeyframe : 0;
+
+	// Take the owners and values that changed first, the counts go ahead of the pairs and
+	// what they take in the frame decides how many commands fit ahead of them
+	int owners[kMaxSubsystems];
+	long values[kMaxValues];
+	int changedOwners = 0;
+	int changedValues = 0;
+	int size = 0;
+	int subsystemCount = 0;
+	FIRSTCommand::SubsystemSet::iterator subsystemIter = scheduler->m_subsystems.begin();
+	for (; subsystemIter != scheduler->m_subsystems.end() && subsystemCount < kMaxSubsystems; subsystemIter++)
+	{
+		FIRSTCommand *owner = (*subsystemIter)->GetCurrentCommand();
+		int id = owner == NULL ? 0 : owner->GetID() + 1;
+		owners[subsystemCount] = id;
+		if (keyframe || id != m_sentOwners[subsystemCount])
+		{
+			changedOwners++;
+			size += VarintSize(subsystemCount) + VarintSize(id);
+		}
+		subsystemCount++;
+	}
+	if (subsystemIter != scheduler->m_subsystems.end() && !m_truncated)
+	{
+		m_truncated = true;
+		FIRSTEventLog::Log(FIRSTEventLog::kTelemetryTruncated, scheduler->m_subsystems.size());
+	}
+	for (int i = 0; i < m_valueCount; i++)
+	{
+		values[i] = *m_values[i];
+		long delta = values[i] - (keyframe ? 0 : m_sentValues[i]);
+		if (keyframe || delta != 0)
+		{
+			changedValues++;
+			size += 1 + VarintSize(Zigzag(delta));
+		}
+	}
+	if (changedOwners > 0)
+		size += VarintSize(changedOwners);
+	if (changedValues > 0)
+		size += VarintSize(changedValues);
+
+	m_frameLength = 0;
+	PutByte(0);
+	PutByte(m_sequence);
+	bool ok = true;
+
+	if (keyframe || m_commandsDirty)
+	{
+		// Send as many of the running commands as fit, the rest are only flagged
+		int room = kMaxFrame - m_frameLength - size - VarintSize(scheduler->m_commands.size());
+		int count = 0;
+		FIRSTScheduler::CommandVector::iterator iter = scheduler->m_commands.begin();
+		for (; iter != scheduler->m_commands.end(); iter++)
+		{
+			room -= VarintSize((*iter)->GetID());
+			if (room < 0)
+				break;
+			count++;
+		}
+		flags |= kCommands;
+		if (count < scheduler->m_commands.size())
+			flags |= kMoreCommands;
+		ok &= PutVarint(count);
+		iter = scheduler->m_commands.begin();
+		for (int i = 0; i < count; i++, iter++)
+			ok &= PutVarint((*iter)->GetID());
+	}
+
+	if (changedOwners > 0)
+	{
+		flags |= kOwners;
+		ok &= PutVarint(changedOwners);
+		for (int index = 0; index < subsystemCount; index++)
+		{
+			if (keyframe || owners[index] != m_sentOwners[index])
+			{
+				ok &= PutVarint(index);
+				ok &= PutVarint(owners[index]);
+			}
+		}
+	}
+
+	if (changedValues > 0)
+	{
+		flags |= kValues;
+		ok &= PutVarint(changedValues);
+		for (int i = 0; i < m_valueCount; i++)
+		{
+			long delta = values[i] - (keyframe ? 0 : m_sentValues[i]);
+			if (keyframe || delta != 0)
+			{
+				ok &= PutByte(m_valueIDs[i]);
+				ok &= PutVarint(Zigzag(delta));
+			}
+		}
+	}
+
+	// Nothing to tell
+	if (flags == 0)
+		return;
+
+	m_frame[0] = flags;
+	uint8_t encoded[kMaxFrame + kMaxFrame / 254 + 2];
+	int length = ok ? EncodeCOBS(m_frame, m_frameLength, encoded) : 0;
+	if (!ok || !Queue(encoded, length + 1))
+	{
+		// Nothing is remembered as sent, the next packet carries the changes again. A
+		// keyframe too big for a frame is not retried on every packet though.
+		m_dropped++;
+		if (!ok && keyframe)
+			m_sinceKeyframe++;
+		return;
+	}
+
+	for (int index = 0; index < subsystemCount; index++)
+		m_sentOwners[index] = owners[index];
+	for (int i = 0; i < m_valueCount; i++)
+		m_sentValues[i] = values[i];
+	m_commandsDirty = false;
+	m_sequence++;
+	if (++m_sinceKeyframe >= kKeyframeInterval)
+		m_sinceKeyframe = 0;
+}
+
+/**
+ * Writes as much of the TX ring to the port as it can take without blocking.
+ * A port that has never told a room above 0 is taken not to know it, as is the case of
+ * a Print that does not override availableForWrite(), and gets the whole ring.
+ */
+void FIRSTTelemetry::Flush()
+{
+	int room = m_port->availableForWrite();
+	if (room > 0)
+		m_roomKnown = true;
+	else if (!m_roomKnown)
+		room = kRingSize;
+	while (room > 0 && m_tail != m_head)
+	{
+		int length = (m_head > m_tail ? m_head : kRingSize) - m_tail;
+		if (length > room)
+			length = room;
+		m_port->write(m_ring + m_tail, length);
+		m_tail = (m_tail + length) % kRingSize;
+		room -= length;
+	}
+}
+
+/**
+ * Returns how many packets were dropped, either because they did not fit in a frame
+ * or because the TX ring was full.
+ * @return the number of dropped packets
+ */
+unsigned int FIRSTTelemetry::GetDroppedFrames()
+{
+	return m_dropped;
+}
+
+/**
+ * Consistent Overhead Byte Stuffing. Encodes the data so that it contains no zero bytes.
+ * The output needs room for length + length / 254 + 2 bytes, the last one being
+ * the zero delimiter which is not counted in the returned length.
+ * @param in the data to encode
+ * @param length the length of the data
+ * @param out the buffer to put the encoded data to
+ * @return the length of the encoded data without the delimiter
+ */
+int FIRSTTelemetry::EncodeCOBS(const uint8_t *in, int length, uint8_t *out)
+{
+	int code = 0;
+	int write = 1;
+	uint8_t distance = 1;
+
+	for (int read = 0; read < length; read++)
+	{
+		if (in[read] != 0)
+		{
+			out[write++] = in[read];
+			distance++;
+		}
+		if (in[read] == 0 || distance == 0xFF)
+		{
+			out[code] = distance;
+			code = write++;
+			distance = 1;
+		}
+	}
+	out[code] = distance;
+	out[write] = 0;
+	return write;
+}
+
+/**
+ * Decodes COBS encoded data, without its zero delimiter. The data can be decoded in
+ * place, the output being shorter than the input.
+ * @param in the encoded data
+ * @param length the length of the encoded data
+ * @param out the buffer to put the decoded data to, length bytes at most
+ * @return the length of the decoded data, or -1 if the data is not valid COBS
+ */
+int FIRSTTelemetry::DecodeCOBS(const uint8_t *in, int length, uint8_t *out)
+{
+	int read = 0;
+	int write = 0;
+
+	while (read < length)
+	{
+		uint8_t code = in[read++];
+		if (code == 0 || read + code - 1 > length)
+			return -1;
+		for (uint8_t i = 1; i < code; i++)
+			out[write++] = in[read++];
+		// A full group is not followed by a zero, nor is the last one
+		if (code != 0xFF && read < length)
+			out[write++] = 0;
+	}
+	return write;
+}
+
+int FIRSTTelemetry::VarintSize(unsigned long value)
+{
+	int size = 1;
+	for (; value >= 0x80; value >>= 7)
+		size++;
+	return size;
+}
+
+unsigned long FIRSTTelemetry::Zigzag(long value)
+{
+	return value < 0 ? ((unsigned long)~value << 1) | 1 : (unsigned long)value << 1;
+}
+
+bool FIRSTTelemetry::PutByte(uint8_t value)
+{
+	if (m_frameLength >= kMaxFrame)
+		return false;
+	m_frame[m_frameLength++] = value;
+	return true;
+}
+
+bool FIRSTTelemetry::PutVarint(unsigned long value)
+{
+	while (value >= 0x80)
+	{
+		if (!PutByte((value & 0x7F) | 0x80))
+			return false;
+		value >>= 7;
+	}
+	return PutByte(value);
+}
+
+bool FIRSTTelemetry::Queue(const uint8_t *data, int length)
+{
+	int used = (m_head - m_tail + kRingSize) % kRingSize;
+	if (length > kRingSize - 1 - used)
+		return false;
+
+	for (int i = 0; i < length; i++)
+	{
+		m_ring[m_head] = data[i];
+		m_head = (m_head + 1) % kRingSize;
+	}
+	Flush();
+	return true;
+}
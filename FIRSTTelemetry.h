@@ -0,0 +1,102 @@
+/*
+ * FIRSTTelemetry.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef FIRSTTELEMETRY_H_
+#define FIRSTTELEMETRY_H_
+
+#include <Arduino.h>
+
+class FIRSTScheduler;
+
+/**
+ * Streams the state of the {@link Scheduler} to a dashboard as compact binary packets.
+ *
+ * Every packet is COBS encoded and terminated by a zero byte. Decoded, it is:
+ * <pre>
+ *   flags    (1 byte)  kKeyframe, kCommands, kMoreCommands, kOwners, kValues
+ *   sequence (1 byte)
+ *   [kCommands] count, then the ID of each running command, kMoreCommands if not all fit
+ *   [kOwners]   count, then (subsystem index, command ID + 1 or 0 if none) pairs
+ *   [kValues]   count, then (value ID byte, zigzag delta from the last sent value) pairs
+ * </pre>
+ * All the numbers but the flags, sequence and value IDs are unsigned LEB128 varints.
+ * Only the sections that changed are sent. A keyframe repeats everything, with the
+ * values sent as deltas from zero, so that a decoder can (re)synchronize.
+ *
+ * A frame has room for the owners of kMaxSubsystems subsystems and kMaxValues values,
+ * with command IDs below 16383; the running commands only get what is left of it. A
+ * keyframe that does not fit all the same is dropped, and the next one is due
+ * kKeyframeInterval packets later.
+ *
+ * Packets go through a fixed TX ring that is drained only as fast as the port accepts
+ * bytes without blocking. A packet that does not fit in the ring is dropped, and its
+ * changes go with the next one. Only the first kMaxSubsystems subsystems are reported,
+ * the scheduler having more is logged once (see {@link EventLog}).
+ *
+ * extras/tools/TelemetryDecoder prints the packets read from a file or a serial port.
+ */
+class FIRSTTelemetry
+{
+public:
+	enum {
+		kKeyframe = 0x80,
+		kCommands = 0x01,
+		kOwners = 0x02,
+		kValues = 0x04,
+		kMoreCommands = 0x08
+	};
+	static const int kMaxValues = 8;
+	static const int kMaxSubsystems = 16;
+	static const int kMaxFrame = 128;
+	static const int kRingSize = 192;
+	static const int kKeyframeInterval = 50;
+
+	FIRSTTelemetry(Print *port, unsigned long period = 100);
+	virtual ~FIRSTTelemetry();
+
+	bool AddValue(uint8_t id, const long *value);
+	void Update(FIRSTScheduler *scheduler, bool commandsChanged);
+	void Flush();
+	unsigned int GetDroppedFrames();
+
+	static int EncodeCOBS(const uint8_t *in, int length, uint8_t *out);
+	static int DecodeCOBS(const uint8_t *in, int length, uint8_t *out);
+
+private:
+	bool PutVarint(unsigned long value);
+	bool PutByte(uint8_t value);
+	bool Queue(const uint8_t *data, int length);
+	static int VarintSize(unsigned long value);
+	static unsigned long Zigzag(long value);
+
+	Print *m_port;
+	unsigned long m_period;
+	unsigned long m_lastSent;
+	bool m_commandsDirty;
+	uint8_t m_sequence;
+	uint8_t m_sinceKeyframe;
+	unsigned int m_dropped;
+	bool m_roomKnown;
+	bool m_truncated;
+
+	uint8_t m_valueIDs[kMaxValues];
+	const long *m_values[kMaxValues];
+	long m_sentValues[kMaxValues];
+	uint8_t m_valueCount;
+
+	int m_sentOwners[kMaxSubsystems];
+
+	uint8_t m_frame[kMaxFrame];
+	int m_frameLength;
+
+	uint8_t m_ring[kRingSize];
+	int m_head;
+	int m_tail;
+};
+
+
+#endif /* FIRSTTELEMETRY_H_ */
@@ -0,0 +1,107 @@
+/*
+ * FIRSTBatchBlink.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+
+#include <Arduino.h>
+
+#include "FIRSTCommand.h"
+#include "FIRSTScheduler.h"
+#include "FIRSTSubsystem.h"
+#include "FIRSTOutputs.h"
+#include "FIRSTBatch.h"
+
+#define LED_COUNT 10
+
+
+class LEDSubsystem : public FIRSTSubsystem {
+public:
+  LEDSubsystem(int port, const char *name) : FIRSTSubsystem(name), m_port(port) {};
+  int getPort() { return m_port; };
+private:
+  int m_port;
+};
+
+
+// One Blink per LED, all blinking with one loop per pass
+class BlinkBatch : public FIRSTBatch {
+public:
+  BlinkBatch() : FIRSTBatch(LED_COUNT) {};
+  void setup(int slot, uint8_t pin, uint16_t period) { m_pin[slot] = pin; m_period[slot] = period; };
+protected:
+  void Initialize(uint16_t slot);
+  void Execute(const uint8_t *active, uint16_t count);
+private:
+  uint8_t m_pin[LED_COUNT];
+  uint16_t m_period[LED_COUNT];
+  uint16_t m_elapsed[LED_COUNT];
+  uint8_t m_on[LED_COUNT];
+};
+
+void BlinkBatch::Initialize(uint16_t slot)
+{
+  m_elapsed[slot] = 0;
+  m_on[slot] = HIGH;
+  GetScheduler()->GetOutputs()->Stage(m_pin[slot], HIGH);
+}
+
+void BlinkBatch::Execute(const uint8_t *active, uint16_t count)
+{
+  uint16_t dt = GetScheduler()->GetPassDelta() / 1000;
+  for (uint16_t i = 0; i < count; i++) {
+    m_elapsed[i] += dt * active[i];
+  }
+  for (uint16_t i = 0; i < count; i++) {
+    if (m_elapsed[i] >= m_period[i]) {
+      m_elapsed[i] -= m_period[i];
+      m_on[i] = !m_on[i];
+      GetScheduler()->GetOutputs()->Stage(m_pin[i], m_on[i]);
+    }
+  }
+}
+
+
+class Blink : public FIRSTBatchMember {
+public:
+  Blink(BlinkBatch *batch, LEDSubsystem *led, uint16_t period)
+    : FIRSTBatchMember(batch)
+  {
+    Requires(led);
+    batch->setup(GetSlot(), led->getPort(), period);
+  };
+};
+
+
+BlinkBatch *blinks;
+LEDSubsystem *leds[LED_COUNT];
+unsigned long lastReport;
+
+void setup() {
+  Serial.begin(115200);
+  blinks = new BlinkBatch();
+  for (int i = 0; i < LED_COUNT; i++) {
+    leds[i] = new LEDSubsystem(2 + i, "LED");
+    pinMode(2 + i, OUTPUT);
+    leds[i]->SetDefaultCommand(new Blink(blinks, leds[i], 200 * (i + 1)));
+  }
+  // No lazy setup left for the first passes, and no allocation in Run() from now on
+  FIRSTScheduler::GetInstance()->Freeze();
+  Serial.print("Freeze (us): ");
+  Serial.println(FIRSTScheduler::GetInstance()->GetFreezeTime());
+}
+
+void loop() {
+  FIRSTScheduler::GetInstance()->Run();
+  if (millis() - lastReport > 5000) {
+    lastReport = millis();
+    // The cost of a pass for this many blinking LEDs
+    Serial.print(LED_COUNT);
+    Serial.print(" LEDs, worst pass (us): ");
+    Serial.println(FIRSTScheduler::GetInstance()->GetMaxRunTime());
+    FIRSTScheduler::GetInstance()->ResetMaxRunTime();
+  }
+  delay(20);
+}
@@ -12,34 +12,68 @@
 #include "FIRSTScheduler.h"
 #include "FIRSTSubsystem.h"
 #include "FIRSTTimer.h"
+#include "FIRSTOutputs.h"
+#include "FIRSTParameters.h"
+#include "FIRSTConsole.h"
+#include "FIRSTChannel.h"
+
+// The tunables live in the first banks of the EEPROM
+FIRSTParameters parameters(0);
+
+// A push button from pin 2 to ground: a press flips the LED right away
+#define BUTTON_PIN 2
+// The times of the presses, from the interrupt handler to the LED subsystem
+FIRSTRing<unsigned long, 8> presses;
+
+void onPress() {
+  presses.Push(micros());
+}
 
 
 class LEDSubsystem : public FIRSTSubsystem {
 public:
   LEDSubsystem(int port, const char *name);
   ~LEDSubsystem();
-  void setColor(int color) { /*digitalWrite(m_port, color);*/ m_on = (color > 0);};
+  void setColor(int color) { GetScheduler()->GetOutputs()->Stage(m_port, color); m_on = (color > 0);};
   void flipColor() {setColor(m_on ? LOW : HIGH);};
+  bool takePress() { bool pressed = m_pressed; m_pressed = false; return pressed; };
+  void Periodic();
 private:
   int m_port;
   bool m_on;
+  bool m_pressed;
+  unsigned long m_lastPress;
 };
 
 LEDSubsystem::LEDSubsystem(int port, const char *name)
   : FIRSTSubsystem(name)
   , m_port(port)
   , m_on(false)
+  , m_pressed(false)
+  , m_lastPress(0)
 {
-  //pinMode(m_port, OUTPUT);
+  pinMode(m_port, OUTPUT);
 }
 LEDSubsystem::~LEDSubsystem(){}
 
+void LEDSubsystem::Periodic()
+{
+  unsigned long time;
+  while (presses.Pop(&time)) {
+    // A button bounces for a few milliseconds, only the first edge is a press
+    if (time - m_lastPress > 50000UL)
+      m_pressed = true;
+    m_lastPress = time;
+  }
+}
+
 
 
 class Blink : public FIRSTCommand {
 private:
   FIRSTTimer m_timer;
   LEDSubsystem *m_led;
+  const long *m_period;
 public:
 	Blink(LEDSubsystem *LED);
 	void Initialize();
@@ -52,6 +86,7 @@ public:
 Blink::Blink(LEDSubsystem *led)
 {
   m_led = led;
+  m_period = parameters.Declare("blink_ms", 1600);
   Requires(led);
 }
 
@@ -64,7 +99,7 @@ void Blink::Initialize()
 
 void Blink::Execute()
 {
-  if(m_timer.Get() > 1.6) {
+  if(m_led->takePress() || m_timer.Get() * 1000 > *m_period) {
     m_timer.Reset();
     m_timer.Start();
     m_led->flipColor();
@@ -78,12 +113,20 @@ void Blink::Interrupted() { End(); }
 
 LEDSubsystem *testLED;
 Blink *Blinker;
+FIRSTConsole *console;
 
 void setup() {
   // put your setup code here, to run once:
-  testLED = new LEDSubsystem(12, "Test LED");
+  Serial.begin(115200);
+  testLED = new LEDSubsystem(12, "TestLED");
   Blinker = new Blink(testLED);
   testLED->SetDefaultCommand(Blinker);
+  pinMode(BUTTON_PIN, INPUT_PULLUP);
+  attachInterrupt(digitalPinToInterrupt(BUTTON_PIN), onPress, FALLING);
+  // "param blink_ms 400" over Serial changes the period, and it sticks
+  console = new FIRSTConsole(&Serial);
+  console->SetParameters(&parameters);
+  FIRSTScheduler::GetInstance()->SetConsole(console);
 }
 
 void loop() {
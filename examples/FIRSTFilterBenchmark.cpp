@@ -0,0 +1,118 @@
+/*
+ * FIRSTFilterBenchmark.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+
+#include <Arduino.h>
+
+#include "FIRSTScheduler.h"
+#include "FIRSTSubsystem.h"
+#include "FIRSTFilter.h"
+
+#define SAMPLES 2000
+#define CHANNELS 8
+// The noise is drawn beforehand, into a table small enough for the RAM of an Uno
+#define NOISE 128
+
+
+// A noisy reading, the same sequence on every run
+int16_t noise[NOISE];
+void makeNoise() {
+  uint16_t state = 1;
+  for (int i = 0; i < NOISE; i++) {
+    state ^= state << 7;
+    state ^= state >> 9;
+    state ^= state << 8;
+    noise[i] = 512 + (state & 0x3F);
+  }
+}
+
+volatile int32_t sink;
+
+void report(const char *name, unsigned long samples, unsigned long elapsed) {
+  Serial.print(name);
+  Serial.print(": ");
+  // In 64 bits, samples * 10^6 overflows 32
+  Serial.print((unsigned long)((uint64_t)samples * 1000000ULL / (elapsed == 0 ? 1 : elapsed)));
+  Serial.println(" samples/s");
+}
+
+void benchmark(const char *name, FIRSTFilter *filter) {
+  int32_t dt = FIRSTFixed::FromMicros(20000);
+  unsigned long start = micros();
+  for (int i = 0; i < SAMPLES; i++) {
+    sink = filter->Filter(noise[i % NOISE], dt);
+  }
+  report(name, SAMPLES, micros() - start);
+}
+
+template<class Bank> void benchmarkBank(const char *name, Bank *bank) {
+  int32_t dt = FIRSTFixed::FromMicros(20000);
+  unsigned long start = micros();
+  for (int i = 0; i < SAMPLES; i++) {
+    int32_t *inputs = bank->GetInputs();
+    for (int c = 0; c < CHANNELS; c++) {
+      inputs[c] = noise[(i * CHANNELS + c) % NOISE];
+    }
+    bank->Update(dt);
+    sink = bank->Get(0);
+  }
+  report(name, (unsigned long)SAMPLES * CHANNELS, micros() - start);
+}
+
+
+// A distance sensor, its readings filtered once per pass by the scheduler
+class RangeSubsystem : public FIRSTSubsystem {
+public:
+  RangeSubsystem() : FIRSTSubsystem("Range"), m_smoothing(FIRSTFixed::kOne / 4), m_range(this) {
+    m_range.Add(&m_median);
+    m_range.Add(&m_smoothing);
+  };
+  void Periodic() { m_range.Put(analogRead(A0)); };
+  int32_t getRange() { return m_range.Get(); };
+private:
+  FIRSTMedianFilter<5> m_median;
+  FIRSTExponentialFilter m_smoothing;
+  FIRSTFilterChannel m_range;
+};
+
+
+RangeSubsystem *range;
+unsigned long lastReport;
+
+void setup() {
+  Serial.begin(115200);
+
+  // The cost of each filter alone
+  makeNoise();
+  FIRSTMovingAverage<8> average;
+  FIRSTMedianFilter<5> median;
+  FIRSTExponentialFilter smoothing(FIRSTFixed::kOne / 8);
+  FIRSTDebounceFilter debounce(3);
+  FIRSTDerivativeFilter derivative;
+  benchmark("Moving average of 8", &average);
+  benchmark("Median of 5", &median);
+  benchmark("Exponential", &smoothing);
+  benchmark("Debounce of 3", &debounce);
+  benchmark("Derivative", &derivative);
+
+  FIRSTAverageBank<CHANNELS, 8> averages;
+  FIRSTSmoothingBank<CHANNELS> smoothings(3);
+  benchmarkBank("Average bank of 8", &averages);
+  benchmarkBank("Smoothing bank", &smoothings);
+
+  range = new RangeSubsystem();
+}
+
+void loop() {
+  FIRSTScheduler::GetInstance()->Run();
+  if (millis() - lastReport > 1000) {
+    lastReport = millis();
+    Serial.print("Range: ");
+    Serial.println(range->getRange());
+  }
+  delay(20);
+}
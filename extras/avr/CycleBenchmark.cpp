@@ -0,0 +1,149 @@
+/*
+ * CycleBenchmark.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include <Arduino.h>
+#include <avr/sleep.h>
+
+#include "FIRSTCommand.h"
+#include "FIRSTScheduler.h"
+#include "FIRSTSubsystem.h"
+#include "FIRSTTimer.h"
+
+/*
+ * Counts the CPU cycles of a scheduler pass, of a command dispatch, of FIRSTTimer::Get()
+ * and of Command::IsTimedOut() with Timer1 running at the CPU clock, and prints them to
+ * the simavr console (GPIOR0). Under simavr the cycles are exact; on a board the same
+ * numbers come out of Serial instead.
+ */
+
+#if defined(HAVE_SIMAVR_SECTION)
+#include <avr_mcu_section.h>
+AVR_MCU(F_CPU, "atmega328p");
+AVR_MCU_SIMAVR_CONSOLE(&GPIOR0);
+#endif
+
+#define REPEAT 64
+#define COMMANDS 8
+
+class ConsolePrint : public Print
+{
+public:
+	virtual size_t write(uint8_t value) {
+#if defined(HAVE_SIMAVR_SECTION)
+		GPIOR0 = value;
+#else
+		Serial.write(value);
+#endif
+		return 1;
+	}
+	using Print::write;
+};
+
+static ConsolePrint console;
+static volatile uint16_t overflows;
+
+ISR(TIMER1_OVF_vect)
+{
+	overflows++;
+}
+
+// The cycles since Timer1 started, an overflow pending but not yet counted included
+static uint32_t cycles()
+{
+	uint8_t oldSREG = SREG;
+	cli();
+	uint16_t count = TCNT1;
+	uint16_t high = overflows;
+	if ((TIFR1 & _BV(TOV1)) && count < 0x8000)
+		high++;
+	SREG = oldSREG;
+	return ((uint32_t)high << 16) | count;
+}
+
+class BenchmarkSubsystem : public FIRSTSubsystem
+{
+public:
+	BenchmarkSubsystem(FIRSTScheduler *scheduler) : FIRSTSubsystem("Benchmark", scheduler) {}
+};
+
+class BenchmarkCommand : public FIRSTCommand
+{
+public:
+	BenchmarkCommand(double timeout) : FIRSTCommand("Benchmark", timeout) {}
+	bool TimedOut() { return IsTimedOut(); }
+
+protected:
+	virtual void Initialize() {}
+	virtual void Execute() {}
+	virtual bool IsFinished() { return false; }
+	virtual void End() {}
+	virtual void Interrupted() {}
+};
+
+static uint32_t overhead;
+
+// The cycles one of the REPEAT calls of the expression takes
+#define MEASURE(expression) ({ \
+		uint32_t start = cycles(); \
+		for (uint8_t i = 0; i < REPEAT; i++) { expression; } \
+		(cycles() - start - overhead) / REPEAT; })
+
+static void report(const char *name, uint32_t value)
+{
+	console.print(name);
+	console.print(": ");
+	console.print(value);
+	console.println(" cycles");
+}
+
+static volatile double sinkDouble;
+static volatile bool sinkBool;
+
+void setup()
+{
+#if !defined(HAVE_SIMAVR_SECTION)
+	Serial.begin(115200);
+#endif
+	// Timer1 free running at the CPU clock
+	TCCR1A = 0;
+	TCCR1B = _BV(CS10);
+	TIMSK1 = _BV(TOIE1);
+	overhead = 0;
+	overhead = MEASURE(asm volatile(""));
+
+	FIRSTScheduler *scheduler = FIRSTScheduler::GetInstance();
+	BenchmarkSubsystem subsystem(scheduler);
+	scheduler->Freeze(COMMANDS);
+	uint32_t empty = MEASURE(scheduler->Run());
+	report("Run() pass, 1 subsystem, no command", empty);
+
+	BenchmarkCommand *commands[COMMANDS];
+	for (uint8_t i = 0; i < COMMANDS; i++)
+	{
+		commands[i] = new BenchmarkCommand(10.0);
+		commands[i]->Start();
+	}
+	scheduler->Run();
+	uint32_t full = MEASURE(scheduler->Run());
+	report("Run() pass, 8 commands", full);
+	report("Command dispatch", (full - empty) / COMMANDS);
+
+	FIRSTTimer timer;
+	timer.Start();
+	report("FIRSTTimer::Get()", MEASURE(sinkDouble = timer.Get()));
+	report("IsTimedOut()", MEASURE(sinkBool = commands[0]->TimedOut()));
+
+	// simavr quits on sleeping with the interrupts off
+	cli();
+	set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+	sleep_enable();
+	sleep_cpu();
+}
+
+void loop()
+{
+}
@@ -0,0 +1,39 @@
+/*
+ * Arduino.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include <Arduino.h>
+
+#include <chrono>
+#include <thread>
+
+int hostPins[64];
+void (*hostInterrupts[64])();
+HardwareSerial Serial;
+
+static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+unsigned long micros()
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(
+			std::chrono::steady_clock::now() - start).count();
+}
+
+unsigned long millis()
+{
+	return std::chrono::duration_cast<std::chrono::milliseconds>(
+			std::chrono::steady_clock::now() - start).count();
+}
+
+void delay(unsigned long ms)
+{
+	std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void delayMicroseconds(unsigned int us)
+{
+	std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
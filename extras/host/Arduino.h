@@ -0,0 +1,149 @@
+/*
+ * Arduino.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef HOST_ARDUINO_H_
+#define HOST_ARDUINO_H_
+
+/*
+ * The part of the Arduino core the library uses, for building it on a host: the tests
+ * and the tools under extras/ (see the CMakeLists.txt at the top). Not the AVR, so the
+ * library takes its portable paths. The time is that of the host's monotonic clock;
+ * the pins are an array.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <string>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 0x1
+#define LOW 0x0
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+#define NUM_DIGITAL_PINS 20
+#define A0 14
+
+#define PROGMEM
+#define F(string) (string)
+#define pgm_read_byte(address) (*(const uint8_t *)(address))
+#define pgm_read_word(address) (*(const uint16_t *)(address))
+#define pgm_read_dword(address) (*(const uint32_t *)(address))
+#define pgm_read_ptr(address) (*(void * const *)(address))
+#define memcpy_P memcpy
+#define strcmp_P strcmp
+
+#define noInterrupts()
+#define interrupts()
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+extern int hostPins[64];
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t pin, uint8_t value) { hostPins[pin] = value; }
+inline int digitalRead(uint8_t pin) { return hostPins[pin]; }
+inline int analogRead(uint8_t pin) { return hostPins[pin]; }
+inline void analogWrite(uint8_t pin, int value) { hostPins[pin] = value; }
+
+// The handlers are only kept, a test calls them to play an interrupt
+extern void (*hostInterrupts[64])();
+inline uint8_t digitalPinToInterrupt(uint8_t pin) { return pin; }
+inline void attachInterrupt(uint8_t interrupt, void (*handler)(), int) { hostInterrupts[interrupt] = handler; }
+inline void detachInterrupt(uint8_t interrupt) { hostInterrupts[interrupt] = NULL; }
+
+class String
+{
+public:
+	String() {}
+	String(const char *s) : m_s(s == NULL ? "" : s) {}
+	String(int value) : m_s(std::to_string(value)) {}
+	String(unsigned int value) : m_s(std::to_string(value)) {}
+	String(long value) : m_s(std::to_string(value)) {}
+	String(unsigned long value) : m_s(std::to_string(value)) {}
+	unsigned int length() const { return m_s.size(); }
+	const char *c_str() const { return m_s.c_str(); }
+	String operator+(const String &other) const { String s; s.m_s = m_s + other.m_s; return s; }
+	bool operator==(const String &other) const { return m_s == other.m_s; }
+	bool operator!=(const String &other) const { return m_s != other.m_s; }
+
+private:
+	std::string m_s;
+};
+
+class Print
+{
+public:
+	virtual ~Print() {}
+	virtual size_t write(uint8_t value) = 0;
+	virtual size_t write(const uint8_t *buffer, size_t size) {
+		size_t n = 0;
+		while (size-- > 0)
+			n += write(*buffer++);
+		return n;
+	}
+	// As in the core: 0 unless the port knows better
+	virtual int availableForWrite() { return 0; }
+	size_t write(const char *s) { return write((const uint8_t *)s, strlen(s)); }
+
+	size_t print(const char *s) { return write(s); }
+	size_t print(const String &s) { return write(s.c_str()); }
+	size_t print(char c) { return write((uint8_t)c); }
+	size_t print(long value) { char b[24]; snprintf(b, sizeof(b), "%ld", value); return write(b); }
+	size_t print(unsigned long value) { char b[24]; snprintf(b, sizeof(b), "%lu", value); return write(b); }
+	size_t print(int value) { return print((long)value); }
+	size_t print(unsigned int value) { return print((unsigned long)value); }
+	size_t print(double value) { char b[32]; snprintf(b, sizeof(b), "%.2f", value); return write(b); }
+	size_t println() { return write("\r\n"); }
+	template<typename T> size_t println(T value) { size_t n = print(value); return n + println(); }
+};
+
+class Stream : public Print
+{
+public:
+	virtual int available() = 0;
+	virtual int read() = 0;
+	virtual int peek() = 0;
+};
+
+/**
+ * The serial port: what is written goes to the standard output, what is read comes from
+ * Input, filled by the test.
+ */
+class HardwareSerial : public Stream
+{
+public:
+	std::string Input;
+
+	void begin(unsigned long) {}
+	virtual size_t write(uint8_t value) { return fwrite(&value, 1, 1, stdout); }
+	using Print::write;
+	virtual int availableForWrite() { return 63; }
+	virtual int available() { return Input.size(); }
+	virtual int read() {
+		if (Input.empty())
+			return -1;
+		int c = (uint8_t)Input[0];
+		Input.erase(0, 1);
+		return c;
+	}
+	virtual int peek() { return Input.empty() ? -1 : (uint8_t)Input[0]; }
+};
+
+extern HardwareSerial Serial;
+
+#endif /* HOST_ARDUINO_H_ */
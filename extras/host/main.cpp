@@ -0,0 +1,25 @@
+/*
+ * main.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include <Arduino.h>
+
+/*
+ * Runs a sketch on the host: setup(), then loop() as many times as the first argument
+ * says, 10 by default.
+ */
+
+void setup();
+void loop();
+
+int main(int argc, char **argv)
+{
+	long loops = argc > 1 ? atol(argv[1]) : 10;
+	setup();
+	for (long i = 0; i < loops; i++)
+		loop();
+	return 0;
+}
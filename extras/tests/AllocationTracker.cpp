@@ -0,0 +1,63 @@
+/*
+ * AllocationTracker.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include "AllocationTracker.h"
+
+#include <atomic>
+#include <new>
+#include <stdlib.h>
+
+static std::atomic<unsigned long> allocations(0);
+static std::atomic<long> liveBlocks(0);
+
+unsigned long AllocationTracker::GetAllocations()
+{
+	return allocations;
+}
+
+long AllocationTracker::GetLiveBlocks()
+{
+	return liveBlocks;
+}
+
+void *operator new(size_t size)
+{
+	void *p = malloc(size == 0 ? 1 : size);
+	if (p == NULL)
+		throw std::bad_alloc();
+	allocations++;
+	liveBlocks++;
+	return p;
+}
+
+void *operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete(void *p) noexcept
+{
+	if (p == NULL)
+		return;
+	liveBlocks--;
+	free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+	operator delete(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+	operator delete(p);
+}
+
+void operator delete[](void *p, size_t) noexcept
+{
+	operator delete(p);
+}
@@ -0,0 +1,25 @@
+/*
+ * AllocationTracker.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef ALLOCATIONTRACKER_H_
+#define ALLOCATIONTRACKER_H_
+
+#include <stddef.h>
+
+/**
+ * Counts the calls to the global operator new and delete of the test it is linked into,
+ * for telling whether a pass allocates and whether memory leaks.
+ */
+namespace AllocationTracker
+{
+	/** The number of allocations since the start. */
+	unsigned long GetAllocations();
+	/** The number of blocks allocated and not yet freed. */
+	long GetLiveBlocks();
+}
+
+#endif /* ALLOCATIONTRACKER_H_ */
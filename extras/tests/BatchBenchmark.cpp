@@ -0,0 +1,217 @@
+/*
+ * BatchBenchmark.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include <Arduino.h>
+
+#include <chrono>
+#include <vector>
+
+#include "FIRSTCommand.h"
+#include "FIRSTScheduler.h"
+#include "FIRSTSubsystem.h"
+#include "FIRSTBatch.h"
+#include "Check.h"
+
+/*
+ * Measures the cost per instance of the same work done by 10, 100 and 1000 ordinary
+ * commands, and by as many members of a batch. Prints a CSV line per case:
+ *
+ *   kind,instances,passes,ns_per_pass,ns_per_instance
+ *
+ * Every instance owns a subsystem of its own, so the members go through the same
+ * requirements as the commands. Also checks that the members end and are interrupted
+ * like commands.
+ */
+
+class BenchmarkSubsystem : public FIRSTSubsystem
+{
+public:
+	BenchmarkSubsystem(FIRSTScheduler *scheduler) : FIRSTSubsystem("Benchmark", scheduler) {}
+};
+
+class CountCommand : public FIRSTCommand
+{
+public:
+	CountCommand() : FIRSTCommand("Count"), m_count(0) {}
+
+protected:
+	virtual void Initialize() {}
+	virtual void Execute() { m_count += 3; }
+	virtual bool IsFinished() { return false; }
+	virtual void End() {}
+	virtual void Interrupted() {}
+
+private:
+	unsigned long m_count;
+};
+
+class CountBatch : public FIRSTBatch
+{
+public:
+	CountBatch(uint16_t capacity, FIRSTScheduler *scheduler)
+		: FIRSTBatch(capacity, scheduler), ends(0), interrupteds(0), m_count(capacity), m_limit(capacity) {}
+
+	void SetLimit(uint16_t slot, unsigned long limit) { m_limit[slot] = limit; }
+
+	int ends;
+	int interrupteds;
+
+protected:
+	virtual void Initialize(uint16_t slot) { m_count[slot] = 0; }
+	virtual void Execute(const uint8_t *active, uint16_t count) {
+		for (uint16_t i = 0; i < count; i++)
+			m_count[i] += 3 * active[i];
+		for (uint16_t i = 0; i < count; i++) {
+			if (active[i] && m_count[i] >= m_limit[i])
+				Finish(i);
+		}
+	}
+	virtual void End(uint16_t, bool interrupted) {
+		if (interrupted)
+			interrupteds++;
+		else
+			ends++;
+	}
+
+private:
+	std::vector<unsigned long> m_count;
+	std::vector<unsigned long> m_limit;
+};
+
+static double measure(FIRSTScheduler &scheduler, unsigned long *passes)
+{
+	for (int pass = 0; pass < 10; pass++)
+		scheduler.Run();
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	std::chrono::nanoseconds elapsed(0);
+	for (*passes = 0; *passes < 50 || elapsed < std::chrono::milliseconds(20); (*passes)++)
+	{
+		scheduler.AdvanceClock(1000);
+		scheduler.Run();
+		elapsed = std::chrono::steady_clock::now() - start;
+	}
+	return (double)elapsed.count() / *passes;
+}
+
+static double measureCommands(int instances, unsigned long *passes)
+{
+	FIRSTScheduler scheduler;
+	scheduler.SetVirtualClock(true);
+	std::vector<BenchmarkSubsystem *> subsystems;
+	std::vector<CountCommand *> commands;
+	for (int i = 0; i < instances; i++)
+	{
+		subsystems.push_back(new BenchmarkSubsystem(&scheduler));
+		commands.push_back(new CountCommand());
+		commands[i]->SetScheduler(&scheduler);
+		commands[i]->Requires(subsystems[i]);
+		commands[i]->Start();
+	}
+	scheduler.Freeze(instances);
+
+	double ns = measure(scheduler, passes);
+
+	scheduler.RemoveAll();
+	for (int i = 0; i < instances; i++)
+	{
+		delete commands[i];
+		delete subsystems[i];
+	}
+	return ns;
+}
+
+static double measureBatch(int instances, unsigned long *passes)
+{
+	FIRSTScheduler scheduler;
+	scheduler.SetVirtualClock(true);
+	CountBatch batch(instances, &scheduler);
+	std::vector<BenchmarkSubsystem *> subsystems;
+	std::vector<FIRSTBatchMember *> members;
+	for (int i = 0; i < instances; i++)
+	{
+		subsystems.push_back(new BenchmarkSubsystem(&scheduler));
+		members.push_back(new FIRSTBatchMember(&batch));
+		members[i]->Requires(subsystems[i]);
+		batch.SetLimit(i, (unsigned long)-1);
+		members[i]->Start();
+	}
+	scheduler.Freeze(instances);
+
+	double ns = measure(scheduler, passes);
+	CHECK(batch.GetActive() == instances, "%d of %d members active", batch.GetActive(), instances);
+
+	scheduler.RemoveAll();
+	for (int i = 0; i < instances; i++)
+	{
+		delete members[i];
+		delete subsystems[i];
+	}
+	return ns;
+}
+
+static void testMembers()
+{
+	FIRSTScheduler scheduler;
+	scheduler.SetVirtualClock(true);
+	CountBatch batch(3, &scheduler);
+	BenchmarkSubsystem subsystem(&scheduler);
+	FIRSTBatchMember finishing(&batch), canceled(&batch), interrupted(&batch), extra(&batch);
+	interrupted.Requires(&subsystem);
+	batch.SetLimit(finishing.GetSlot(), 6);
+	batch.SetLimit(canceled.GetSlot(), (unsigned long)-1);
+	batch.SetLimit(interrupted.GetSlot(), (unsigned long)-1);
+	CHECK(extra.GetSlot() == -1, "slot %d past the capacity", extra.GetSlot());
+
+	finishing.Start();
+	canceled.Start();
+	interrupted.Start();
+	scheduler.Run();
+	scheduler.Run();
+	CHECK(batch.GetActive() == 3, "%d members active", batch.GetActive());
+
+	// Counted to 6 on the second kernel run, ended on the pass after
+	scheduler.Run();
+	scheduler.Run();
+	CHECK(!finishing.IsRunning(), "the finished member still runs");
+	CHECK(batch.ends == 1, "%d ends", batch.ends);
+
+	canceled.Cancel();
+	CountCommand taking;
+	taking.SetScheduler(&scheduler);
+	taking.Requires(&subsystem);
+	taking.Start();
+	scheduler.Run();
+	scheduler.Run();
+	CHECK(!canceled.IsRunning() && !interrupted.IsRunning(), "the members still run");
+	CHECK(batch.interrupteds == 2, "%d interrupted", batch.interrupteds);
+	CHECK(batch.GetActive() == 0, "%d members active", batch.GetActive());
+
+	// A member with no slot finishes right away
+	extra.Start();
+	scheduler.Run();
+	scheduler.Run();
+	CHECK(!extra.IsRunning(), "the member with no slot still runs");
+	scheduler.RemoveAll();
+}
+
+int main()
+{
+	testMembers();
+
+	static const int kInstances[] = {10, 100, 1000};
+	printf("kind,instances,passes,ns_per_pass,ns_per_instance\n");
+	for (int i = 0; i < 3; i++)
+	{
+		unsigned long passes;
+		double ns = measureCommands(kInstances[i], &passes);
+		printf("commands,%d,%lu,%.0f,%.1f\n", kInstances[i], passes, ns, ns / kInstances[i]);
+		ns = measureBatch(kInstances[i], &passes);
+		printf("batch,%d,%lu,%.0f,%.1f\n", kInstances[i], passes, ns, ns / kInstances[i]);
+	}
+	return CheckResult();
+}
@@ -0,0 +1,130 @@
+/*
+ * BusTest.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include <Arduino.h>
+
+#include "FIRSTScheduler.h"
+#include "FIRSTBus.h"
+#include "Check.h"
+
+/*
+ * Checks the bus queue through the scheduler, with a virtual clock and the loopback
+ * driver: the transfers end in the order they were submitted, each one latency after
+ * the previous, the queue refuses what it has no room for, and failures are counted.
+ */
+
+static const unsigned long kLatency = 1000;
+
+// A device that does not answer at 0x13, and a driver that cannot start at 0x66
+class FlakyDriver : public FIRSTLoopbackBusDriver
+{
+public:
+	FlakyDriver() : FIRSTLoopbackBusDriver(kLatency) {}
+	virtual bool Begin(FIRSTBusTransaction *transaction) {
+		return transaction->m_address != 0x66;
+	}
+
+protected:
+	virtual bool Respond(FIRSTBusTransaction *transaction) {
+		return transaction->m_address != 0x13 && FIRSTLoopbackBusDriver::Respond(transaction);
+	}
+};
+
+static void testOrder()
+{
+	FIRSTScheduler scheduler;
+	scheduler.SetVirtualClock(true);
+	FIRSTLoopbackBusDriver driver(kLatency);
+	FIRSTBus bus("Bus", &driver, &scheduler);
+
+	// The queue keeps one slot free to tell full from empty
+	const int count = FIRSTBus::kQueueSize - 1;
+	FIRSTBusTransaction transactions[count + 1];
+	uint8_t tx[count][2];
+	uint8_t rx[count][4];
+	for (int i = 0; i < count; i++)
+	{
+		tx[i][0] = i;
+		tx[i][1] = 0x80 | i;
+		transactions[i].Set(0x20 + i, tx[i], 2, rx[i], 4);
+		CHECK(bus.Submit(&transactions[i]), "transaction %d refused", i);
+	}
+	CHECK(!bus.Submit(&transactions[0]), "a pending transaction submitted again");
+	transactions[count].Set(0x40, NULL, 0, NULL, 0);
+	CHECK(!bus.Submit(&transactions[count]), "submitted to a full queue");
+	CHECK(bus.GetQueued() == count, "%d queued", bus.GetQueued());
+
+	// Back to back, one latency each, in the order they were submitted
+	unsigned long done[count];
+	int finished = 0;
+	for (int pass = 0; pass < 3 * count && finished < count; pass++)
+	{
+		scheduler.AdvanceClock(kLatency / 2);
+		scheduler.Run();
+		for (; finished < count && transactions[finished].IsDone(); finished++)
+			done[finished] = scheduler.Micros();
+		for (int i = finished; i < count; i++)
+			CHECK(!transactions[i].IsDone(), "transaction %d done before %d", i, finished);
+	}
+	CHECK(finished == count, "%d of %d done", finished, count);
+	for (int i = 0; i < finished; i++)
+	{
+		CHECK(done[i] == (i + 1) * kLatency, "transaction %d done at %lu us", i, done[i]);
+		CHECK(rx[i][0] == i && rx[i][1] == (0x80 | i) && rx[i][2] == i && rx[i][3] == (0x80 | i),
+				"transaction %d read back %02x %02x %02x %02x", i, rx[i][0], rx[i][1], rx[i][2], rx[i][3]);
+	}
+	CHECK(bus.GetCompleted() == (unsigned long)count && bus.GetFailed() == 0, "%lu completed, %lu failed",
+			bus.GetCompleted(), bus.GetFailed());
+
+	// Room again once drained
+	CHECK(bus.GetQueued() == 0 && bus.Submit(&transactions[count]), "refused once drained");
+	scheduler.RemoveAll();
+}
+
+static void testFailures()
+{
+	FIRSTScheduler scheduler;
+	scheduler.SetVirtualClock(true);
+	FlakyDriver driver;
+	FIRSTBus bus("Bus", &driver, &scheduler);
+
+	uint8_t rx[3][1];
+	FIRSTBusTransaction good, unanswered, unstarted, after;
+	good.Set(0x20, NULL, 0, rx[0], 1);
+	unanswered.Set(0x13, NULL, 0, rx[1], 1);
+	unstarted.Set(0x66, NULL, 0, rx[2], 1);
+	after.Set(0x21, NULL, 0, NULL, 0);
+	bus.Submit(&good);
+	bus.Submit(&unanswered);
+	bus.Submit(&unstarted);
+	bus.Submit(&after);
+
+	for (int pass = 0; pass < 10; pass++)
+	{
+		scheduler.AdvanceClock(kLatency);
+		scheduler.Run();
+	}
+	CHECK(good.IsDone() && after.IsDone(), "the good transactions are not done");
+	CHECK(unanswered.IsFailed() && unstarted.IsFailed(), "the bad transactions did not fail");
+	CHECK(bus.GetCompleted() == 2 && bus.GetFailed() == 2, "%lu completed, %lu failed",
+			bus.GetCompleted(), bus.GetFailed());
+
+	// A failed transaction can be submitted again
+	unanswered.Set(0x22, NULL, 0, rx[1], 1);
+	CHECK(bus.Submit(&unanswered), "refused again");
+	scheduler.AdvanceClock(kLatency);
+	scheduler.Run();
+	CHECK(unanswered.IsDone() && bus.GetCompleted() == 3, "not done again");
+	scheduler.RemoveAll();
+}
+
+int main()
+{
+	testOrder();
+	testFailures();
+	return CheckResult();
+}
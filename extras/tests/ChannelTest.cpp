@@ -0,0 +1,134 @@
+/*
+ * ChannelTest.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include <Arduino.h>
+
+#include <atomic>
+#include <thread>
+
+#include "FIRSTChannel.h"
+#include "Check.h"
+
+/*
+ * Checks the mailbox and the ring: the counts across the wrap of the sequence, the gaps
+ * the dropped values leave, and that a reader on another thread never gets a torn value.
+ */
+
+typedef struct sPair {
+	uint32_t value;
+	uint32_t inverse;
+} Pair;
+
+static void testMailboxWrap()
+{
+	FIRSTMailbox<long> mailbox;
+	uint16_t last = 0;
+	long value;
+	CHECK(mailbox.Poll(&value, &last) == 0, "nothing published yet");
+
+	// Up to just before the counts wrap at 32768
+	for (long i = 1; i <= 32760; i++)
+		mailbox.Publish(i);
+	CHECK(mailbox.Poll(&value, &last) == 32760 && value == 32760, "32760 publications, at %ld", value);
+
+	// Across the wrap, the gap stays the number of values missed
+	for (long i = 32761; i <= 32770; i++)
+		mailbox.Publish(i);
+	uint16_t updates = mailbox.Poll(&value, &last);
+	CHECK(updates == 10 && value == 32770, "%u updates across the wrap, at %ld", updates, value);
+	CHECK(last == 2, "the count wrapped to %u", last);
+	mailbox.Publish(32771);
+	CHECK(mailbox.Poll(&value, &last) == 1 && value == 32771, "one update after the wrap");
+}
+
+static void testRingGaps()
+{
+	FIRSTRing<int, 4> ring;
+	for (int i = 0; i < 6; i++)
+		ring.Push(i);
+	CHECK(ring.GetCount() == 4 && ring.GetDropped() == 2, "%u values, %u dropped", ring.GetCount(), ring.GetDropped());
+
+	int value;
+	uint16_t sequence = 0;
+	for (int i = 0; i < 4; i++)
+		CHECK(ring.Pop(&value, &sequence) && value == i && sequence == i, "value %d", i);
+	ring.Push(6);
+	CHECK(ring.Pop(&value, &sequence) && value == 6 && sequence == 6, "the gap of the dropped values shows, %u", sequence);
+	CHECK(ring.IsEmpty(), "empty");
+}
+
+static void testMailboxThreads()
+{
+	static FIRSTMailbox<Pair> mailbox;
+	static std::atomic<bool> done(false);
+	std::thread writer([]() {
+		for (uint32_t i = 0; i < 2000000; i++)
+		{
+			Pair pair = {i, ~i};
+			mailbox.Publish(pair);
+		}
+		done = true;
+	});
+
+	unsigned long reads = 0, torn = 0;
+	uint16_t last = 0;
+	while (!done)
+	{
+		Pair pair;
+		if (mailbox.Poll(&pair, &last) == 0)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+		reads++;
+		if (pair.inverse != ~pair.value)
+			torn++;
+	}
+	writer.join();
+	CHECK(torn == 0, "%lu torn values out of %lu", torn, reads);
+}
+
+static void testRingThreads()
+{
+	static FIRSTRing<uint32_t, 64> ring;
+	static const uint32_t kValues = 1000000;
+	std::thread producer([]() {
+		for (uint32_t i = 0; i < kValues; i++)
+		{
+			// Spinning would hold a single core for a whole time slice
+			while (ring.GetCount() >= 64)
+				std::this_thread::yield();
+			ring.Push(i);
+		}
+	});
+
+	uint32_t expected = 0;
+	unsigned long wrong = 0;
+	while (expected < kValues)
+	{
+		uint32_t value;
+		if (!ring.Pop(&value))
+		{
+			std::this_thread::yield();
+			continue;
+		}
+		if (value != expected)
+			wrong++;
+		expected = value + 1;
+	}
+	producer.join();
+	CHECK(wrong == 0 && ring.GetDropped() == 0, "%lu out of order, %u dropped", wrong, ring.GetDropped());
+}
+
+int main()
+{
+	testMailboxWrap();
+	testRingGaps();
+	testMailboxThreads();
+	testRingThreads();
+	return CheckResult();
+}
@@ -0,0 +1,36 @@
+/*
+ * Check.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef CHECK_H_
+#define CHECK_H_
+
+#include <stdio.h>
+
+/*
+ * The checks of the host tests: a failed one is printed, the first ten of them at least,
+ * and counted, and the test returns CheckResult() from main().
+ */
+
+static int checkFailures = 0;
+
+#define CHECK(condition, ...) do { if (!(condition)) { \
+		if (checkFailures++ < 10) { \
+			printf("%s:%d: FAILED %s: ", __FILE__, __LINE__, #condition); \
+			printf(__VA_ARGS__); \
+			printf("\n"); \
+		} \
+	} } while (0)
+
+static inline int CheckResult()
+{
+	if (checkFailures == 0)
+		return 0;
+	printf("%d failures\n", checkFailures);
+	return 1;
+}
+
+#endif /* CHECK_H_ */
@@ -0,0 +1,429 @@
+/*
+ * CommandTest.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include <Arduino.h>
+
+#include "FIRSTCommand.h"
+#include "FIRSTScheduler.h"
+#include "FIRSTSubsystem.h"
+#include "FIRSTEventLog.h"
+#include "FIRSTTelemetry.h"
+#include "FIRSTRoutine.h"
+#include "FIRSTLatency.h"
+#include "FIRSTStateMachine.h"
+#include "Check.h"
+
+/*
+ * Checks of the commands, one function per feature, each with schedulers of its own.
+ */
+
+class TestSubsystem : public FIRSTSubsystem
+{
+public:
+	TestSubsystem(FIRSTScheduler *scheduler) : FIRSTSubsystem("Test", scheduler) {}
+};
+
+class TestCommand : public FIRSTCommand
+{
+public:
+	TestCommand(int passes = 1000000) : FIRSTCommand("Test"), initializes(0), executes(0),
+		ends(0), interrupteds(0), m_passes(passes) {}
+
+	int initializes;
+	int executes;
+	int ends;
+	int interrupteds;
+
+protected:
+	virtual void Initialize() { initializes++; executes = 0; }
+	virtual void Execute() { executes++; }
+	virtual bool IsFinished() { return executes >= m_passes; }
+	virtual void End() { ends++; }
+	virtual void Interrupted() { interrupteds++; }
+
+private:
+	int m_passes;
+};
+
+class CapturePrint : public Print
+{
+public:
+	CapturePrint() : length(0) {}
+	virtual size_t write(uint8_t value) {
+		if (length >= (int)sizeof(data))
+			return 0;
+		data[length++] = value;
+		return 1;
+	}
+	using Print::write;
+	virtual int availableForWrite() { return sizeof(data) - length; }
+
+	uint8_t data[256];
+	int length;
+};
+
+// Whether the given event is among those logged since the last call
+static bool logged(uint8_t event)
+{
+	CapturePrint out;
+	FIRSTEventLog::Drain(&out);
+	FIRSTEventLog::Clear();
+	uint8_t record[FIRSTEventLog::kRecordSize + 2];
+	for (int start = 0, i = 0; i < out.length; i++)
+	{
+		if (out.data[i] != 0)
+			continue;
+		int length = FIRSTTelemetry::DecodeCOBS(out.data + start, i - start, record);
+		if (length == FIRSTEventLog::kRecordSize && record[0] == event)
+			return true;
+		start = i + 1;
+	}
+	return false;
+}
+
+static void testCrossScheduler()
+{
+	FIRSTScheduler a, b;
+	TestSubsystem onA(&a), onB(&b);
+	FIRSTEventLog::Clear();
+
+	TestCommand command;
+	command.Requires(&onA);
+	command.Requires(&onB);
+	CHECK(command.GetScheduler() == &a, "bound to the first scheduler");
+	CHECK(command.DoesRequire(&onA) && !command.DoesRequire(&onB), "the other scheduler's subsystem is not required");
+	CHECK(logged(FIRSTEventLog::kCrossScheduler), "logged");
+
+	command.SetScheduler(&b);
+	CHECK(command.GetScheduler() == &a, "not moved away from its subsystems");
+	CHECK(logged(FIRSTEventLog::kCrossScheduler), "logged");
+
+	// Added at the end of one pass, initialized on the next
+	command.Start();
+	a.Run();
+	a.Run();
+	CHECK(command.initializes == 1 && onA.GetCurrentCommand() == &command, "runs on its scheduler");
+	b.Run();
+	CHECK(onB.GetCurrentCommand() == NULL, "the other subsystem is untouched");
+}
+
+static void testRoutineOwnership()
+{
+	FIRSTScheduler scheduler;
+	scheduler.SetVirtualClock(true);
+	TestCommand finishing(2), lasting;
+	finishing.SetScheduler(&scheduler);
+	lasting.SetScheduler(&scheduler);
+	FIRSTCommand *commands[] = {&finishing, &lasting};
+	static const uint8_t program[] = {
+		FIRST_START(0), FIRST_START(1), FIRST_WAIT(1000), FIRST_END()
+	};
+	FIRSTRoutine routine(program, sizeof(program), FIRSTRoutine::kRAM, commands, 2);
+	routine.SetScheduler(&scheduler);
+
+	routine.Start();
+	for (int i = 0; i < 4; i++)
+		scheduler.Run();
+	CHECK(!finishing.IsRunning() && finishing.ends == 1, "the first command finished");
+
+	// Started again by something else, it is not the routine's anymore
+	finishing.Start();
+	scheduler.Run();
+	routine.Cancel();
+	scheduler.Run();
+	scheduler.Run();
+	CHECK(!routine.IsRunning(), "the routine is canceled");
+	CHECK(lasting.interrupteds == 1, "the command still owned is canceled");
+	CHECK(finishing.interrupteds == 0 && finishing.ends == 2, "the command started again finishes");
+	scheduler.RemoveAll();
+}
+
+// Acts on the reading of its subsystem every pass, changes the output every other pass
+class ToggleCommand : public TestCommand
+{
+public:
+	ToggleCommand(FIRSTSubsystem *subsystem) : m_subsystem(subsystem) { Requires(subsystem); }
+
+protected:
+	virtual void Execute() {
+		TestCommand::Execute();
+		Consume(m_subsystem);
+		if (executes % 2 == 0)
+			m_subsystem->OutputChanged();
+	}
+
+private:
+	FIRSTSubsystem *m_subsystem;
+};
+
+static void testLatency()
+{
+	FIRSTScheduler scheduler;
+	scheduler.SetVirtualClock(true);
+	FIRSTLatency latency;
+	scheduler.SetLatency(&latency);
+	TestSubsystem subsystem(&scheduler);
+	ToggleCommand command(&subsystem);
+	command.SetScheduler(&scheduler);
+	command.Start();
+	scheduler.Run();
+	for (int i = 0; i < 100; i++)
+	{
+		scheduler.AdvanceClock(1000);
+		scheduler.Run();
+	}
+	CHECK(latency.GetCount(0) == 50, "%lu samples for 50 changes", latency.GetCount(0));
+	scheduler.RemoveAll();
+
+	// Within a quarter, whatever the scale
+	FIRSTLatency histogram;
+	for (unsigned long value = 1; value < 200000; value = value * 3 + 1)
+	{
+		histogram.Reset();
+		histogram.Record(&command, &subsystem, value);
+		histogram.Record(&command, &subsystem, value * 2);
+		unsigned long p50 = histogram.GetPercentile(0, 50);
+		CHECK(p50 >= value && p50 <= value + value / 4, "p50 of %lu is %lu", value, p50);
+	}
+
+	// Full buckets are halved, the recent samples take over
+	histogram.Reset();
+	for (int i = 0; i < 100000; i++)
+		histogram.Record(&command, &subsystem, 10);
+	for (int i = 0; i < 100000; i++)
+		histogram.Record(&command, &subsystem, 1000);
+	CHECK(histogram.GetPercentile(0, 50) >= 1000, "p50 %lu after the change", histogram.GetPercentile(0, 50));
+	CHECK(histogram.GetCount(0) == 200000, "%lu samples", histogram.GetCount(0));
+}
+
+// Logs its stages, and whatever its command asks of it in between
+class StageSubsystem : public FIRSTSubsystem
+{
+public:
+	StageSubsystem(FIRSTScheduler *scheduler) : FIRSTSubsystem("Stages", scheduler), length(0), reading(0), sampled(0) {}
+
+	virtual void Periodic() {
+		Add('P');
+		reading++;
+		sampled = GetSampleTime();
+	}
+	virtual void Flush() { Add('F'); }
+	void Add(char stage) {
+		if (length < (int)sizeof(stages) - 1)
+			stages[length++] = stage;
+		stages[length] = 0;
+	}
+
+	char stages[64];
+	int length;
+	int reading;
+	unsigned long sampled;
+};
+
+// Reads its subsystem twice a pass, changes its output on the passes it is told to
+class StageCommand : public TestCommand
+{
+public:
+	StageCommand(StageSubsystem *subsystem) : change(false), readings(0), age(0), m_subsystem(subsystem) {
+		Requires(subsystem);
+	}
+
+	bool change;
+	int readings;
+	unsigned long age;
+
+protected:
+	virtual void Execute() {
+		TestCommand::Execute();
+		m_subsystem->Add('E');
+		readings += m_subsystem->reading;
+		age = m_subsystem->GetSampleAge();
+		Consume(m_subsystem);
+		if (change)
+			m_subsystem->OutputChanged();
+	}
+	virtual bool IsFinished() {
+		readings += m_subsystem->reading;
+		return false;
+	}
+
+private:
+	StageSubsystem *m_subsystem;
+};
+
+static void testSubsystemStages()
+{
+	FIRSTScheduler scheduler;
+	scheduler.SetVirtualClock(true);
+	FIRSTLatency latency;
+	scheduler.SetLatency(&latency);
+	StageSubsystem subsystem(&scheduler);
+	StageCommand command(&subsystem);
+	command.SetScheduler(&scheduler);
+	command.Start();
+	scheduler.Run();
+	subsystem.length = 0;
+
+	// Sampled once a pass, ahead of the commands, which all see the same reading
+	for (int i = 0; i < 3; i++)
+	{
+		scheduler.AdvanceClock(10000);
+		scheduler.Run();
+	}
+	CHECK(strcmp(subsystem.stages, "PEFPEFPEF") == 0, "stages %s", subsystem.stages);
+	CHECK(command.readings == 2 * (2 + 3 + 4), "%d readings", command.readings);
+
+	// The sample time and age follow the virtual clock
+	CHECK(subsystem.sampled == 30000 && subsystem.GetSampleTime() == 30000, "sampled at %lu", subsystem.sampled);
+	CHECK(command.age == 0, "%lu us old within the pass", command.age);
+	scheduler.AdvanceClock(2500);
+	CHECK(subsystem.GetSampleAge() == 2500, "%lu us old after the pass", subsystem.GetSampleAge());
+
+	// Only the pass that changed the output records a latency, the flag does not outlive it
+	command.change = true;
+	scheduler.Run();
+	command.change = false;
+	for (int i = 0; i < 3; i++)
+	{
+		scheduler.AdvanceClock(10000);
+		scheduler.Run();
+	}
+	CHECK(latency.GetCount(0) == 1, "%lu latencies recorded for one change", latency.GetCount(0));
+
+	// A disabled pass still samples and flushes
+	subsystem.length = 0;
+	scheduler.SetEnabled(false);
+	scheduler.Run();
+	CHECK(strcmp(subsystem.stages, "PF") == 0, "stages %s when disabled", subsystem.stages);
+	scheduler.SetEnabled(true);
+	scheduler.RemoveAll();
+}
+
+// Takes some real time on every run
+class SlowCommand : public TestCommand
+{
+protected:
+	virtual void Execute() {
+		TestCommand::Execute();
+		delayMicroseconds(200);
+	}
+};
+
+static void testCommandTiming()
+{
+	FIRSTScheduler scheduler;
+	SlowCommand untimed, budgeted;
+	untimed.SetScheduler(&scheduler);
+	budgeted.SetScheduler(&scheduler);
+	budgeted.SetExecutionBudget(1000000);
+	untimed.Start();
+	budgeted.Start();
+	scheduler.Run();
+	scheduler.Run();
+	CHECK(untimed.GetMaxExecutionTime() == 0, "a command with no budget is not timed");
+	CHECK(budgeted.GetMaxExecutionTime() >= 200, "timed at %lu us", budgeted.GetMaxExecutionTime());
+
+	scheduler.SetCommandTiming(true);
+	scheduler.Run();
+	CHECK(untimed.GetMaxExecutionTime() >= 200, "timed at %lu us once all are", untimed.GetMaxExecutionTime());
+	scheduler.RemoveAll();
+}
+
+static bool again = false;
+static bool next = false;
+static bool Again() { return again; }
+static bool Next() { return next; }
+
+static void testStateMachineRestart()
+{
+	FIRSTScheduler scheduler;
+	TestCommand work;
+	work.SetScheduler(&scheduler);
+	FIRSTCommand *commands[] = {&work};
+
+	// Two states sharing a command; the first one is entered again on Again
+	static const uint8_t N = FIRSTStateMachine::kNone;
+	static const FIRSTState states[] PROGMEM = {
+		{ N, N, N, N, N, 0, 0, 2 },
+		{ N, N, N, N, N, 0, 2, 0 },
+	};
+	static const FIRSTTransition transitions[] PROGMEM = {
+		{ 0, 0, N },
+		{ 1, 1, N },
+	};
+	static const FIRSTCondition guards[] PROGMEM = { Again, Next };
+	static const FIRSTMachine machine PROGMEM = { states, transitions, guards, NULL, 0 };
+	FIRSTStateMachine stateMachine(&machine, commands);
+	stateMachine.SetScheduler(&scheduler);
+
+	stateMachine.Start();
+	for (int i = 0; i < 3; i++)
+		scheduler.Run();
+	CHECK(work.initializes == 1, "%d initializes", work.initializes);
+
+	// Canceled and started in the same pass, it starts again once removed
+	again = true;
+	scheduler.Run();
+	again = false;
+	for (int i = 0; i < 3; i++)
+		scheduler.Run();
+	CHECK(work.interrupteds == 1 && work.initializes == 2 && work.IsRunning(),
+			"entered again: %d interrupteds, %d initializes", work.interrupteds, work.initializes);
+
+	next = true;
+	scheduler.Run();
+	next = false;
+	for (int i = 0; i < 3; i++)
+		scheduler.Run();
+	CHECK(stateMachine.GetState() == 1, "in state %u", stateMachine.GetState());
+	CHECK(work.interrupteds == 2 && work.initializes == 3 && work.IsRunning(),
+			"the sibling: %d interrupteds, %d initializes", work.interrupteds, work.initializes);
+	scheduler.RemoveAll();
+}
+
+// Times out after a tenth of a second unless told to finish
+class TimeoutCommand : public TestCommand
+{
+public:
+	TimeoutCommand() { SetTimeout(0.1); }
+
+protected:
+	virtual bool IsFinished() { return IsTimedOut(); }
+};
+
+static void testThenTimeout()
+{
+	FIRSTScheduler scheduler;
+	scheduler.SetVirtualClock(true);
+	TimeoutCommand first;
+	TestCommand next;
+	first.SetScheduler(&scheduler);
+	next.SetScheduler(&scheduler);
+	first.Then(&next);
+
+	first.Start();
+	for (int i = 0; i < 20; i++)
+	{
+		scheduler.AdvanceClock(10000);
+		scheduler.Run();
+	}
+	CHECK(!first.IsRunning() && scheduler.GetStatistics().timedOut == 1, "the first command timed out");
+	CHECK(next.initializes == 1, "a timeout is followed by default, %d initializes", next.initializes);
+	scheduler.RemoveAll();
+}
+
+int main()
+{
+	testCrossScheduler();
+	testRoutineOwnership();
+	testLatency();
+	testSubsystemStages();
+	testCommandTiming();
+	testStateMachineRestart();
+	testThenTimeout();
+	return CheckResult();
+}
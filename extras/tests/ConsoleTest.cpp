@@ -0,0 +1,243 @@
+/*
+ * ConsoleTest.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include <Arduino.h>
+
+#include <string>
+
+#include "FIRSTCommand.h"
+#include "FIRSTConsole.h"
+#include "FIRSTScheduler.h"
+#include "FIRSTSubsystem.h"
+#include "FIRSTParameters.h"
+#include "FIRSTEventLog.h"
+#include "Check.h"
+
+/*
+ * Checks that the answers of the console never block: a port with room for a few bytes
+ * gets the list of the commands over several passes, in whole lines, and the next line
+ * waits for it, and so do the short answers. Also checks that names with a space or
+ * taken by another command are left out, that a name is not mistaken for another one
+ * with the same hash, and that parameter values have to be whole numbers of 32 bits.
+ */
+
+class SmallPort : public Stream
+{
+public:
+	SmallPort() : room(0) {}
+
+	std::string input;
+	std::string output;
+	int room;
+
+	virtual size_t write(uint8_t value) {
+		if (room <= 0)
+			return 0;
+		room--;
+		output += (char)value;
+		return 1;
+	}
+	using Print::write;
+	virtual int availableForWrite() { return room; }
+	virtual int available() { return input.size(); }
+	virtual int read() {
+		if (input.empty())
+			return -1;
+		int c = (uint8_t)input[0];
+		input.erase(0, 1);
+		return c;
+	}
+	virtual int peek() { return input.empty() ? -1 : (uint8_t)input[0]; }
+};
+
+class ConsoleSubsystem : public FIRSTSubsystem
+{
+public:
+	ConsoleSubsystem(const char *name, FIRSTScheduler *scheduler) : FIRSTSubsystem(name, scheduler) {}
+};
+
+class LongCommand : public FIRSTCommand
+{
+public:
+	LongCommand(const char *name) : FIRSTCommand(name) {}
+
+protected:
+	virtual void Initialize() {}
+	virtual void Execute() {}
+	virtual bool IsFinished() { return false; }
+	virtual void End() {}
+	virtual void Interrupted() {}
+};
+
+static void testList()
+{
+	FIRSTScheduler scheduler;
+	scheduler.SetVirtualClock(true);
+	SmallPort port;
+	FIRSTConsole console(&port);
+	scheduler.SetConsole(&console);
+	ConsoleSubsystem drive("Drive", &scheduler);
+	LongCommand first("FirstCommand"), second("SecondCommand"), third("ThirdCommand");
+	first.SetScheduler(&scheduler);
+	second.SetScheduler(&scheduler);
+	third.SetScheduler(&scheduler);
+	first.Requires(&drive);
+	console.Add(&first);
+	console.Add(&second);
+	console.Add(&third);
+	scheduler.Freeze(3);
+	first.Start();
+	second.Start();
+	third.Start();
+	scheduler.Run();
+	scheduler.Run();
+
+	// Room for a little more than a line per pass, and none on one of them
+	port.input = "list\nowner Drive\n";
+	int passes = 0;
+	for (; passes < 20 && port.output.find("ok\r\nFirstCommand\r\nok\r\n") == std::string::npos; passes++)
+	{
+		port.room = passes == 1 ? 0 : 20;
+		size_t written = port.output.size();
+		scheduler.Run();
+		if (passes == 1)
+			CHECK(port.output.size() == written, "written without room");
+	}
+	// The scheduler keeps the last command added first
+	std::string expected = std::to_string(third.GetID()) + " ThirdCommand\r\n"
+			+ std::to_string(second.GetID()) + " SecondCommand\r\n"
+			+ std::to_string(first.GetID()) + " FirstCommand\r\n"
+			+ "ok\r\nFirstCommand\r\nok\r\n";
+	CHECK(port.output == expected, "the answers were\n%s", port.output.c_str());
+	CHECK(passes >= 3, "the list took %d passes", passes);
+	scheduler.RemoveAll();
+}
+
+static void testSpaces()
+{
+	FIRSTScheduler scheduler;
+	SmallPort port;
+	port.room = 1000;
+	FIRSTConsole console(&port);
+	scheduler.SetConsole(&console);
+	ConsoleSubsystem spaced("Test LED", &scheduler);
+	ConsoleSubsystem plain("TestLED", &scheduler);
+	CHECK(!console.Build(&scheduler), "a name with a space was built");
+
+	port.input = "owner TestLED\nowner Test\n";
+	scheduler.Run();
+	CHECK(port.output == "-\r\nok\r\n? owner Test\r\n", "the answers were\n%s", port.output.c_str());
+}
+
+static void testParameterValues()
+{
+	FIRSTScheduler scheduler;
+	SmallPort port;
+	port.room = 1000;
+	FIRSTConsole console(&port);
+	scheduler.SetConsole(&console);
+	FIRSTParameters parameters(0, 2, &scheduler);
+	const long *gain = parameters.Declare("Gain", 5);
+	console.SetParameters(&parameters);
+	scheduler.Freeze();
+
+	port.input = "param Gain 12x\nparam Gain 4294967296\nparam Gain -\nparam Gain -2147483648\n";
+	for (int i = 0; i < 4; i++)
+		scheduler.Run();
+	CHECK(port.output == "? param Gain\r\n? param Gain\r\n? param Gain\r\n-2147483648\r\nok\r\n", "the answers were\n%s", port.output.c_str());
+	CHECK(*gain == -2147483648L, "the gain is %ld", *gain);
+}
+
+// Two names with the same FNV-1a hash
+static const char kClash[] = "anAaw";
+static const char kClashing[] = "aVcia";
+
+static void testNames()
+{
+	CHECK(FIRSTConsole::Hash(kClash) == FIRSTConsole::Hash(kClashing), "the names do not clash");
+	FIRSTScheduler scheduler;
+	SmallPort port;
+	port.room = 1000;
+	FIRSTConsole console(&port);
+	scheduler.SetConsole(&console);
+	ConsoleSubsystem subsystem(kClash, &scheduler);
+	LongCommand clashing(kClashing), same("Same"), other("Same");
+	clashing.SetScheduler(&scheduler);
+	same.SetScheduler(&scheduler);
+	other.SetScheduler(&scheduler);
+	console.Add(&same);
+	console.Add(&same);
+	console.Add(&other);
+
+	FIRSTEventLog::Clear();
+	CHECK(!console.Build(&scheduler), "built with two commands of the same name");
+	CHECK(FIRSTEventLog::GetCount() == 1, "%d clashes logged", FIRSTEventLog::GetCount());
+
+	// The first one of a name is kept, a name with the same hash is not taken for it
+	port.input = "start Same\nowner aVcia\nstart aVcia\nowner anAaw\n";
+	for (int i = 0; i < 4; i++)
+		scheduler.Run();
+	CHECK(port.output == "ok\r\n? owner aVcia\r\n? start aVcia\r\n-\r\nok\r\n", "the answers were\n%s", port.output.c_str());
+	CHECK(same.IsRunning() && !other.IsRunning(), "the wrong command runs");
+
+	// Two names with the same hash can not both be known
+	console.Add(&clashing);
+	CHECK(!console.Build(&scheduler), "built with two names of the same hash");
+	CHECK(FIRSTEventLog::GetCount() == 3, "%d clashes logged", FIRSTEventLog::GetCount());
+	scheduler.RemoveAll();
+}
+
+// A short answer waits for room as the long ones do, what it answers is done already
+static void testShortAnswers()
+{
+	FIRSTScheduler scheduler;
+	SmallPort port;
+	FIRSTConsole console(&port);
+	scheduler.SetConsole(&console);
+	FIRSTParameters parameters(0, 2, &scheduler);
+	parameters.Declare("Gain", 5);
+	console.SetParameters(&parameters);
+	LongCommand command("Command");
+	command.SetScheduler(&scheduler);
+	console.Add(&command);
+	scheduler.Freeze();
+
+	// The port tells its size on the first answer
+	port.room = 32;
+	port.input = "cancel Command\n";
+	scheduler.Run();
+	CHECK(port.output == "ok\r\n", "the answer was\n%s", port.output.c_str());
+
+	const char *lines[] = {"start Command\n", "param Gain 123456\n", "what Command\n"};
+	const char *answers[] = {"ok\r\n", "123456\r\nok\r\n", "? what Command\r\n"};
+	for (int i = 0; i < 3; i++)
+	{
+		port.output.clear();
+		port.input = lines[i];
+		port.room = 3;
+		scheduler.Run();
+		CHECK(port.output.empty(), "written without room: %s", port.output.c_str());
+		for (int pass = 0; pass < 5 && port.output != answers[i]; pass++)
+		{
+			port.room = 32;
+			scheduler.Run();
+		}
+		CHECK(port.output == answers[i], "the answer was\n%s", port.output.c_str());
+	}
+	CHECK(command.IsRunning(), "the command was not started");
+	scheduler.RemoveAll();
+}
+
+int main()
+{
+	testList();
+	testSpaces();
+	testParameterValues();
+	testNames();
+	testShortAnswers();
+	return CheckResult();
+}
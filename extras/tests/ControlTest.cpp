@@ -0,0 +1,171 @@
+/*
+ * ControlTest.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include <Arduino.h>
+
+#include <math.h>
+
+#include "FIRSTScheduler.h"
+#include "FIRSTControl.h"
+#include "FIRSTFixed.h"
+#include "Check.h"
+
+/*
+ * Checks the fixed point divisions against Div() and the profiled PID command against
+ * a simulated plant.
+ */
+
+static int32_t random32()
+{
+	return (int32_t)(((uint32_t)rand() << 16) ^ (uint32_t)rand());
+}
+
+static void testDivisions()
+{
+	srand(1);
+	for (int i = 0; i < 100000; i++)
+	{
+		int32_t a = random32() >> (rand() % 31);
+		int32_t step = FIRSTFixed::FromMicros(1 + rand() % 500000);
+		if (step == 0)
+			continue;
+		CHECK(FIRSTFixed::DivStep(a, step) == FIRSTFixed::Div(a, step),
+				"DivStep(%d, %d) = %d, Div() = %d", a, step, FIRSTFixed::DivStep(a, step), FIRSTFixed::Div(a, step));
+
+		int32_t divisor = (random32() & 0x7FFFFFFF) >> (rand() % 31);
+		if (divisor == 0)
+			continue;
+		int32_t exact = FIRSTFixed::Div(a, divisor);
+		int32_t inverse = FIRSTFixed::DivBy(a, FIRSTFixed::Invert(divisor));
+		// Rounded toward minus infinity rather than zero, and the inverse is cut
+		CHECK(FIRSTFixed::Abs(inverse - exact) <= 1 + FIRSTFixed::Abs(exact >> 28),
+				"DivBy(%d, Invert(%d)) = %d, Div() = %d", a, divisor, inverse, exact);
+	}
+}
+
+// Div() rounds toward zero whatever the signs, and saturates
+static void testDivisionSigns()
+{
+	CHECK(FIRSTFixed::Div(FIRSTFixed::FromInt(-3), FIRSTFixed::FromInt(2)) == FIRSTFixed::FromDouble(-1.5), "-3 / 2");
+	CHECK(FIRSTFixed::Div(FIRSTFixed::FromInt(3), FIRSTFixed::FromInt(-2)) == FIRSTFixed::FromDouble(-1.5), "3 / -2");
+	CHECK(FIRSTFixed::Div(-1, FIRSTFixed::FromInt(2)) == 0, "-1/65536 / 2 = %d", FIRSTFixed::Div(-1, FIRSTFixed::FromInt(2)));
+	CHECK(FIRSTFixed::Div(FIRSTFixed::kMin, -FIRSTFixed::kOne) == FIRSTFixed::kMax, "kMin / -1");
+	CHECK(FIRSTFixed::Div(FIRSTFixed::kMin, FIRSTFixed::kOne / 2) == FIRSTFixed::kMin, "kMin / 0.5");
+	CHECK(FIRSTFixed::Div(-5, 0) == FIRSTFixed::kMin && FIRSTFixed::Div(5, 0) == FIRSTFixed::kMax, "by 0");
+
+	srand(2);
+	for (int i = 0; i < 100000; i++)
+	{
+		int32_t a = random32() >> (rand() % 31);
+		int32_t b = random32() >> (rand() % 31);
+		if (b == 0)
+			continue;
+		double exact = (double)a * FIRSTFixed::kOne / b;
+		double expected = exact > FIRSTFixed::kMax ? FIRSTFixed::kMax : (exact < FIRSTFixed::kMin ? FIRSTFixed::kMin : trunc(exact));
+		int32_t quotient = FIRSTFixed::Div(a, b);
+		CHECK(fabs(quotient - expected) <= 1, "Div(%d, %d) = %d, %.0f expected", a, b, quotient, expected);
+	}
+}
+
+// A mass pushed by the output, the measurement being its position
+class Cart : public FIRSTSetpointSubsystem
+{
+public:
+	Cart(FIRSTScheduler *scheduler) : FIRSTSetpointSubsystem("Cart", scheduler), position(0), velocity(0), m_output(0) {}
+	virtual int32_t GetMeasurement() { return position; }
+	virtual void SetOutput(int32_t output) { m_output = output; }
+	void Simulate(int32_t dt) {
+		velocity += FIRSTFixed::Mul(FIRSTFixed::Mul(m_output, FIRSTFixed::FromInt(20)), dt);
+		velocity -= FIRSTFixed::Mul(velocity, FIRSTFixed::Mul(FIRSTFixed::FromInt(5), dt));
+		position += FIRSTFixed::Mul(velocity, dt);
+	}
+
+	int32_t position;
+	int32_t velocity;
+
+private:
+	int32_t m_output;
+};
+
+static void testProfile(int32_t maxAcceleration, int32_t maxJerk)
+{
+	FIRSTScheduler scheduler;
+	scheduler.SetVirtualClock(true);
+	Cart cart(&scheduler);
+	FIRSTMotionProfile profile(FIRSTFixed::FromInt(2), maxAcceleration, maxJerk);
+	// No tolerance: finishes when the profile is done
+	FIRSTProfileCommand command(&cart, FIRSTFixed::FromInt(8), 0, FIRSTFixed::FromDouble(0.5),
+			&profile, FIRSTFixed::FromInt(3), 20.0);
+	command.Start();
+
+	int passes;
+	for (passes = 0; passes < 2000 && (passes < 2 || command.IsRunning()); passes++)
+	{
+		scheduler.AdvanceClock(10000);
+		scheduler.Run();
+		cart.Simulate(FIRSTFixed::FromMicros(10000));
+		if (profile.GetVelocity() > FIRSTFixed::FromInt(2))
+			CHECK(false, "the profile goes over its velocity");
+	}
+	CHECK(!command.IsRunning() && profile.IsDone(), "the command finishes with the profile");
+	CHECK(scheduler.GetStatistics().completed == 1, "finished rather than timed out");
+	CHECK(profile.GetPosition() == FIRSTFixed::FromInt(3), "the profile ends on the goal");
+	CHECK(FIRSTFixed::Abs(cart.position - FIRSTFixed::FromInt(3)) < FIRSTFixed::FromDouble(0.2),
+			"the cart follows, at %f", FIRSTFixed::ToDouble(cart.position));
+}
+
+static void testNoAccelerationLimit()
+{
+	// Cruises from the first step: 1 unit at 1 unit/s takes 1 s
+	FIRSTMotionProfile profile(FIRSTFixed::FromInt(1), 0);
+	profile.Start(0, FIRSTFixed::FromInt(1));
+	profile.Step(FIRSTFixed::FromMicros(10000));
+	CHECK(profile.GetVelocity() == FIRSTFixed::FromInt(1), "at full velocity after a step");
+	int steps;
+	for (steps = 1; steps < 1000 && !profile.IsDone(); steps++)
+		profile.Step(FIRSTFixed::FromMicros(10000));
+	CHECK(steps >= 99 && steps <= 102, "done in %d steps", steps);
+	CHECK(profile.GetPosition() == FIRSTFixed::FromInt(1), "ends on the goal");
+}
+
+static void testNoLimits()
+{
+	// Unlimited, the velocity reaches the top of the range, the position has to keep going
+	FIRSTMotionProfile profile(0, 0);
+	int32_t goal = FIRSTFixed::FromInt(30000);
+	profile.Start(0, goal);
+	int32_t previous = 0;
+	int steps;
+	for (steps = 0; steps < 1000 && !profile.IsDone(); steps++)
+	{
+		profile.Step(FIRSTFixed::FromMicros(500000));
+		CHECK(profile.GetPosition() >= previous && profile.GetVelocity() >= 0, "went back to %f at %f/s",
+				FIRSTFixed::ToDouble(profile.GetPosition()), FIRSTFixed::ToDouble(profile.GetVelocity()));
+		previous = profile.GetPosition();
+	}
+	CHECK(profile.IsDone() && profile.GetPosition() == goal, "at %f after %d steps",
+			FIRSTFixed::ToDouble(profile.GetPosition()), steps);
+
+	// With a jerk limit the acceleration ramps down from the top of the range as well
+	FIRSTMotionProfile jerked(0, 0, FIRSTFixed::FromInt(30000));
+	jerked.Start(0, goal);
+	for (steps = 0; steps < 1000 && !jerked.IsDone(); steps++)
+		jerked.Step(FIRSTFixed::FromMicros(500000));
+	CHECK(jerked.IsDone() && jerked.GetPosition() == goal, "at %f after %d steps with a jerk limit",
+			FIRSTFixed::ToDouble(jerked.GetPosition()), steps);
+}
+
+int main()
+{
+	testDivisions();
+	testDivisionSigns();
+	testProfile(FIRSTFixed::FromInt(4), 0);
+	testProfile(FIRSTFixed::FromInt(4), FIRSTFixed::FromInt(40));
+	testNoAccelerationLimit();
+	testNoLimits();
+	return CheckResult();
+}
@@ -0,0 +1,52 @@
+/*
+ * EventLogRecord.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include <Arduino.h>
+
+#include "FIRSTEventLog.h"
+
+/*
+ * Drains a few known events to a file, for EventLogDecoder to check. The file is written
+ * through a Print that does not override availableForWrite(), like most that are not a
+ * serial port.
+ *
+ *   EventLogRecord <file>
+ */
+
+class FilePrint : public Print
+{
+public:
+	FilePrint(FILE *file) : m_file(file) {}
+	virtual size_t write(uint8_t value) { return fputc(value, m_file) == EOF ? 0 : 1; }
+	using Print::write;
+
+private:
+	FILE *m_file;
+};
+
+int main(int argc, char **argv)
+{
+	if (argc < 2)
+		return 2;
+	FILE *file = fopen(argv[1], "wb");
+	if (file == NULL)
+	{
+		perror(argv[1]);
+		return 1;
+	}
+
+	FIRSTEventLog::Clear();
+	FIRSTEventLog::Log(FIRSTEventLog::kNullCommand, 0);
+	FIRSTEventLog::Log(FIRSTEventLog::kBudgetExceeded, 7);
+	FIRSTEventLog::Log(FIRSTEventLog::kPassOverrun, 2500);
+	FIRSTEventLog::Log(FIRSTEventLog::kEventCount, 1);
+
+	FilePrint out(file);
+	int sent = FIRSTEventLog::Drain(&out);
+	fclose(file);
+	return sent == 4 ? 0 : 1;
+}
@@ -0,0 +1,291 @@
+/*
+ * FilterTest.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include <Arduino.h>
+
+#include <algorithm>
+#include <math.h>
+
+#include "FIRSTCommand.h"
+#include "FIRSTScheduler.h"
+#include "FIRSTSubsystem.h"
+#include "FIRSTFilter.h"
+#include "Check.h"
+
+/*
+ * Checks every filter against a straightforward reference over random samples, negative
+ * ones included, then the filters of a subsystem updated by the scheduler. The averages
+ * of the banks are shifts, which round toward minus infinity where the moving average
+ * divides and rounds toward zero; the references do the same.
+ */
+
+static const int kSamples = 20000;
+
+static int32_t randomSample(int32_t range)
+{
+	return (int32_t)(rand() % (2 * range + 1)) - range;
+}
+
+static double saturate(double value)
+{
+	return value > FIRSTFixed::kMax ? FIRSTFixed::kMax : (value < FIRSTFixed::kMin ? FIRSTFixed::kMin : value);
+}
+
+static void testMovingAverage()
+{
+	srand(1);
+	FIRSTMovingAverage<5> average;
+	int32_t window[5] = {0};
+	for (int i = 0; i < kSamples; i++)
+	{
+		int32_t sample = randomSample(100000);
+		window[i % 5] = sample;
+		int32_t sum = 0;
+		for (int j = 0; j < 5; j++)
+			sum += window[j];
+		int32_t value = average.Filter(sample, FIRSTFixed::kOne);
+		CHECK(value == sum / 5, "sample %d: %d for %d", i, value, sum / 5);
+	}
+	average.Reset(-7);
+	CHECK(average.Filter(-7, FIRSTFixed::kOne) == -7, "reset");
+}
+
+static void testMedian()
+{
+	srand(2);
+	FIRSTMedianFilter<7> median;
+	int32_t window[7] = {0};
+	for (int i = 0; i < kSamples; i++)
+	{
+		// Mostly small, with wild readings now and then
+		int32_t sample = rand() % 10 == 0 ? randomSample(1000000) : randomSample(50);
+		window[i % 7] = sample;
+		int32_t sorted[7];
+		std::copy(window, window + 7, sorted);
+		std::sort(sorted, sorted + 7);
+		int32_t value = median.Filter(sample, FIRSTFixed::kOne);
+		CHECK(value == sorted[3], "sample %d: %d for %d", i, value, sorted[3]);
+	}
+}
+
+static void testDebounce()
+{
+	srand(3);
+	FIRSTDebounceFilter debounce(3);
+	int32_t history[3] = {0, 0, 0};
+	int32_t expected = 0;
+	for (int i = 0; i < kSamples; i++)
+	{
+		// Three levels, changing often enough to bounce
+		int32_t sample = rand() % 3 == 0 ? rand() % 3 : history[(i + 2) % 3];
+		history[i % 3] = sample;
+		// A new value is let through once it is the last three samples
+		if (i >= 2 && history[0] == history[1] && history[1] == history[2])
+			expected = sample;
+		int32_t value = debounce.Filter(sample, FIRSTFixed::kOne);
+		CHECK(value == expected, "sample %d: %d for %d", i, value, expected);
+		if (value != expected)
+			break;
+	}
+}
+
+static void testExponential()
+{
+	srand(4);
+	const double alpha = 0.25;
+	FIRSTExponentialFilter exponential(FIRSTFixed::FromDouble(alpha));
+	double expected = 0;
+	double worst = 0;
+	for (int i = 0; i < kSamples; i++)
+	{
+		int32_t sample = FIRSTFixed::FromInt(randomSample(1000));
+		expected += alpha * (sample - expected);
+		int32_t value = exponential.Filter(sample, FIRSTFixed::kOne);
+		worst = fmax(worst, fabs(value - expected));
+	}
+	// Every sample rounds by one unit at most, the errors decay by 1 - alpha
+	CHECK(worst <= 1 / alpha + 1, "off by %.1f units", worst);
+}
+
+static void testDerivative()
+{
+	srand(5);
+	FIRSTDerivativeFilter derivative;
+	int32_t previous = 0;
+	for (int i = 0; i < kSamples; i++)
+	{
+		int32_t sample = FIRSTFixed::FromInt(randomSample(100));
+		int32_t dt = FIRSTFixed::FromMicros(1000 + rand() % 50000);
+		double expected = saturate((double)(sample - previous) / dt * FIRSTFixed::kOne);
+		int32_t value = derivative.Filter(sample, dt);
+		CHECK(fabs(value - expected) <= 1, "sample %d: %d for %.1f", i, value, expected);
+		previous = sample;
+	}
+}
+
+static void testAverageBank()
+{
+	srand(6);
+	FIRSTAverageBank<6, 4> bank;
+	int32_t windows[6][4] = {{0}};
+	bool differs = false;
+	for (int i = 0; i < kSamples; i++)
+	{
+		for (int c = 0; c < 6; c++)
+		{
+			windows[c][i % 4] = randomSample(1000);
+			bank.Put(c, windows[c][i % 4]);
+		}
+		bank.Update(FIRSTFixed::kOne);
+		for (int c = 0; c < 6; c++)
+		{
+			int32_t sum = windows[c][0] + windows[c][1] + windows[c][2] + windows[c][3];
+			int32_t expected = (int32_t)floor(sum / 4.0);
+			CHECK(bank.Get(c) == expected, "sample %d channel %d: %d for %d", i, c, bank.Get(c), expected);
+			differs = differs || expected != sum / 4;
+		}
+	}
+	CHECK(differs, "the shift never rounded differently from the division");
+}
+
+static void testSmoothingBank()
+{
+	srand(7);
+	const int shift = 3;
+	FIRSTSmoothingBank<4> bank(shift);
+	double expected[4] = {0};
+	double worst = 0;
+	for (int i = 0; i < kSamples; i++)
+	{
+		for (int c = 0; c < 4; c++)
+		{
+			int32_t sample = randomSample(100000);
+			bank.Put(c, sample);
+			expected[c] += (sample - expected[c]) / (1 << shift);
+		}
+		bank.Update(FIRSTFixed::kOne);
+		for (int c = 0; c < 4; c++)
+			worst = fmax(worst, fabs(bank.Get(c) - expected[c]));
+	}
+	CHECK(worst <= 2, "off by %.2f", worst);
+
+	// A steady input is reached exactly, whatever its sign
+	for (int c = 0; c < 4; c++)
+		bank.Put(c, c % 2 ? -1234 : 1234);
+	for (int i = 0; i < 200; i++)
+		bank.Update(FIRSTFixed::kOne);
+	for (int c = 0; c < 4; c++)
+		CHECK(bank.Get(c) == (c % 2 ? -1234 : 1234), "channel %d settles on %d", c, bank.Get(c));
+}
+
+static void testChannelElapsed()
+{
+	FIRSTDerivativeFilter derivative;
+	FIRSTFilterChannel channel;
+	channel.Add(&derivative);
+	int32_t second = FIRSTFixed::FromInt(1);
+
+	channel.Put(0);
+	channel.Update(second);
+	// A pass without a sample, the next one comes two seconds after the first
+	channel.Update(second);
+	channel.Put(10);
+	channel.Update(second);
+	CHECK(channel.Get() == 5, "rate %ld over the passes without a sample", (long)channel.Get());
+
+	channel.Put(20);
+	channel.Update(second);
+	CHECK(channel.Get() == 10, "rate %ld once every pass has a sample", (long)channel.Get());
+}
+
+// A position read every pass, filtered into a rate, and four raw readings averaged
+class Sensors : public FIRSTSubsystem
+{
+public:
+	Sensors(FIRSTScheduler *scheduler) : FIRSTSubsystem("Sensors", scheduler), position(0), rate(this), reading(0) {
+		rate.Add(&derivative);
+		AddFilter(&bank);
+		// Added twice, still updated once per pass
+		AddFilter(&rate);
+	}
+
+	virtual void Periodic() {
+		rate.Put(position);
+		for (int c = 0; c < 4; c++)
+			bank.Put(c, reading + c);
+	}
+
+	int32_t position;
+	FIRSTDerivativeFilter derivative;
+	FIRSTFilterChannel rate;
+	FIRSTAverageBank<4, 2> bank;
+	int32_t reading;
+};
+
+// Reads the filtered values, as a command does
+class ReadCommand : public FIRSTCommand
+{
+public:
+	ReadCommand(Sensors *sensors) : FIRSTCommand("Read"), rate(0), average(0), m_sensors(sensors) {
+		Requires(sensors);
+	}
+
+	int32_t rate;
+	int32_t average;
+
+protected:
+	virtual void Initialize() {}
+	virtual void Execute() {
+		rate = m_sensors->rate.Get();
+		average = m_sensors->bank.Get(3);
+	}
+	virtual bool IsFinished() { return false; }
+	virtual void End() {}
+	virtual void Interrupted() {}
+
+private:
+	Sensors *m_sensors;
+};
+
+static void testSubsystemFilters()
+{
+	FIRSTScheduler scheduler;
+	scheduler.SetVirtualClock(true);
+	Sensors sensors(&scheduler);
+	ReadCommand command(&sensors);
+	command.SetScheduler(&scheduler);
+	command.Start();
+	scheduler.Run();
+
+	// 10 units every 10 ms pass is 1000 units per second
+	for (int pass = 0; pass < 20; pass++)
+	{
+		sensors.position += FIRSTFixed::FromInt(10);
+		sensors.reading = pass * 100;
+		scheduler.AdvanceClock(10000);
+		scheduler.Run();
+	}
+	double rate = FIRSTFixed::ToDouble(command.rate);
+	CHECK(fabs(rate - 1000) < 1, "the command reads a rate of %f", rate);
+	// The samples of this pass and the last, channel 3 being 3 above the reading
+	CHECK(command.average == (1900 + 1800) / 2 + 3, "the command reads an average of %d", command.average);
+	scheduler.RemoveAll();
+}
+
+int main()
+{
+	testMovingAverage();
+	testMedian();
+	testDebounce();
+	testExponential();
+	testDerivative();
+	testAverageBank();
+	testSmoothingBank();
+	testChannelElapsed();
+	testSubsystemFilters();
+	return CheckResult();
+}
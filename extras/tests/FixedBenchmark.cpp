@@ -0,0 +1,237 @@
+/*
+ * FixedBenchmark.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include <Arduino.h>
+
+#include <chrono>
+#include <math.h>
+
+#include "FIRSTScheduler.h"
+#include "FIRSTControl.h"
+#include "FIRSTFixed.h"
+#include "Check.h"
+
+/*
+ * Compares the fixed point math of the control loops with the same math in double: the
+ * largest error of Mul(), Div(), DivStep() and DivBy() over random operands, in units of
+ * 1/65536, and how far a PID loop drifts from its double counterpart on the same plant.
+ * Prints a CSV line per operation:
+ *
+ *   operation,max_error,ns_fixed,ns_double
+ *
+ * The times are those of the host, where double is in hardware; on the AVR double is
+ * software and the 32 bit paths are what counts. Fails if an error is above its bound.
+ */
+
+static const int kOperands = 4096;
+static const double kOne = FIRSTFixed::kOne;
+
+static int32_t random32()
+{
+	return (int32_t)(((uint32_t)rand() << 16) ^ (uint32_t)rand());
+}
+
+// Times a loop over the operands, the results are stored so that they are not optimized out
+template <typename A, typename B, typename F>
+static double timeLoop(const A *a, const B *b, F operation)
+{
+	static decltype(operation(a[0], b[0])) results[kOperands];
+	int rounds = 0;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	std::chrono::nanoseconds elapsed(0);
+	for (; rounds < 10 || elapsed < std::chrono::milliseconds(20); rounds++)
+	{
+		for (int i = 0; i < kOperands; i++)
+			results[i] = operation(a[i], b[i]);
+		elapsed = std::chrono::steady_clock::now() - start;
+	}
+	volatile double sink = results[rounds % kOperands];
+	(void)sink;
+	return (double)elapsed.count() / ((double)rounds * kOperands);
+}
+
+static double saturate(double value)
+{
+	return value > FIRSTFixed::kMax ? FIRSTFixed::kMax : (value < FIRSTFixed::kMin ? FIRSTFixed::kMin : value);
+}
+
+static void report(const char *operation, double error, double bound, double nsFixed, double nsDouble)
+{
+	printf("%s,%.3f,%.2f,%.2f\n", operation, error, nsFixed, nsDouble);
+	CHECK(error <= bound, "%s is off by %.3f", operation, error);
+}
+
+static void benchmarkArithmetic()
+{
+	static int32_t a[kOperands], b[kOperands], steps[kOperands], divisors[kOperands];
+	static double da[kOperands], db[kOperands], dsteps[kOperands], ddivisors[kOperands];
+	static FIRSTFixed::Reciprocal reciprocals[kOperands];
+	srand(3);
+	for (int i = 0; i < kOperands; i++)
+	{
+		a[i] = random32() >> (rand() % 31);
+		b[i] = random32() >> (rand() % 31);
+		if (b[i] == 0)
+			b[i] = 1;
+		steps[i] = FIRSTFixed::FromMicros(1000 + rand() % 50000);
+		divisors[i] = (random32() & 0x7FFFFFFF) >> (rand() % 31);
+		if (divisors[i] == 0)
+			divisors[i] = 1;
+		reciprocals[i] = FIRSTFixed::Invert(divisors[i]);
+		da[i] = a[i] / kOne;
+		db[i] = b[i] / kOne;
+		dsteps[i] = steps[i] / kOne;
+		ddivisors[i] = divisors[i] / kOne;
+	}
+
+	// Mul() and Div() round toward minus infinity and zero, within one unit
+	double mul = 0, div = 0, divStep = 0, divBy = 0;
+	for (int i = 0; i < kOperands; i++)
+	{
+		mul = fmax(mul, fabs(FIRSTFixed::Mul(a[i], b[i]) - saturate(da[i] * db[i] * kOne)));
+		div = fmax(div, fabs(FIRSTFixed::Div(a[i], b[i]) - saturate(da[i] / db[i] * kOne)));
+		divStep = fmax(divStep, fabs(FIRSTFixed::DivStep(a[i], steps[i]) - saturate(da[i] / dsteps[i] * kOne)));
+		// The inverse keeps 30 bits, the error grows with the quotient
+		double quotient = saturate(da[i] / ddivisors[i] * kOne);
+		divBy = fmax(divBy, fabs(FIRSTFixed::DivBy(a[i], reciprocals[i]) - quotient) / (1 + fabs(quotient) / (1 << 28)));
+	}
+
+	report("Mul", mul, 1,
+			timeLoop(a, b, [](int32_t x, int32_t y) { return FIRSTFixed::Mul(x, y); }),
+			timeLoop(da, db, [](double x, double y) { return x * y; }));
+	report("Div", div, 1,
+			timeLoop(a, b, [](int32_t x, int32_t y) { return FIRSTFixed::Div(x, y); }),
+			timeLoop(da, db, [](double x, double y) { return x / y; }));
+	report("DivStep", divStep, 1,
+			timeLoop(a, steps, [](int32_t x, int32_t y) { return FIRSTFixed::DivStep(x, y); }),
+			timeLoop(da, dsteps, [](double x, double y) { return x / y; }));
+	int index[kOperands];
+	for (int i = 0; i < kOperands; i++)
+		index[i] = i;
+	report("DivBy", divBy, 2,
+			timeLoop(a, index, [](int32_t x, int i) { return FIRSTFixed::DivBy(x, reciprocals[i]); }),
+			timeLoop(da, ddivisors, [](double x, double y) { return x / y; }));
+}
+
+// The plant of ControlTest, a mass pushed by the output, in fixed point
+class Cart : public FIRSTSetpointSubsystem
+{
+public:
+	Cart(FIRSTScheduler *scheduler) : FIRSTSetpointSubsystem("Cart", scheduler), position(0), velocity(0), output(0) {}
+	virtual int32_t GetMeasurement() { return position; }
+	virtual void SetOutput(int32_t value) { output = value; }
+	void Simulate(int32_t dt) {
+		velocity += FIRSTFixed::Mul(FIRSTFixed::Mul(output, FIRSTFixed::FromInt(20)), dt);
+		velocity -= FIRSTFixed::Mul(velocity, FIRSTFixed::Mul(FIRSTFixed::FromInt(5), dt));
+		position += FIRSTFixed::Mul(velocity, dt);
+	}
+
+	int32_t position;
+	int32_t velocity;
+	int32_t output;
+};
+
+// Makes the steps of the command callable outside of a pass
+class BenchmarkPID : public FIRSTPIDCommand
+{
+public:
+	BenchmarkPID(Cart *cart, int32_t p, int32_t i, int32_t d) : FIRSTPIDCommand(cart, p, i, d) {}
+	void Step() { Execute(); }
+};
+
+// The same controller and plant in double
+typedef struct sDoubleLoop {
+	double p, i, d;
+	double integral, lastMeasurement;
+	bool first;
+	double position, velocity, output;
+
+	void Step(double setpoint, double dt) {
+		double error = setpoint - position;
+		double out = p * error;
+		if (!first)
+			out -= d * (position - lastMeasurement) / dt;
+		double next = integral + error * dt;
+		double unclamped = out + i * next;
+		if (!((unclamped > 1 && error > 0) || (unclamped < -1 && error < 0)))
+			integral = next;
+		out += i * integral;
+		lastMeasurement = position;
+		first = false;
+		output = out > 1 ? 1 : (out < -1 ? -1 : out);
+	}
+	void Simulate(double dt) {
+		velocity += output * 20 * dt;
+		velocity -= velocity * 5 * dt;
+		position += velocity * dt;
+	}
+} DoubleLoop;
+
+static void benchmarkPID()
+{
+	FIRSTScheduler scheduler;
+	scheduler.SetVirtualClock(true);
+	Cart cart(&scheduler);
+	BenchmarkPID pid(&cart, FIRSTFixed::FromInt(8), FIRSTFixed::FromDouble(0.5), FIRSTFixed::FromDouble(0.5));
+	pid.SetScheduler(&scheduler);
+	pid.SetSetpoint(FIRSTFixed::FromInt(3));
+	DoubleLoop loop = {8, 0.5, 0.5, 0, 0, true, 0, 0, 0};
+
+	// One pass sets the time step the command reads, the loops then run outside of passes
+	scheduler.AdvanceClock(10000);
+	scheduler.Run();
+	scheduler.AdvanceClock(10000);
+	scheduler.Run();
+	int32_t dt = FIRSTFixed::FromMicros(10000);
+	double ddt = dt / kOne;
+
+	double drift = 0;
+	for (int step = 0; step < 300; step++)
+	{
+		pid.Step();
+		cart.Simulate(dt);
+		loop.Step(3, ddt);
+		loop.Simulate(ddt);
+		drift = fmax(drift, fabs(cart.position / kOne - loop.position));
+	}
+	CHECK(fabs(loop.position - 3) < 0.05, "the double loop ends at %f", loop.position);
+
+	int rounds = 0;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	std::chrono::nanoseconds elapsed(0);
+	for (; rounds < 10 || elapsed < std::chrono::milliseconds(20); rounds++)
+	{
+		for (int i = 0; i < kOperands; i++)
+			pid.Step();
+		elapsed = std::chrono::steady_clock::now() - start;
+	}
+	double nsFixed = (double)elapsed.count() / ((double)rounds * kOperands);
+
+	volatile double sink = 0;
+	start = std::chrono::steady_clock::now();
+	elapsed = std::chrono::nanoseconds(0);
+	for (rounds = 0; rounds < 10 || elapsed < std::chrono::milliseconds(20); rounds++)
+	{
+		for (int i = 0; i < kOperands; i++)
+			loop.Step(3, ddt);
+		sink = sink + loop.output;
+		elapsed = std::chrono::steady_clock::now() - start;
+	}
+	double nsDouble = (double)elapsed.count() / ((double)rounds * kOperands);
+
+	// In units of 1/65536, as the others
+	report("PID", drift * kOne, 0.01 * kOne, nsFixed, nsDouble);
+	scheduler.RemoveAll();
+}
+
+int main()
+{
+	printf("operation,max_error,ns_fixed,ns_double\n");
+	benchmarkArithmetic();
+	benchmarkPID();
+	return CheckResult();
+}
@@ -0,0 +1,68 @@
+/*
+ * LEDTest.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include <Arduino.h>
+
+#include "FIRSTScheduler.h"
+#include "FIRSTLEDStrip.h"
+#include "FIRSTLEDAnimations.h"
+#include "Check.h"
+
+/*
+ * Checks the segments of an LED strip and the animations drawing on them.
+ */
+
+static void run(FIRSTScheduler *scheduler, int passes, unsigned long step)
+{
+	for (int i = 0; i < passes; i++)
+	{
+		scheduler->AdvanceClock(step);
+		scheduler->Run();
+	}
+}
+
+static void testSegments()
+{
+	FIRSTScheduler scheduler;
+	scheduler.SetVirtualClock(true);
+	FIRSTLEDStrip strip("Strip", 30, &scheduler);
+	FIRSTLEDStrip left("Left", &strip, 0, 10);
+	FIRSTLEDStrip right("Right", &strip, 10, 10);
+	FIRSTLEDStrip overlapping("Overlapping", &strip, 5, 10);
+	FIRSTLEDStrip beyond("Beyond", &strip, 25, 10);
+	CHECK(left.GetLength() == 10 && right.GetLength() == 10, "side by side segments are kept");
+	CHECK(overlapping.GetLength() == 0, "an overlapping segment is left empty");
+	CHECK(beyond.GetLength() == 5, "a segment is cut to fit, not %u", beyond.GetLength());
+
+	FIRSTLEDPulse leftPulse(&left, FIRSTLEDStrip::Color(255, 0, 0), 500);
+	FIRSTLEDPulse rightPulse(&right, FIRSTLEDStrip::Color(0, 255, 0), 500);
+	FIRSTLEDFade whole(&strip, 0, FIRSTLEDStrip::Color(0, 0, 255), 1000);
+	CHECK(whole.DoesRequire(&left) && whole.DoesRequire(&right) && whole.DoesRequire(&beyond),
+			"an animation of the strip requires its segments");
+
+	leftPulse.Start();
+	rightPulse.Start();
+	run(&scheduler, 2, 20000);
+	CHECK(leftPulse.IsRunning() && rightPulse.IsRunning(), "segments animate side by side");
+
+	whole.Start();
+	run(&scheduler, 2, 20000);
+	CHECK(!leftPulse.IsRunning() && !rightPulse.IsRunning(), "the strip animation interrupts the segments");
+
+	// 1 s fade on the virtual clock, whatever the host takes
+	run(&scheduler, 24, 20000);
+	CHECK(whole.IsRunning(), "the fade is not over after 500 ms");
+	run(&scheduler, 30, 20000);
+	CHECK(!whole.IsRunning(), "the fade is over after 1 s");
+	CHECK(strip.GetPixel(29) == FIRSTLEDStrip::Color(0, 0, 255), "the fade ends on its color");
+}
+
+int main()
+{
+	testSegments();
+	return CheckResult();
+}
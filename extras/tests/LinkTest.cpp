@@ -0,0 +1,232 @@
+/*
+ * LinkTest.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include <Arduino.h>
+
+#include <errno.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "FIRSTCommand.h"
+#include "FIRSTScheduler.h"
+#include "FIRSTLink.h"
+#include "Check.h"
+
+/*
+ * Checks the link between two boards: over a FIRSTLoopbackStream in one process, with
+ * virtual clocks, then between two processes over a socketpair, in real time. A socket
+ * does not tell how much it takes, so the second case also checks that such a port is
+ * written at all.
+ */
+
+// A motor whose measurement follows its output
+class Motor : public FIRSTSetpointSubsystem
+{
+public:
+	Motor(FIRSTScheduler *scheduler) : FIRSTSetpointSubsystem("Motor", scheduler), output(0) {}
+	virtual int32_t GetMeasurement() { return output; }
+	virtual void SetOutput(int32_t value) { output = value; }
+
+	int32_t output;
+};
+
+// Drives a subsystem, remote or not, to a given output
+class DriveCommand : public FIRSTCommand
+{
+public:
+	DriveCommand(FIRSTSetpointSubsystem *subsystem, int32_t output, int passes = 1000000)
+		: FIRSTCommand("Drive"), m_subsystem(subsystem), m_output(output), m_passes(passes), m_executes(0)
+	{
+		Requires(subsystem);
+	}
+
+protected:
+	virtual void Initialize() { m_executes = 0; }
+	virtual void Execute() { m_subsystem->SetOutput(m_output); m_executes++; }
+	virtual bool IsFinished() { return m_executes >= m_passes; }
+	virtual void End() {}
+	virtual void Interrupted() {}
+
+private:
+	FIRSTSetpointSubsystem *m_subsystem;
+	int32_t m_output;
+	int m_passes;
+	int m_executes;
+};
+
+// One end of a socket, written without blocking, which never tells its room
+class SocketStream : public Stream
+{
+public:
+	SocketStream(int fd) : m_fd(fd) {}
+
+	virtual int available() {
+		int count = 0;
+		return ioctl(m_fd, FIONREAD, &count) == 0 ? count : 0;
+	}
+	virtual int read() {
+		uint8_t c;
+		return recv(m_fd, &c, 1, MSG_DONTWAIT) == 1 ? c : -1;
+	}
+	virtual int peek() {
+		uint8_t c;
+		return recv(m_fd, &c, 1, MSG_DONTWAIT | MSG_PEEK) == 1 ? c : -1;
+	}
+	virtual size_t write(uint8_t value) { return write(&value, 1); }
+	virtual size_t write(const uint8_t *buffer, size_t size) {
+		ssize_t n = send(m_fd, buffer, size, MSG_DONTWAIT | MSG_NOSIGNAL);
+		return n < 0 ? 0 : n;
+	}
+	bool IsClosed() {
+		uint8_t c;
+		return recv(m_fd, &c, 1, MSG_DONTWAIT | MSG_PEEK) == 0;
+	}
+
+private:
+	int m_fd;
+};
+
+static void testLoopback()
+{
+	FIRSTScheduler a, b;
+	a.SetVirtualClock(true);
+	b.SetVirtualClock(true);
+	FIRSTLoopbackStream wireA, wireB;
+	wireA.Connect(&wireB);
+	FIRSTLink linkA(&wireA, &a), linkB(&wireB, &b);
+
+	Motor motor(&b);
+	linkB.Export(3, &motor);
+	FIRSTRemoteSubsystem remote("Remote", &linkA, 3);
+	DriveCommand drive(&remote, 42);
+	drive.SetScheduler(&a);
+
+	drive.Start();
+	for (int i = 0; i < 10; i++)
+	{
+		a.AdvanceClock(10000);
+		b.AdvanceClock(10000);
+		a.Run();
+		b.Run();
+	}
+	CHECK(motor.output == 42 && motor.GetCurrentCommand() != NULL, "the motor is driven to %d", (int)motor.output);
+	CHECK(remote.GetMeasurement() == 42, "the measurement came back as %d", (int)remote.GetMeasurement());
+	CHECK(linkA.IsConnected() && linkB.IsConnected(), "connected");
+	CHECK(linkA.GetDroppedFrames() == 0, "%u frames dropped", linkA.GetDroppedFrames());
+
+	// A command of the board of the motor takes it for a while, the next refresh claims it back
+	DriveCommand local(&motor, 7, 2);
+	local.SetScheduler(&b);
+	local.Start();
+	bool taken = false;
+	for (int i = 0; i < 20; i++)
+	{
+		a.AdvanceClock(10000);
+		b.AdvanceClock(10000);
+		a.Run();
+		b.Run();
+		taken = taken || motor.GetCurrentCommand() == &local;
+	}
+	CHECK(taken, "the local command never ran");
+	CHECK(motor.output == 42 && motor.GetCurrentCommand() != NULL && motor.GetCurrentCommand() != &local,
+			"claimed back, driven to %d", (int)motor.output);
+
+	drive.Cancel();
+	for (int i = 0; i < 5; i++)
+	{
+		a.AdvanceClock(10000);
+		b.AdvanceClock(10000);
+		a.Run();
+		b.Run();
+	}
+	CHECK(motor.GetCurrentCommand() == NULL, "released");
+	a.RemoveAll();
+	b.RemoveAll();
+}
+
+// The board of the motor: exits with 0 once it was driven to 42 then released
+static int runMotorBoard(int fd)
+{
+	FIRSTScheduler scheduler;
+	SocketStream stream(fd);
+	FIRSTLink link(&stream, &scheduler);
+	Motor motor(&scheduler);
+	link.Export(3, &motor);
+
+	bool driven = false, released = false;
+	unsigned long start = millis();
+	while (!stream.IsClosed() && millis() - start < 5000)
+	{
+		scheduler.Run();
+		if (motor.GetCurrentCommand() != NULL && motor.output == 42)
+			driven = true;
+		else if (driven && motor.GetCurrentCommand() == NULL)
+			released = true;
+		delay(1);
+	}
+	scheduler.RemoveAll();
+	return driven && released ? 0 : 1;
+}
+
+static void testProcesses()
+{
+	int fds[2];
+	if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0)
+	{
+		CHECK(false, "socketpair: %s", strerror(errno));
+		return;
+	}
+	fflush(stdout);
+	pid_t child = fork();
+	if (child == 0)
+	{
+		close(fds[0]);
+		_exit(runMotorBoard(fds[1]));
+	}
+	close(fds[1]);
+
+	FIRSTScheduler scheduler;
+	SocketStream stream(fds[0]);
+	FIRSTLink link(&stream, &scheduler);
+	FIRSTRemoteSubsystem remote("Remote", &link, 3);
+	DriveCommand drive(&remote, 42);
+	drive.SetScheduler(&scheduler);
+
+	drive.Start();
+	unsigned long start = millis();
+	while (remote.GetMeasurement() != 42 && millis() - start < 3000)
+	{
+		scheduler.Run();
+		delay(1);
+	}
+	CHECK(remote.GetMeasurement() == 42, "the measurement came back as %d", (int)remote.GetMeasurement());
+	CHECK(link.GetFramesSent() > 0 && link.GetDroppedFrames() == 0, "%u frames sent, %u dropped",
+			link.GetFramesSent(), link.GetDroppedFrames());
+	CHECK(link.GetRoundTrip() > 0, "no round trip measured");
+
+	drive.Cancel();
+	for (start = millis(); millis() - start < 200;)
+	{
+		scheduler.Run();
+		delay(1);
+	}
+	close(fds[0]);
+
+	int status = 0;
+	waitpid(child, &status, 0);
+	CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0, "the motor board was not driven and released (%d)", status);
+	scheduler.RemoveAll();
+}
+
+int main()
+{
+	testLoopback();
+	testProcesses();
+	return CheckResult();
+}
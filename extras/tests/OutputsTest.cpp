@@ -0,0 +1,118 @@
+/*
+ * OutputsTest.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include <Arduino.h>
+
+#include "FIRSTCommand.h"
+#include "FIRSTScheduler.h"
+#include "FIRSTOutputs.h"
+#include "Check.h"
+
+/*
+ * Checks the output stage of the scheduler on the simulated ports, eight pins a port:
+ * what is staged during a pass is only written at its end, the last value staged for a
+ * pin wins, and every port that changed is written once however many of its pins did.
+ */
+
+static bool pin(FIRSTOutputs *outputs, uint8_t pin)
+{
+	return (outputs->GetPort(pin / 8 + 1) & (1 << (pin % 8))) != 0;
+}
+
+// Stages the pins it is given on every pass, several times each
+class StageCommand : public FIRSTCommand
+{
+public:
+	StageCommand() : FIRSTCommand("Stage"), count(0), value(HIGH), duty(0), seen(false) {}
+
+	uint8_t pins[16];
+	int count;
+	uint8_t value;
+	uint8_t duty;
+	bool seen;
+
+protected:
+	virtual void Initialize() {}
+	virtual void Execute() {
+		FIRSTOutputs *outputs = GetScheduler()->GetOutputs();
+		for (int i = 0; i < count; i++)
+		{
+			outputs->Stage(pins[i], value == HIGH ? LOW : HIGH);
+			outputs->Stage(pins[i], value);
+		}
+		outputs->StagePWM(3, duty / 2);
+		outputs->StagePWM(3, duty);
+		// Nothing is written before the end of the pass
+		seen = count > 0 && pin(outputs, pins[0]) == (value == HIGH);
+	}
+	virtual bool IsFinished() { return false; }
+	virtual void End() {}
+	virtual void Interrupted() {}
+};
+
+static void testStaging()
+{
+	FIRSTScheduler scheduler;
+	scheduler.SetVirtualClock(true);
+	FIRSTOutputs *outputs = scheduler.GetOutputs();
+	StageCommand command;
+	command.SetScheduler(&scheduler);
+	command.Start();
+	scheduler.Run();
+
+	// Two pins of one port and one of another, staged LOW then HIGH every pass
+	command.pins[0] = 8;
+	command.pins[1] = 9;
+	command.pins[2] = 20;
+	command.count = 3;
+	command.duty = 200;
+	unsigned long writes = outputs->GetPortWrites();
+	scheduler.Run();
+	CHECK(!command.seen, "the pins were written during the pass");
+	CHECK(pin(outputs, 8) && pin(outputs, 9) && pin(outputs, 20), "the last values staged win");
+	CHECK(outputs->GetPortWrites() - writes == 2, "%lu port writes for two ports",
+			outputs->GetPortWrites() - writes);
+	CHECK(hostPins[3] == 200, "PWM duty %d", hostPins[3]);
+
+	// Staged again to the same values, nothing is written
+	writes = outputs->GetPortWrites();
+	hostPins[3] = 0;
+	scheduler.Run();
+	CHECK(outputs->GetPortWrites() == writes, "%lu port writes for no change", outputs->GetPortWrites() - writes);
+	CHECK(hostPins[3] == 0, "PWM written again for the same duty");
+
+	// Only the port whose pins changed is written, the other pins of the port stay
+	command.value = LOW;
+	command.count = 1;
+	command.duty = 100;
+	writes = outputs->GetPortWrites();
+	scheduler.Run();
+	CHECK(!pin(outputs, 8) && pin(outputs, 9) && pin(outputs, 20), "pin 8 alone goes low");
+	CHECK(outputs->GetPortWrites() - writes == 1, "%lu port writes for one port", outputs->GetPortWrites() - writes);
+	CHECK(hostPins[3] == 100, "PWM duty %d", hostPins[3]);
+	scheduler.RemoveAll();
+}
+
+// Every scheduler has its own ports
+static void testSeparateSchedulers()
+{
+	FIRSTScheduler a, b;
+	a.SetVirtualClock(true);
+	b.SetVirtualClock(true);
+	a.GetOutputs()->Stage(12, HIGH);
+	a.Run();
+	b.Run();
+	CHECK(pin(a.GetOutputs(), 12) && !pin(b.GetOutputs(), 12), "the pins of one scheduler show in the other");
+	CHECK(b.GetOutputs()->GetPortWrites() == 0, "%lu port writes with nothing staged", b.GetOutputs()->GetPortWrites());
+}
+
+int main()
+{
+	testStaging();
+	testSeparateSchedulers();
+	return CheckResult();
+}
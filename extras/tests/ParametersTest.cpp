@@ -0,0 +1,200 @@
+/*
+ * ParametersTest.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include <Arduino.h>
+
+#include "FIRSTScheduler.h"
+#include "FIRSTParameters.h"
+#include "FIRSTEventLog.h"
+#include "Check.h"
+
+/*
+ * Checks the parameters kept in the EEPROM, through the file backing its image: that
+ * changes are only written once they settle, a byte a pass, to the banks in turn, that
+ * a bank cut short falls back to the previous one, that the records nobody declared
+ * are carried over, and that names with the same hash are refused. Every reload goes
+ * through SetImageFile(), as a reset would.
+ *
+ *   ParametersTest [image file]
+ */
+
+static const char *path = "parameters.bin";
+static uint8_t image[2 * FIRSTParameters::kBankSize];
+
+// Reads the file back, returns how many bytes changed since the last time
+static int readImage()
+{
+	uint8_t previous[sizeof(image)];
+	memcpy(previous, image, sizeof(image));
+	FILE *file = fopen(path, "rb");
+	if (file == NULL || fread(image, 1, sizeof(image), file) != sizeof(image))
+		CHECK(false, "could not read %s", path);
+	if (file != NULL)
+		fclose(file);
+	int changed = 0;
+	for (size_t i = 0; i < sizeof(image); i++)
+		changed += image[i] != previous[i];
+	return changed;
+}
+
+// Runs passes of 10 ms until the parameters are written, checking that every pass
+// writes a byte at most. Returns how many passes it took.
+static int settle(FIRSTScheduler *scheduler, FIRSTParameters *parameters, int maxPasses = 1000)
+{
+	int passes = 0;
+	readImage();
+	for (; passes < maxPasses && parameters->IsDirty(); passes++)
+	{
+		scheduler->AdvanceClock(10000);
+		scheduler->Run();
+		int changed = readImage();
+		CHECK(changed <= 1, "%d bytes written by a pass", changed);
+	}
+	return passes;
+}
+
+static void testWriteBehind()
+{
+	remove(path);
+	FIRSTParameters::SetImageFile(path);
+	FIRSTScheduler scheduler;
+	scheduler.SetVirtualClock(true);
+	FIRSTParameters parameters(0, 2, &scheduler);
+	const long *gain = parameters.Declare("Gain", 5);
+	CHECK(gain != NULL && *gain == 5, "no stored value, the default is used");
+	CHECK(!parameters.IsDirty(), "dirty without a change");
+
+	// Nothing is written while the changes go on
+	parameters.Set("Gain", 7);
+	readImage();
+	for (int pass = 0; pass < 90; pass++)
+	{
+		scheduler.AdvanceClock(10000);
+		scheduler.Run();
+		if (pass % 30 == 0)
+			parameters.Set(gain, 7 + pass);
+	}
+	parameters.Set(gain, 7);
+	CHECK(readImage() == 0 && parameters.GetBankWrites() == 0, "written before settling");
+
+	int passes = settle(&scheduler, &parameters);
+	CHECK(parameters.GetBankWrites() == 1, "%u banks written", parameters.GetBankWrites());
+	CHECK(passes * 10 >= (int)FIRSTParameters::kSettleTime, "written after %d passes", passes);
+	CHECK(image[0] == 1 && image[1] == 1, "bank 0 has sequence %u and %u records", image[0], image[1]);
+}
+
+static void testRotation()
+{
+	FIRSTParameters::SetImageFile(path);
+	FIRSTScheduler scheduler;
+	scheduler.SetVirtualClock(true);
+	FIRSTParameters parameters(0, 2, &scheduler);
+	const long *gain = parameters.Declare("Gain", 5);
+	CHECK(*gain == 7, "reloaded as %ld", *gain);
+
+	// The banks are written in turn, with the sequence going up
+	const int bank1 = FIRSTParameters::kBankSize;
+	parameters.Set(gain, 8);
+	settle(&scheduler, &parameters);
+	CHECK(image[bank1] == 2 && image[0] == 1, "sequences %u and %u", image[0], image[bank1]);
+	parameters.Set(gain, 9);
+	settle(&scheduler, &parameters);
+	CHECK(image[0] == 3 && image[bank1] == 2, "sequences %u and %u", image[0], image[bank1]);
+	CHECK(parameters.GetBankWrites() == 2, "%u banks written", parameters.GetBankWrites());
+
+	FIRSTParameters::SetImageFile(path);
+	FIRSTParameters reloaded(0, 2, &scheduler);
+	CHECK(*reloaded.Declare("Gain", 5) == 9, "the newest bank is not loaded");
+}
+
+static void testTornWrite()
+{
+	FIRSTParameters::SetImageFile(path);
+	FIRSTScheduler scheduler;
+	scheduler.SetVirtualClock(true);
+	FIRSTParameters parameters(0, 2, &scheduler);
+	const long *gain = parameters.Declare("Gain", 5);
+	CHECK(*gain == 9, "reloaded as %ld", *gain);
+
+	// Reset once the first byte of the record is written, the header is not
+	parameters.Set(gain, 0x12345678L);
+	int passes = 0;
+	readImage();
+	for (; passes < 1000; passes++)
+	{
+		scheduler.AdvanceClock(10000);
+		scheduler.Run();
+		if (readImage() > 0)
+			break;
+	}
+	CHECK(parameters.IsDirty() && parameters.GetBankWrites() == 0, "the write is not under way");
+
+	FIRSTParameters::SetImageFile(path);
+	FIRSTParameters reloaded(0, 2, &scheduler);
+	CHECK(*reloaded.Declare("Gain", 5) == 9, "the bank cut short is loaded");
+}
+
+static void testCarryOver()
+{
+	remove(path);
+	FIRSTParameters::SetImageFile(path);
+	FIRSTScheduler scheduler;
+	scheduler.SetVirtualClock(true);
+	{
+		FIRSTParameters parameters(0, 2, &scheduler);
+		parameters.Declare("Arm", 1);
+		parameters.Declare("Drive", 2);
+		parameters.Set("Drive", 3);
+		settle(&scheduler, &parameters);
+		scheduler.RemoveAll();
+	}
+
+	// A program that does not know Drive changes Arm
+	FIRSTParameters::SetImageFile(path);
+	FIRSTScheduler other;
+	other.SetVirtualClock(true);
+	{
+		FIRSTParameters parameters(0, 2, &other);
+		parameters.Set(parameters.Declare("Arm", 1), 4);
+		settle(&other, &parameters);
+		CHECK(parameters.GetBankWrites() == 1, "%u banks written", parameters.GetBankWrites());
+		other.RemoveAll();
+	}
+
+	FIRSTParameters::SetImageFile(path);
+	FIRSTScheduler last;
+	FIRSTParameters parameters(0, 2, &last);
+	CHECK(*parameters.Declare("Drive", 2) == 3, "Drive was not carried over");
+	CHECK(*parameters.Declare("Arm", 1) == 4, "Arm was not changed");
+	last.RemoveAll();
+}
+
+static void testNameClash()
+{
+	FIRSTScheduler scheduler;
+	FIRSTParameters parameters(0, 2, &scheduler);
+	FIRSTEventLog::Clear();
+	// Two names with the same FNV-1a hash
+	CHECK(parameters.Declare("anAaw", 1) != NULL, "the first name is refused");
+	CHECK(parameters.Declare("aVcia", 2) == NULL, "the name with the same hash is declared");
+	CHECK(parameters.Get("aVcia") == NULL && *parameters.Get("anAaw") == 1, "the names are mixed up");
+	CHECK(FIRSTEventLog::GetCount() == 1, "%d events logged", FIRSTEventLog::GetCount());
+	scheduler.RemoveAll();
+}
+
+int main(int argc, char **argv)
+{
+	if (argc > 1)
+		path = argv[1];
+	testWriteBehind();
+	testRotation();
+	testTornWrite();
+	testCarryOver();
+	testNameClash();
+	remove(path);
+	return CheckResult();
+}
@@ -0,0 +1,169 @@
+/*
+ * ScalingBenchmark.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include <Arduino.h>
+
+#include <chrono>
+#include <vector>
+
+#include "FIRSTCommand.h"
+#include "FIRSTScheduler.h"
+#include "FIRSTSubsystem.h"
+#include "AllocationTracker.h"
+
+/*
+ * Measures the cost of a scheduler pass as the number of running commands, of subsystems
+ * and the churn grow. The churn is the share of the commands canceled and started again
+ * on every pass. Prints a CSV line per case:
+ *
+ *   commands,subsystems,churn,passes,ns_per_pass,ns_per_command,allocations_per_pass
+ *
+ * and fails if a case goes over one of the thresholds given:
+ *
+ *   ScalingBenchmark [--quick] [--max-ns-per-command N] [--max-allocations-per-pass N]
+ *
+ * The time is per pass divided by the commands, so that one threshold fits every size.
+ * The scheduler is frozen with room for all the commands, so a pass should not allocate.
+ */
+
+class BenchmarkSubsystem : public FIRSTSubsystem
+{
+public:
+	BenchmarkSubsystem(FIRSTScheduler *scheduler) : FIRSTSubsystem("Benchmark", scheduler) {}
+};
+
+class BenchmarkCommand : public FIRSTCommand
+{
+public:
+	BenchmarkCommand() : FIRSTCommand("Benchmark"), m_count(0) {}
+
+protected:
+	virtual void Initialize() {}
+	virtual void Execute() { m_count++; }
+	virtual bool IsFinished() { return false; }
+	virtual void End() {}
+	virtual void Interrupted() {}
+
+private:
+	unsigned long m_count;
+};
+
+typedef struct sResult {
+	unsigned long passes;
+	double nsPerPass;
+	double allocationsPerPass;
+} Result;
+
+static Result measure(int commandCount, int subsystemCount, int churn)
+{
+	FIRSTScheduler scheduler;
+	scheduler.SetVirtualClock(true);
+
+	std::vector<BenchmarkSubsystem *> subsystems;
+	for (int i = 0; i < subsystemCount; i++)
+		subsystems.push_back(new BenchmarkSubsystem(&scheduler));
+	// The first commands own a subsystem each, the others require none
+	std::vector<BenchmarkCommand *> commands;
+	for (int i = 0; i < commandCount; i++)
+	{
+		BenchmarkCommand *command = new BenchmarkCommand();
+		command->SetScheduler(&scheduler);
+		if (i < subsystemCount)
+			command->Requires(subsystems[i]);
+		commands.push_back(command);
+		command->Start();
+	}
+	scheduler.Freeze(commandCount);
+
+	int churned = commandCount * churn / 100;
+	int next = 0;
+	for (int pass = 0; pass < 10; pass++)
+		scheduler.Run();
+
+	Result result;
+	unsigned long allocations = AllocationTracker::GetAllocations();
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	std::chrono::nanoseconds elapsed(0);
+	for (result.passes = 0; result.passes < 50 || elapsed < std::chrono::milliseconds(20); result.passes++)
+	{
+		// Restarted in the same pass: removed by the commands stage, added back after it
+		for (int i = 0; i < churned; i++)
+		{
+			commands[next]->Cancel();
+			commands[next]->Start();
+			next = (next + 1) % commandCount;
+		}
+		scheduler.AdvanceClock(1000);
+		scheduler.Run();
+		elapsed = std::chrono::steady_clock::now() - start;
+	}
+	result.nsPerPass = (double)elapsed.count() / result.passes;
+	result.allocationsPerPass = (double)(AllocationTracker::GetAllocations() - allocations) / result.passes;
+
+	scheduler.RemoveAll();
+	for (int i = 0; i < commandCount; i++)
+		delete commands[i];
+	for (int i = 0; i < subsystemCount; i++)
+		delete subsystems[i];
+	return result;
+}
+
+int main(int argc, char **argv)
+{
+	bool quick = false;
+	double maxNsPerCommand = 0;
+	double maxAllocations = -1;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--quick") == 0)
+			quick = true;
+		else if (strcmp(argv[i], "--max-ns-per-command") == 0 && i + 1 < argc)
+			maxNsPerCommand = atof(argv[++i]);
+		else if (strcmp(argv[i], "--max-allocations-per-pass") == 0 && i + 1 < argc)
+			maxAllocations = atof(argv[++i]);
+		else
+		{
+			fprintf(stderr, "usage: %s [--quick] [--max-ns-per-command N] [--max-allocations-per-pass N]\n", argv[0]);
+			return 2;
+		}
+	}
+
+	static const int kCommands[] = {1, 10, 100, 1000};
+	static const int kSubsystems[] = {1, 8, 64};
+	static const int kChurns[] = {0, 10, 50, 100};
+	int commandCases = quick ? 3 : 4;
+	int subsystemCases = quick ? 2 : 3;
+
+	int failures = 0;
+	printf("commands,subsystems,churn,passes,ns_per_pass,ns_per_command,allocations_per_pass\n");
+	for (int c = 0; c < commandCases; c++)
+	{
+		for (int s = 0; s < subsystemCases; s++)
+		{
+			for (int h = 0; h < 4; h++)
+			{
+				Result result = measure(kCommands[c], kSubsystems[s], kChurns[h]);
+				double nsPerCommand = result.nsPerPass / kCommands[c];
+				printf("%d,%d,%d,%lu,%.0f,%.1f,%.2f\n", kCommands[c], kSubsystems[s], kChurns[h],
+						result.passes, result.nsPerPass, nsPerCommand, result.allocationsPerPass);
+				if (maxNsPerCommand > 0 && nsPerCommand > maxNsPerCommand)
+				{
+					fprintf(stderr, "REGRESSION %d commands, %d subsystems, %d%% churn: %.1f ns per command > %.1f\n",
+							kCommands[c], kSubsystems[s], kChurns[h], nsPerCommand, maxNsPerCommand);
+					failures++;
+				}
+				if (maxAllocations >= 0 && result.allocationsPerPass > maxAllocations)
+				{
+					fprintf(stderr, "REGRESSION %d commands, %d subsystems, %d%% churn: %.2f allocations per pass > %.2f\n",
+							kCommands[c], kSubsystems[s], kChurns[h], result.allocationsPerPass, maxAllocations);
+					failures++;
+				}
+			}
+		}
+	}
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,247 @@
+/*
+ * SimulationRunner.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include <Arduino.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "FIRSTCommand.h"
+#include "FIRSTScheduler.h"
+#include "FIRSTSubsystem.h"
+#include "FIRSTOutputs.h"
+#include "FIRSTEventLog.h"
+#include "Check.h"
+
+/*
+ * Simulates thousands of 15 second autonomous periods, each on a scheduler of its own
+ * with a virtual clock, spread over 1, 2, 4 and 8 threads. Every match draws its pass
+ * jitter, the durations of its commands and the time a defender shows up from a seed of
+ * its own, so the results do not depend on the threads. Prints a CSV line per thread
+ * count:
+ *
+ *   threads,instances,passes,seconds,passes_per_s,speedup
+ *
+ * then the statistics of all the matches. Fails if a thread count changes the results,
+ * or if a match sees the outputs or events of another one.
+ *
+ *   SimulationRunner [--quick] [--instances N] [--max-threads N]
+ */
+
+static const unsigned long kMatchMicros = 15000000UL;
+static const unsigned long kPassMicros = 20000UL;
+static const uint8_t kDrivePin = 12;
+static const uint8_t kArmPin = 13;
+
+static uint32_t next(uint32_t *state)
+{
+	uint32_t x = *state;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	*state = x;
+	return x;
+}
+
+static uint32_t draw(uint32_t *state, uint32_t low, uint32_t high)
+{
+	return low + next(state) % (high - low + 1);
+}
+
+class MatchSubsystem : public FIRSTSubsystem
+{
+public:
+	MatchSubsystem(const char *name, FIRSTScheduler *scheduler) : FIRSTSubsystem(name, scheduler) {}
+};
+
+/*
+ * Runs for a while, or until its timeout, with a pin staged HIGH meanwhile.
+ */
+class TimedCommand : public FIRSTCommand
+{
+public:
+	TimedCommand(const char *name, uint8_t pin) : FIRSTCommand(name), lit(false), m_pin(pin), m_duration(0) {}
+
+	void Set(unsigned long duration, double timeout) {
+		m_duration = duration;
+		if (timeout > 0)
+			SetTimeout(timeout);
+	}
+
+	bool lit;
+
+protected:
+	virtual void Initialize() { Light(HIGH); }
+	virtual void Execute() {}
+	virtual bool IsFinished() { return IsTimedOut() || TimeSinceInitialized() * 1000 >= m_duration; }
+	virtual void End() { Light(LOW); }
+	virtual void Interrupted() { Light(LOW); }
+
+private:
+	void Light(uint8_t value) {
+		GetScheduler()->GetOutputs()->Stage(m_pin, value);
+		lit = value == HIGH;
+	}
+
+	uint8_t m_pin;
+	unsigned long m_duration;
+};
+
+typedef struct sResult {
+	FIRSTScheduler::Statistics statistics;
+	unsigned long passes;
+} Result;
+
+/*
+ * Drives out for 1.5 to 2.5 seconds, with a timeout of 2, then raises the arm for 0.5 to
+ * 1.5 seconds. A defender pushes the robot for a second somewhere between 1 and 4 seconds
+ * into the match, interrupting the drive if it is still going.
+ */
+static Result play(uint32_t seed)
+{
+	uint32_t state = seed * 2654435761UL + 1;
+	FIRSTScheduler scheduler;
+	scheduler.SetVirtualClock(true);
+	MatchSubsystem drive("Drive", &scheduler), arm("Arm", &scheduler);
+
+	TimedCommand driveOut("DriveOut", kDrivePin), raise("Raise", kArmPin), pushed("Pushed", kDrivePin);
+	driveOut.SetScheduler(&scheduler);
+	raise.SetScheduler(&scheduler);
+	pushed.SetScheduler(&scheduler);
+	driveOut.Requires(&drive);
+	raise.Requires(&arm);
+	pushed.Requires(&drive);
+	driveOut.Set(draw(&state, 1500, 2500), 2.0);
+	raise.Set(draw(&state, 500, 1500), 0);
+	pushed.Set(1000, 0);
+	driveOut.Then(&raise, FIRSTCommand::kEndFinished | FIRSTCommand::kEndTimedOut);
+	unsigned long defender = draw(&state, 1000000, 4000000);
+	scheduler.Freeze(3);
+
+	FIRSTEventLog::Clear();
+	driveOut.Start();
+	Result result;
+	result.passes = 0;
+	bool defended = false;
+	while (scheduler.Micros() < kMatchMicros)
+	{
+		if (!defended && scheduler.Micros() >= defender)
+		{
+			pushed.Start();
+			defended = true;
+		}
+		scheduler.Run();
+		result.passes++;
+		scheduler.AdvanceClock(kPassMicros - 2000 + draw(&state, 0, 4000));
+
+		// The pins are committed at the end of the pass, by this scheduler alone
+		FIRSTOutputs *outputs = scheduler.GetOutputs();
+		bool armLit = outputs->GetPort(kArmPin / 8 + 1) & (1 << (kArmPin % 8));
+		bool driveLit = outputs->GetPort(kDrivePin / 8 + 1) & (1 << (kDrivePin % 8));
+		CHECK(armLit == raise.lit && driveLit == (driveOut.lit || pushed.lit),
+				"match %u sees other pins at pass %lu", seed, result.passes);
+	}
+	CHECK(FIRSTEventLog::GetCount() == 0, "match %u sees %d events", seed, FIRSTEventLog::GetCount());
+
+	result.statistics = scheduler.GetStatistics();
+	scheduler.RemoveAll();
+	return result;
+}
+
+static double runAll(int instances, int threadCount, std::vector<Result> *results, unsigned long *passes)
+{
+	std::atomic<int> nextMatch(0);
+	std::vector<std::thread> threads;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (int t = 0; t < threadCount; t++)
+	{
+		threads.push_back(std::thread([&]() {
+			for (int i = nextMatch++; i < instances; i = nextMatch++)
+				(*results)[i] = play(i);
+		}));
+	}
+	for (int t = 0; t < threadCount; t++)
+		threads[t].join();
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	*passes = 0;
+	for (int i = 0; i < instances; i++)
+		*passes += (*results)[i].passes;
+	return elapsed.count();
+}
+
+static bool same(const Result &a, const Result &b)
+{
+	return a.passes == b.passes
+			&& a.statistics.completed == b.statistics.completed
+			&& a.statistics.timedOut == b.statistics.timedOut
+			&& a.statistics.interrupted == b.statistics.interrupted
+			&& a.statistics.totalTime == b.statistics.totalTime
+			&& a.statistics.maxTime == b.statistics.maxTime;
+}
+
+int main(int argc, char **argv)
+{
+	int instances = 2000;
+	int maxThreads = 8;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--quick") == 0)
+			instances = 200;
+		else if (strcmp(argv[i], "--instances") == 0 && i + 1 < argc)
+			instances = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--max-threads") == 0 && i + 1 < argc)
+			maxThreads = atoi(argv[++i]);
+		else
+		{
+			fprintf(stderr, "usage: %s [--quick] [--instances N] [--max-threads N]\n", argv[0]);
+			return 2;
+		}
+	}
+
+	std::vector<Result> first(instances);
+	double single = 0;
+	printf("threads,instances,passes,seconds,passes_per_s,speedup\n");
+	for (int threadCount = 1; threadCount <= maxThreads; threadCount *= 2)
+	{
+		std::vector<Result> results(instances);
+		unsigned long passes;
+		double seconds = runAll(instances, threadCount, &results, &passes);
+		if (threadCount == 1)
+		{
+			first = results;
+			single = seconds;
+		}
+		printf("%d,%d,%lu,%.3f,%.0f,%.2f\n", threadCount, instances, passes, seconds,
+				passes / seconds, single / seconds);
+
+		int differing = 0;
+		for (int i = 0; i < instances; i++)
+			differing += !same(results[i], first[i]);
+		CHECK(differing == 0, "%d matches differ on %d threads", differing, threadCount);
+	}
+
+	FIRSTScheduler::Statistics total;
+	memset(&total, 0, sizeof(total));
+	for (int i = 0; i < instances; i++)
+	{
+		total.completed += first[i].statistics.completed;
+		total.timedOut += first[i].statistics.timedOut;
+		total.interrupted += first[i].statistics.interrupted;
+		total.totalTime += first[i].statistics.totalTime;
+		if (first[i].statistics.maxTime > total.maxTime)
+			total.maxTime = first[i].statistics.maxTime;
+	}
+	unsigned long ended = total.completed + total.timedOut;
+	printf("completed %lu, timed out %lu, interrupted %lu, mean %lu ms, longest %lu ms\n",
+			total.completed, total.timedOut, total.interrupted,
+			ended == 0 ? 0 : total.totalTime / ended, total.maxTime);
+	CHECK(total.timedOut > 0 && total.interrupted > 0, "the noise never reaches a timeout or an interruption");
+	return CheckResult();
+}
@@ -0,0 +1,135 @@
+/*
+ * StartupReport.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include <Arduino.h>
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "FIRSTCommand.h"
+#include "FIRSTScheduler.h"
+#include "FIRSTSubsystem.h"
+#include "AllocationTracker.h"
+#include "Check.h"
+
+/*
+ * Compares the first passes of a scheduler with its steady state, with and without
+ * Freeze(). Every subsystem creates its default command in InitDefaultCommand(), as
+ * WPILib programs do, so without Freeze() that happens during the first pass. Prints a
+ * CSV line per case:
+ *
+ *   frozen,subsystems,freeze_ns,pass1_ns,pass2_ns,steady_ns,pass1_allocations,
+ *   pass2_allocations,steady_allocations
+ *
+ * The default commands are added by the first pass and initialized by the second, the
+ * steady state is the median of the passes after. Fails if a frozen scheduler allocates.
+ */
+
+class IdleCommand : public FIRSTCommand
+{
+public:
+	IdleCommand(FIRSTSubsystem *subsystem) { Requires(subsystem); }
+
+protected:
+	virtual void Initialize() {}
+	virtual void Execute() {}
+	virtual bool IsFinished() { return false; }
+	virtual void End() {}
+	virtual void Interrupted() {}
+};
+
+class LazySubsystem : public FIRSTSubsystem
+{
+public:
+	LazySubsystem(FIRSTScheduler *scheduler) : FIRSTSubsystem("Lazy", scheduler), m_default(NULL) {}
+	virtual ~LazySubsystem() { delete m_default; }
+
+	virtual void InitDefaultCommand() {
+		m_default = new IdleCommand(this);
+		m_default->SetScheduler(GetScheduler());
+		SetDefaultCommand(m_default);
+	}
+
+private:
+	IdleCommand *m_default;
+};
+
+typedef std::chrono::steady_clock Clock;
+
+static long long since(Clock::time_point start)
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+}
+
+static void report(bool frozen, int subsystemCount)
+{
+	FIRSTScheduler scheduler;
+	scheduler.SetVirtualClock(true);
+	std::vector<LazySubsystem *> subsystems;
+	for (int i = 0; i < subsystemCount; i++)
+		subsystems.push_back(new LazySubsystem(&scheduler));
+
+	long long freezeTime = 0;
+	if (frozen)
+	{
+		Clock::time_point start = Clock::now();
+		scheduler.Freeze();
+		freezeTime = since(start);
+	}
+
+	long long passTimes[2];
+	unsigned long passAllocations[2];
+	for (int pass = 0; pass < 2; pass++)
+	{
+		unsigned long allocations = AllocationTracker::GetAllocations();
+		Clock::time_point start = Clock::now();
+		scheduler.AdvanceClock(1000);
+		scheduler.Run();
+		passTimes[pass] = since(start);
+		passAllocations[pass] = AllocationTracker::GetAllocations() - allocations;
+	}
+
+	std::vector<long long> steady;
+	steady.reserve(1001);
+	unsigned long allocations = AllocationTracker::GetAllocations();
+	for (int pass = 0; pass < 1001; pass++)
+	{
+		Clock::time_point start = Clock::now();
+		scheduler.AdvanceClock(1000);
+		scheduler.Run();
+		steady.push_back(since(start));
+	}
+	unsigned long steadyAllocations = AllocationTracker::GetAllocations() - allocations;
+	std::nth_element(steady.begin(), steady.begin() + steady.size() / 2, steady.end());
+
+	printf("%d,%d,%lld,%lld,%lld,%lld,%lu,%lu,%lu\n", frozen, subsystemCount, freezeTime,
+			passTimes[0], passTimes[1], steady[steady.size() / 2],
+			passAllocations[0], passAllocations[1], steadyAllocations);
+	if (frozen)
+	{
+		CHECK(passAllocations[0] == 0 && passAllocations[1] == 0 && steadyAllocations == 0,
+				"a frozen scheduler with %d subsystems allocates", subsystemCount);
+	}
+
+	scheduler.RemoveAll();
+	for (int i = 0; i < subsystemCount; i++)
+		delete subsystems[i];
+}
+
+int main()
+{
+	static const int kSubsystems[] = {1, 8, 64};
+	printf("frozen,subsystems,freeze_ns,pass1_ns,pass2_ns,steady_ns,"
+			"pass1_allocations,pass2_allocations,steady_allocations\n");
+	for (int i = 0; i < 3; i++)
+	{
+		report(false, kSubsystems[i]);
+		report(true, kSubsystems[i]);
+	}
+	return CheckResult();
+}
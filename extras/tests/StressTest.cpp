@@ -0,0 +1,189 @@
+/*
+ * StressTest.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include <Arduino.h>
+
+#include "FIRSTCommand.h"
+#include "FIRSTScheduler.h"
+#include "FIRSTSubsystem.h"
+#include "AllocationTracker.h"
+#include "Check.h"
+
+/*
+ * Starts, cancels and lets finish commands at random, across subsystems they share,
+ * while the scheduler is enabled and disabled at random, and checks after every pass:
+ * - every subsystem is owned by at most one command, which is running and requires it
+ * - every initialized command holds all of its requirements
+ * - a command is never initialized twice without ending in between
+ * - every initialized command was executed in the pass, and while disabled only those
+ *   that run when disabled are, even when that is changed as they run
+ * - once frozen, a pass does not allocate
+ * Once all is removed, every Initialize() has had its End() or Interrupted(), and no
+ * memory leaked. The rate of passes is reported.
+ *
+ *   StressTest [passes] [seed]
+ */
+
+#define SUBSYSTEMS 8
+#define COMMANDS 24
+#define STEP 1000
+
+static unsigned long initializes = 0;
+static unsigned long ends = 0;
+static long currentPass = 0;
+
+class StressSubsystem : public FIRSTSubsystem
+{
+public:
+	StressSubsystem(FIRSTScheduler *scheduler) : FIRSTSubsystem("Stress", scheduler) {}
+};
+
+class StressCommand : public FIRSTCommand
+{
+public:
+	StressCommand(int index, double timeout)
+		: FIRSTCommand("Stress", timeout), m_index(index), m_life(1), m_passes(0),
+		  m_executed(-1), m_live(false) {}
+
+	void SetLife(int life) { m_life = life; }
+	bool IsLive() { return m_live; }
+	long GetExecuted() { return m_executed; }
+
+protected:
+	virtual void Initialize() {
+		CHECK(!m_live, "command %d initialized twice", m_index);
+		m_live = true;
+		m_passes = 0;
+		initializes++;
+	}
+	virtual void Execute() { m_passes++; m_executed = currentPass; }
+	virtual bool IsFinished() { return m_passes >= m_life || IsTimedOut(); }
+	virtual void End() { Ended(); }
+	virtual void Interrupted() { Ended(); }
+
+private:
+	void Ended() {
+		CHECK(m_live, "command %d ended without being initialized", m_index);
+		m_live = false;
+		ends++;
+	}
+
+	int m_index;
+	int m_life;
+	int m_passes;
+	long m_executed;
+	bool m_live;
+};
+
+static void check(StressSubsystem **subsystems, StressCommand **commands, long pass,
+		bool enabled)
+{
+	for (int i = 0; i < SUBSYSTEMS; i++)
+	{
+		FIRSTCommand *owner = subsystems[i]->GetCurrentCommand();
+		if (owner != NULL)
+			CHECK(owner->IsRunning() && owner->DoesRequire(subsystems[i]),
+					"pass %ld: subsystem %d owned by a command not running on it", pass, i);
+	}
+	for (int i = 0; i < COMMANDS; i++)
+	{
+		if (!commands[i]->IsLive())
+			continue;
+		CHECK(commands[i]->IsRunning(), "pass %ld: command %d initialized but not running", pass, i);
+		CHECK(commands[i]->GetExecuted() == pass, "pass %ld: command %d not executed", pass, i);
+		CHECK(enabled || commands[i]->WillRunWhenDisabled(),
+				"pass %ld: command %d runs while disabled", pass, i);
+		const FIRSTCommand::SubsystemSet &requirements = commands[i]->GetRequirements();
+		FIRSTCommand::SubsystemSet::iterator iter = requirements.begin();
+		for (; iter != requirements.end(); iter++)
+			CHECK((*iter)->GetCurrentCommand() == commands[i],
+					"pass %ld: command %d runs without owning its subsystem", pass, i);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	long passes = argc > 1 ? atol(argv[1]) : 200000;
+	unsigned int seed = argc > 2 ? atoi(argv[2]) : 1;
+	srand(seed);
+
+	FIRSTScheduler scheduler;
+	scheduler.SetVirtualClock(true);
+
+	StressSubsystem *subsystems[SUBSYSTEMS];
+	for (int i = 0; i < SUBSYSTEMS; i++)
+		subsystems[i] = new StressSubsystem(&scheduler);
+
+	StressCommand *commands[COMMANDS];
+	for (int i = 0; i < COMMANDS; i++)
+	{
+		// Some time out before they finish
+		commands[i] = new StressCommand(i, rand() % 4 == 0 ? 0.005 : 0);
+		commands[i]->SetScheduler(&scheduler);
+		commands[i]->SetLife(1 + rand() % 12);
+		for (int k = 0; k < 3; k++)
+			if (rand() % 2)
+				commands[i]->Requires(subsystems[rand() % SUBSYSTEMS]);
+		if (rand() % 5 == 0)
+			commands[i]->SetInterruptible(false);
+		if (rand() % 4 == 0)
+			commands[i]->SetRunWhenDisabled(true);
+	}
+	// A few chains, and the first subsystems have default commands
+	for (int i = 0; i < COMMANDS / 4; i++)
+		commands[rand() % COMMANDS]->Then(commands[rand() % COMMANDS], FIRSTCommand::kEndAny);
+	for (int i = 0; i < 2; i++)
+	{
+		StressCommand *command = new StressCommand(COMMANDS + i, 0);
+		command->SetLife(1000000);
+		command->Requires(subsystems[i]);
+		subsystems[i]->SetDefaultCommand(command);
+	}
+
+	scheduler.Freeze(COMMANDS + 2);
+	long liveBlocks = AllocationTracker::GetLiveBlocks();
+	unsigned long allocations = AllocationTracker::GetAllocations();
+
+	bool enabled = true;
+	unsigned long start = micros();
+	for (long pass = 0; pass < passes; pass++)
+	{
+		for (int k = 0; k < 3; k++)
+		{
+			StressCommand *command = commands[rand() % COMMANDS];
+			int action = rand() % 8;
+			if (action < 4)
+				command->Start();
+			else if (action < 7)
+				command->Cancel();
+			else
+				command->SetRunWhenDisabled(!command->WillRunWhenDisabled());
+		}
+		if (pass % 997 == 0)
+			enabled = rand() % 4 != 0;
+		scheduler.SetEnabled(enabled);
+
+		currentPass = pass;
+		scheduler.AdvanceClock(STEP);
+		scheduler.Run();
+		check(subsystems, commands, pass, enabled);
+	}
+	unsigned long elapsed = micros() - start;
+
+	CHECK(AllocationTracker::GetAllocations() == allocations,
+			"%lu allocations in the passes", AllocationTracker::GetAllocations() - allocations);
+
+	scheduler.SetEnabled(true);
+	scheduler.RemoveAll();
+	CHECK(initializes == ends, "%lu initialized, %lu ended", initializes, ends);
+	CHECK(AllocationTracker::GetLiveBlocks() == liveBlocks,
+			"%ld blocks leaked", AllocationTracker::GetLiveBlocks() - liveBlocks);
+
+	printf("%ld passes, %lu commands initialized, %.0f passes/s\n", passes, initializes,
+			elapsed == 0 ? 0.0 : passes * 1e6 / elapsed);
+	return CheckResult();
+}
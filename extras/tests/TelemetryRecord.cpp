@@ -0,0 +1,96 @@
+/*
+ * TelemetryRecord.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include <Arduino.h>
+
+#include "FIRSTCommand.h"
+#include "FIRSTScheduler.h"
+#include "FIRSTSubsystem.h"
+#include "FIRSTTelemetry.h"
+
+/*
+ * Records a known telemetry stream to a file, for TelemetryDecoder to check. The file is
+ * written through a Print that does not override availableForWrite(), like most that are
+ * not a serial port.
+ *
+ *   TelemetryRecord <file>
+ */
+
+class FilePrint : public Print
+{
+public:
+	FilePrint(FILE *file) : m_file(file) {}
+	virtual size_t write(uint8_t value) { return fputc(value, m_file) == EOF ? 0 : 1; }
+	using Print::write;
+
+private:
+	FILE *m_file;
+};
+
+class Arm : public FIRSTSubsystem
+{
+public:
+	Arm(FIRSTScheduler *scheduler) : FIRSTSubsystem("Arm", scheduler) {}
+};
+
+class Hold : public FIRSTCommand
+{
+public:
+	Hold(FIRSTSubsystem *subsystem, int passes) : FIRSTCommand("Hold"), m_passes(passes), m_count(0) {
+		Requires(subsystem);
+	}
+
+protected:
+	virtual void Initialize() { m_count = 0; }
+	virtual void Execute() { m_count++; }
+	virtual bool IsFinished() { return m_count >= m_passes; }
+	virtual void End() {}
+	virtual void Interrupted() {}
+
+private:
+	int m_passes;
+	int m_count;
+};
+
+int main(int argc, char **argv)
+{
+	if (argc < 2)
+		return 2;
+	FILE *file = fopen(argv[1], "wb");
+	if (file == NULL)
+	{
+		perror(argv[1]);
+		return 1;
+	}
+
+	FIRSTScheduler scheduler;
+	scheduler.SetVirtualClock(true);
+	Arm shoulder(&scheduler);
+	Arm wrist(&scheduler);
+	Hold hold(&wrist, 3);
+
+	FilePrint out(file);
+	FIRSTTelemetry telemetry(&out, 100);
+	long angle = 0;
+	long current = 0;
+	telemetry.AddValue(1, &angle);
+	telemetry.AddValue(7, &current);
+	scheduler.SetTelemetry(&telemetry);
+	scheduler.Freeze();
+
+	for (int pass = 0; pass < 10; pass++)
+	{
+		if (pass == 2)
+			hold.Start();
+		angle = pass * 137;
+		current = -pass;
+		scheduler.AdvanceClock(100000);
+		scheduler.Run();
+	}
+	fclose(file);
+	return 0;
+}
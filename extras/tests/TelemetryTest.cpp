@@ -0,0 +1,175 @@
+/*
+ * TelemetryTest.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include <Arduino.h>
+
+#include "FIRSTCommand.h"
+#include "FIRSTScheduler.h"
+#include "FIRSTSubsystem.h"
+#include "FIRSTTelemetry.h"
+#include "Check.h"
+
+/*
+ * Checks that telemetry keeps flowing when a keyframe is as big as it gets: a scheduler
+ * with as many subsystems and values as are reported, the values needing the longest
+ * varints, and a dozen commands running.
+ */
+
+// Keeps what is written, and splits it into packets
+class PacketPrint : public Print
+{
+public:
+	PacketPrint() : length(0) {}
+	virtual size_t write(uint8_t value) {
+		if (length < (int)sizeof(data))
+			data[length++] = value;
+		return 1;
+	}
+	using Print::write;
+
+	// Decodes the next packet into frame, returns its length or -1 if none is left
+	int Next(int *offset, uint8_t *frame) {
+		for (int end = *offset; end < length; end++)
+		{
+			if (data[end] != 0)
+				continue;
+			int decoded = FIRSTTelemetry::DecodeCOBS(data + *offset, end - *offset, frame);
+			*offset = end + 1;
+			return decoded;
+		}
+		return -1;
+	}
+
+	uint8_t data[16384];
+	int length;
+};
+
+class Part : public FIRSTSubsystem
+{
+public:
+	Part(FIRSTScheduler *scheduler) : FIRSTSubsystem("Part", scheduler) {}
+};
+
+class Hold : public FIRSTCommand
+{
+public:
+	Hold() : FIRSTCommand("Hold") {}
+
+protected:
+	virtual void Initialize() {}
+	virtual void Execute() {}
+	virtual bool IsFinished() { return false; }
+	virtual void End() {}
+	virtual void Interrupted() {}
+};
+
+static void testSaturatedKeyframe()
+{
+	FIRSTScheduler scheduler;
+	scheduler.SetVirtualClock(true);
+	Part *parts[FIRSTTelemetry::kMaxSubsystems];
+	for (int i = 0; i < FIRSTTelemetry::kMaxSubsystems; i++)
+		parts[i] = new Part(&scheduler);
+	Hold holds[12];
+	for (int i = 0; i < 12; i++)
+	{
+		holds[i].SetScheduler(&scheduler);
+		holds[i].Requires(parts[i]);
+	}
+
+	PacketPrint out;
+	FIRSTTelemetry telemetry(&out, 100);
+	long values[FIRSTTelemetry::kMaxValues];
+	for (int i = 0; i < FIRSTTelemetry::kMaxValues; i++)
+	{
+		values[i] = i % 2 ? -2147483647L : 2147483647L;
+		telemetry.AddValue(i, &values[i]);
+	}
+	scheduler.SetTelemetry(&telemetry);
+
+	for (int i = 0; i < 12; i++)
+		holds[i].Start();
+	const int passes = 3 * FIRSTTelemetry::kKeyframeInterval;
+	for (int pass = 0; pass < passes; pass++)
+	{
+		values[0] = pass;
+		scheduler.AdvanceClock(100000);
+		scheduler.Run();
+	}
+
+	CHECK(telemetry.GetDroppedFrames() == 0, "%u packets dropped", telemetry.GetDroppedFrames());
+	uint8_t frame[FIRSTTelemetry::kMaxFrame + 2];
+	int offset = 0, length;
+	int packets = 0, keyframes = 0, owners = 0;
+	while ((length = out.Next(&offset, frame)) >= 0)
+	{
+		packets++;
+		if (frame[0] & FIRSTTelemetry::kKeyframe)
+		{
+			keyframes++;
+			// 12 one byte command IDs always fit, the owners follow with all of them
+			CHECK((frame[0] & FIRSTTelemetry::kMoreCommands) == 0, "not all commands fit");
+			CHECK(frame[2] == 12, "%u commands in the keyframe", frame[2]);
+			owners = frame[2 + 1 + 12];
+		}
+	}
+	CHECK(packets >= passes - 2, "%d packets out of %d passes", packets, passes);
+	CHECK(keyframes >= 3, "%d keyframes", keyframes);
+	CHECK(owners == FIRSTTelemetry::kMaxSubsystems, "%d owners in the last keyframe", owners);
+
+	scheduler.RemoveAll();
+	for (int i = 0; i < FIRSTTelemetry::kMaxSubsystems; i++)
+		delete parts[i];
+}
+
+// More commands than fit are cut short and flagged, the packets keep going
+static void testTooManyCommands()
+{
+	FIRSTScheduler scheduler;
+	scheduler.SetVirtualClock(true);
+	const int count = 200;
+	Hold *holds = new Hold[count];
+	for (int i = 0; i < count; i++)
+		holds[i].SetScheduler(&scheduler);
+
+	PacketPrint out;
+	FIRSTTelemetry telemetry(&out, 100);
+	long value = 0;
+	telemetry.AddValue(1, &value);
+	scheduler.SetTelemetry(&telemetry);
+	for (int i = 0; i < count; i++)
+		holds[i].Start();
+	for (int pass = 0; pass < 2 * FIRSTTelemetry::kKeyframeInterval; pass++)
+	{
+		value = pass;
+		scheduler.AdvanceClock(100000);
+		scheduler.Run();
+	}
+
+	uint8_t frame[FIRSTTelemetry::kMaxFrame + 2];
+	int offset = 0, length;
+	int keyframes = 0, cut = 0;
+	while ((length = out.Next(&offset, frame)) >= 0)
+	{
+		if (frame[0] & FIRSTTelemetry::kKeyframe)
+			keyframes++;
+		if (frame[0] & FIRSTTelemetry::kMoreCommands)
+			cut++;
+	}
+	CHECK(telemetry.GetDroppedFrames() == 0, "%u packets dropped", telemetry.GetDroppedFrames());
+	CHECK(keyframes >= 2 && cut >= 2, "%d keyframes, %d cut short", keyframes, cut);
+
+	scheduler.RemoveAll();
+	delete[] holds;
+}
+
+int main()
+{
+	testSaturatedKeyframe();
+	testTooManyCommands();
+	return CheckResult();
+}
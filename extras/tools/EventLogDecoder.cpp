@@ -0,0 +1,65 @@
+/*
+ * EventLogDecoder.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include <Arduino.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "FIRSTEventLog.h"
+#include "FrameReader.h"
+
+/*
+ * Prints the records drained by FIRSTEventLog, one line each, with the message of the
+ * event, which the board does not need to keep in flash:
+ *
+ *   12345: Command exceeded its execution budget (7)
+ *
+ * The time is the low 16 bits of millis() on the board.
+ *
+ *   EventLogDecoder <file|serial port|pty|-> [baud]
+ */
+
+int main(int argc, char **argv)
+{
+	if (argc < 2)
+	{
+		fprintf(stderr, "usage: %s <file|serial port|pty|-> [baud]\n", argv[0]);
+		return 2;
+	}
+	FrameReader reader;
+	if (!reader.Open(argv[1], argc > 2 ? atol(argv[2]) : 0))
+	{
+		perror(argv[1]);
+		return 1;
+	}
+
+	unsigned long events = 0, malformed = 0;
+	uint8_t frame[FrameReader::kMaxFrame];
+	int length;
+	while ((length = reader.Next(frame)) >= 0)
+	{
+		if (length != FIRSTEventLog::kRecordSize)
+		{
+			malformed++;
+			continue;
+		}
+		events++;
+		unsigned int argument = frame[1] | (frame[2] << 8);
+		unsigned int time = frame[3] | (frame[4] << 8);
+		printf("%u: ", time);
+		fflush(stdout);
+		FIRSTEventLog::PrintMessage(&Serial, frame[0]);
+		fflush(stdout);
+		printf(" (%u)\n", argument);
+		fflush(stdout);
+	}
+
+	printf("%lu events, %lu malformed, %lu invalid frames\n",
+			events, malformed, reader.GetInvalidFrames());
+	return 0;
+}
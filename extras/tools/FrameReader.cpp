@@ -0,0 +1,106 @@
+/*
+ * FrameReader.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include "FrameReader.h"
+#include "FIRSTTelemetry.h"
+
+#include <fcntl.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+FrameReader::FrameReader()
+	: m_fd(-1)
+	, m_length(0)
+	, m_overflow(false)
+	, m_invalid(0)
+{
+}
+
+FrameReader::~FrameReader()
+{
+	if (m_fd > 0)
+		close(m_fd);
+}
+
+static speed_t toSpeed(unsigned long baud)
+{
+	switch (baud)
+	{
+	case 9600: return B9600;
+	case 19200: return B19200;
+	case 38400: return B38400;
+	case 57600: return B57600;
+	case 230400: return B230400;
+	default: return B115200;
+	}
+}
+
+/**
+ * Opens what to read from.
+ * @param path a file, a serial port or a pty, "-" for the standard input
+ * @param baud the rate of a serial port, 115200 if 0
+ * @return false if it can not be opened
+ */
+bool FrameReader::Open(const char *path, unsigned long baud)
+{
+	m_fd = strcmp(path, "-") == 0 ? 0 : open(path, O_RDONLY | O_NOCTTY);
+	if (m_fd < 0)
+		return false;
+	if (isatty(m_fd))
+	{
+		struct termios tio;
+		if (tcgetattr(m_fd, &tio) == 0)
+		{
+			cfmakeraw(&tio);
+			cfsetispeed(&tio, toSpeed(baud));
+			cfsetospeed(&tio, toSpeed(baud));
+			tcsetattr(m_fd, TCSANOW, &tio);
+		}
+	}
+	return true;
+}
+
+/**
+ * Waits for the next valid frame and decodes it. Frames too long or not valid COBS are
+ * skipped and counted.
+ * @param frame where to put the decoded frame, kMaxFrame bytes
+ * @return the length of the frame, or -1 at the end of the input
+ */
+int FrameReader::Next(uint8_t *frame)
+{
+	uint8_t c;
+	while (read(m_fd, &c, 1) == 1)
+	{
+		if (c != 0)
+		{
+			if (m_length < kMaxFrame)
+				m_buffer[m_length++] = c;
+			else
+				m_overflow = true;
+			continue;
+		}
+		int length = m_overflow ? -1 : FIRSTTelemetry::DecodeCOBS(m_buffer, m_length, frame);
+		bool empty = m_length == 0 && !m_overflow;
+		m_length = 0;
+		m_overflow = false;
+		if (length > 0)
+			return length;
+		if (!empty)
+			m_invalid++;
+	}
+	return -1;
+}
+
+/**
+ * Returns how many frames were skipped, too long or not valid COBS.
+ * @return the number of invalid frames
+ */
+unsigned long FrameReader::GetInvalidFrames()
+{
+	return m_invalid;
+}
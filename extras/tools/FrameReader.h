@@ -0,0 +1,37 @@
+/*
+ * FrameReader.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef FRAMEREADER_H_
+#define FRAMEREADER_H_
+
+#include <stdint.h>
+
+/**
+ * Reads the COBS frames sent by the library, each ended by a zero byte, from a file, a
+ * serial port or a pty, and decodes them. A serial port or pty is put in raw mode first.
+ */
+class FrameReader
+{
+public:
+	static const int kMaxFrame = 512;
+
+	FrameReader();
+	~FrameReader();
+
+	bool Open(const char *path, unsigned long baud = 0);
+	int Next(uint8_t *frame);
+	unsigned long GetInvalidFrames();
+
+private:
+	int m_fd;
+	uint8_t m_buffer[kMaxFrame];
+	int m_length;
+	bool m_overflow;
+	unsigned long m_invalid;
+};
+
+#endif /* FRAMEREADER_H_ */
@@ -0,0 +1,156 @@
+/*
+ * TelemetryDecoder.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "FIRSTTelemetry.h"
+#include "FrameReader.h"
+
+/*
+ * Prints the packets of a FIRSTTelemetry stream, one line each, with the values rebuilt
+ * from their deltas:
+ *
+ *   #12 key commands 3 5 | owners 0:3 1:- | values 1=1234 7=-5
+ *
+ * A "+" after the commands tells that more were running than fit in the packet.
+ * A gap in the sequence numbers is reported, and the values are only trusted again from
+ * the next keyframe on.
+ *
+ *   TelemetryDecoder <file|serial port|pty|-> [baud]
+ */
+
+static const uint8_t *data;
+static const uint8_t *end;
+
+static bool getVarint(unsigned long *value)
+{
+	*value = 0;
+	for (int shift = 0; data < end && shift < 35; shift += 7)
+	{
+		uint8_t b = *data++;
+		*value |= (unsigned long)(b & 0x7F) << shift;
+		if ((b & 0x80) == 0)
+			return true;
+	}
+	return false;
+}
+
+int main(int argc, char **argv)
+{
+	if (argc < 2)
+	{
+		fprintf(stderr, "usage: %s <file|serial port|pty|-> [baud]\n", argv[0]);
+		return 2;
+	}
+	FrameReader reader;
+	if (!reader.Open(argv[1], argc > 2 ? atol(argv[2]) : 0))
+	{
+		perror(argv[1]);
+		return 1;
+	}
+
+	long values[256] = {0};
+	bool synchronized = false;
+	bool first = true;
+	uint8_t expected = 0;
+	unsigned long packets = 0, lost = 0, malformed = 0;
+	uint8_t frame[FrameReader::kMaxFrame];
+	int length;
+
+	while ((length = reader.Next(frame)) >= 0)
+	{
+		if (length < 2)
+		{
+			malformed++;
+			continue;
+		}
+		data = frame + 2;
+		end = frame + length;
+		uint8_t flags = frame[0];
+		uint8_t sequence = frame[1];
+		bool keyframe = (flags & FIRSTTelemetry::kKeyframe) != 0;
+		packets++;
+
+		if (!first && sequence != expected)
+		{
+			uint8_t gap = sequence - expected;
+			printf("lost %u packets\n", gap);
+			lost += gap;
+			synchronized = false;
+		}
+		first = false;
+		expected = sequence + 1;
+		if (keyframe)
+			synchronized = true;
+
+		printf("#%u%s", sequence, keyframe ? " key" : "");
+		bool ok = true;
+		const char *separator = " ";
+		unsigned long count, value;
+		if (flags & FIRSTTelemetry::kCommands)
+		{
+			printf("%scommands", separator);
+			separator = " | ";
+			ok = getVarint(&count);
+			for (unsigned long i = 0; ok && i < count; i++)
+			{
+				ok = getVarint(&value);
+				printf(" %lu", value);
+			}
+			if (flags & FIRSTTelemetry::kMoreCommands)
+				printf(" +");
+		}
+		if (ok && (flags & FIRSTTelemetry::kOwners))
+		{
+			printf("%sowners", separator);
+			separator = " | ";
+			ok = getVarint(&count);
+			for (unsigned long i = 0; ok && i < count; i++)
+			{
+				unsigned long index, id;
+				ok = getVarint(&index) && getVarint(&id);
+				if (!ok)
+					break;
+				if (id == 0)
+					printf(" %lu:-", index);
+				else
+					printf(" %lu:%lu", index, id - 1);
+			}
+		}
+		if (ok && (flags & FIRSTTelemetry::kValues))
+		{
+			printf("%svalues", separator);
+			ok = getVarint(&count);
+			for (unsigned long i = 0; ok && i < count; i++)
+			{
+				ok = data < end;
+				if (!ok)
+					break;
+				uint8_t id = *data++;
+				ok = getVarint(&value);
+				long delta = (value & 1) ? ~(long)(value >> 1) : (long)(value >> 1);
+				values[id] = (keyframe ? 0 : values[id]) + delta;
+				if (synchronized)
+					printf(" %u=%ld", id, values[id]);
+				else
+					printf(" %u=?", id);
+			}
+		}
+		if (!ok || data != end)
+		{
+			printf(" malformed");
+			malformed++;
+		}
+		printf("\n");
+		fflush(stdout);
+	}
+
+	printf("%lu packets, %lu lost, %lu malformed, %lu invalid frames\n",
+			packets, lost, malformed, reader.GetInvalidFrames());
+	return 0;
+}